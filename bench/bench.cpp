@@ -0,0 +1,265 @@
+#include "bench.hpp"
+#include "pfederc/json.hpp"
+#include <ctime>
+#include <iomanip>
+#include <regex>
+#include <sstream>
+using namespace pfederc;
+using namespace pfederc::bench;
+
+//! Iterations aren't increased beyond
+constexpr size_t MAX_ITERATIONS = 1000000000;
+
+// State
+State::State(const BenchmarkConfig &cfg, size_t iterations) noexcept
+    : cfg{cfg}, iterations{iterations}, iteration{0}, items{0}, bytes{0},
+      duration{0}, cpuDuration{0}, paused{true} {
+}
+
+State::~State() {
+}
+
+bool State::keepRunning() noexcept {
+  if (iteration == 0)
+    resumeTiming();
+
+  if (iteration++ < iterations)
+    return true;
+
+  pauseTiming();
+  return false;
+}
+
+void State::pauseTiming() noexcept {
+  if (paused)
+    return;
+
+  duration += std::chrono::steady_clock::now() - start;
+  cpuDuration += std::clock() - cpuStart;
+  paused = true;
+}
+
+void State::resumeTiming() noexcept {
+  if (!paused)
+    return;
+
+  paused = false;
+  cpuStart = std::clock();
+  start = std::chrono::steady_clock::now();
+}
+
+double State::getCpuDuration() const noexcept {
+  return static_cast<double>(cpuDuration) / CLOCKS_PER_SEC;
+}
+
+// registry
+static std::vector<std::pair<std::string, BenchmarkFunction>> &
+    _benchmarks() noexcept {
+  static std::vector<std::pair<std::string, BenchmarkFunction>> benchmarks;
+  return benchmarks;
+}
+
+bool pfederc::bench::registerBenchmark(const std::string &name,
+    BenchmarkFunction &&fn) noexcept {
+  _benchmarks().emplace_back(name, std::move(fn));
+  return true;
+}
+
+void pfederc::bench::listBenchmarks(std::ostream &out) noexcept {
+  for (const auto &benchmark : _benchmarks())
+    out << benchmark.first << std::endl;
+}
+
+struct _Result {
+  std::string name;
+  size_t iterations;
+  double realTime; //!< nanoseconds per iteration
+  double cpuTime;  //!< nanoseconds per iteration
+  double itemsPerSecond;
+  double bytesPerSecond;
+};
+
+/*!\brief Runs fn with increasing iterations, until the measured time
+ * exceeds cfg.minTime
+ */
+static _Result _run(const BenchmarkConfig &cfg, const std::string &name,
+    const BenchmarkFunction &fn) noexcept {
+  size_t iterations = 1;
+  while (true) {
+    State state(cfg, iterations);
+    fn(state);
+
+    const double seconds =
+      std::chrono::duration<double>(state.getDuration()).count();
+    if (seconds >= cfg.minTime || iterations >= MAX_ITERATIONS) {
+      const double perSecond = seconds > 0 ? 1 / seconds : 0;
+      return _Result{name, iterations, seconds * 1e9 / iterations,
+        state.getCpuDuration() * 1e9 / iterations,
+        state.getItemsProcessed() * perSecond,
+        state.getBytesProcessed() * perSecond};
+    }
+
+    // predict iterations needed, at least double them
+    const double factor = seconds > 0 ? cfg.minTime / seconds * 1.4 : 10;
+    iterations = std::min<size_t>(MAX_ITERATIONS,
+        iterations * std::max(2.0, std::min(factor, 100.0)));
+  }
+}
+
+static void _printJson(const BenchmarkConfig &cfg,
+    const std::vector<_Result> &results, std::ostream &out) noexcept {
+  char date[32];
+  const std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+  std::string json;
+  JsonWriter writer(json);
+  writer.beginObject().key("context").beginObject()
+    .member("date", date)
+    .member("num_cpus", uint64_t(std::thread::hardware_concurrency()))
+#ifdef NDEBUG
+    .member("library_build_type", "release")
+#else
+    .member("library_build_type", "debug")
+#endif
+    .member("corpus_size", uint64_t(cfg.corpusSize))
+    .member("threads", uint64_t(cfg.threads))
+    .endObject();
+
+  writer.key("benchmarks").beginArray();
+  for (const _Result &result : results) {
+    writer.beginObject()
+      .member("name", result.name)
+      .member("run_type", "iteration")
+      .member("iterations", uint64_t(result.iterations))
+      .member("real_time", result.realTime)
+      .member("cpu_time", result.cpuTime)
+      .member("time_unit", "ns");
+    if (result.itemsPerSecond > 0)
+      writer.member("items_per_second", result.itemsPerSecond);
+    if (result.bytesPerSecond > 0)
+      writer.member("bytes_per_second", result.bytesPerSecond);
+
+    writer.endObject();
+  }
+
+  writer.endArray().endObject();
+  out << json << std::endl;
+}
+
+inline static std::string _formatRate(double rate, const char *unit) noexcept {
+  if (rate <= 0)
+    return std::string();
+
+  const char *const prefixes[] = {"", "k", "M", "G", "T"};
+  size_t prefix = 0;
+  while (rate >= 1000 && prefix + 1 < sizeof(prefixes) / sizeof(*prefixes)) {
+    rate /= 1000;
+    ++prefix;
+  }
+
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(2) << rate << ' '
+      << prefixes[prefix] << unit;
+  return out.str();
+}
+
+static void _printText(const std::vector<_Result> &results,
+    std::ostream &out) noexcept {
+  out << std::left << std::setw(40) << "benchmark"
+      << std::right << std::setw(16) << "time/iter"
+      << std::setw(12) << "iterations"
+      << std::setw(16) << "items/s"
+      << std::setw(16) << "bytes/s" << std::endl;
+  for (const _Result &result : results) {
+    std::ostringstream time;
+    time << std::fixed << std::setprecision(0) << result.realTime << " ns";
+    out << std::left << std::setw(40) << result.name
+        << std::right << std::setw(16) << time.str()
+        << std::setw(12) << result.iterations
+        << std::setw(16) << _formatRate(result.itemsPerSecond, "/s")
+        << std::setw(16) << _formatRate(result.bytesPerSecond, "B/s")
+        << std::endl;
+  }
+}
+
+void pfederc::bench::runBenchmarks(const BenchmarkConfig &cfg, bool json,
+    std::ostream &out) noexcept {
+  const std::regex filter(cfg.filter.empty() ? ".*" : cfg.filter);
+  std::vector<_Result> results;
+  for (const auto &benchmark : _benchmarks()) {
+    if (std::regex_search(benchmark.first, filter))
+      results.push_back(_run(cfg, benchmark.first, benchmark.second));
+  }
+
+  if (json)
+    _printJson(cfg, results, out);
+  else
+    _printText(results, out);
+}
+
+inline static bool _startsWith(const std::string &str,
+    const std::string &prefix) noexcept {
+  return str.compare(0, prefix.length(), prefix) == 0;
+}
+
+static bool _parseNumber(size_t &num, const std::string &value) noexcept {
+  if (value.empty() || value.length() > 12
+      || value.find_first_not_of("0123456789") != std::string::npos)
+    return false;
+
+  num = std::stoull(value);
+  return true;
+}
+
+int main(int argsc, char *argsv[]) {
+  BenchmarkConfig cfg{1 << 20, 0.5, "",
+    std::max<size_t>(std::thread::hardware_concurrency(), 1)};
+  bool json = false;
+  for (int i = 1; i < argsc; ++i) {
+    const std::string arg(argsv[i]);
+    if (arg == "--list") {
+      listBenchmarks(std::cout);
+      return 0;
+    } else if (arg == "--format=json") {
+      json = true;
+    } else if (arg == "--format=text") {
+      json = false;
+    } else if (_startsWith(arg, "--filter=")) {
+      cfg.filter = arg.substr(std::strlen("--filter="));
+    } else if (_startsWith(arg, "--size=")) {
+      if (!_parseNumber(cfg.corpusSize, arg.substr(std::strlen("--size=")))
+          || cfg.corpusSize == 0) {
+        std::cerr << "Invalid corpus size: " << arg << std::endl;
+        return 1;
+      }
+    } else if (_startsWith(arg, "--threads=")) {
+      if (!_parseNumber(cfg.threads, arg.substr(std::strlen("--threads=")))
+          || cfg.threads == 0) {
+        std::cerr << "Invalid number of threads: " << arg << std::endl;
+        return 1;
+      }
+    } else if (_startsWith(arg, "--min-time=")) {
+      char *end = nullptr;
+      const std::string value = arg.substr(std::strlen("--min-time="));
+      cfg.minTime = std::strtod(value.c_str(), &end);
+      if (value.empty() || *end || cfg.minTime < 0) {
+        std::cerr << "Invalid minimal time: " << arg << std::endl;
+        return 1;
+      }
+    } else {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      return 1;
+    }
+  }
+
+  try {
+    std::regex(cfg.filter);
+  } catch (const std::regex_error &) {
+    std::cerr << "Invalid filter: " << cfg.filter << std::endl;
+    return 1;
+  }
+
+  runBenchmarks(cfg, json, std::cout);
+  return 0;
+}
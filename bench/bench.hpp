@@ -0,0 +1,107 @@
+#ifndef PFEDERC_BENCH_BENCH_HPP
+#define PFEDERC_BENCH_BENCH_HPP
+
+#include "pfederc/core.hpp"
+
+namespace pfederc {
+  namespace bench {
+    /*!\brief Settings given by the command-line
+     */
+    struct BenchmarkConfig {
+      //! --size=BYTES, approximate size of generated corpora
+      size_t corpusSize;
+      //! --min-time=SECONDS, minimal measured time per benchmark
+      double minTime;
+      //! --filter=REGEX, run benchmarks with matching names only
+      std::string filter;
+      //! --threads=N, threads of parallel benchmarks
+      size_t threads;
+    };
+
+    /*!\brief Iterations and processed items/bytes of a benchmark run
+     *
+     * Only the loop of keepRunning is measured:
+     *
+     * \code
+     * while (state.keepRunning()) { ... }
+     * \endcode
+     */
+    class State final {
+      const BenchmarkConfig &cfg;
+      const size_t iterations;
+      size_t iteration;
+      uint64_t items;
+      uint64_t bytes;
+
+      std::chrono::steady_clock::time_point start;
+      std::chrono::nanoseconds duration;
+      std::clock_t cpuStart;
+      std::clock_t cpuDuration;
+      bool paused;
+    public:
+      State(const BenchmarkConfig &cfg, size_t iterations) noexcept;
+      State(const State &) = delete;
+      ~State();
+
+      inline const BenchmarkConfig &getConfig() const noexcept { return cfg; }
+      inline size_t getIterations() const noexcept { return iterations; }
+
+      /*!\return Returns true, if another iteration has to be run. Starts
+       * measuring on the first call and stops after the last iteration.
+       */
+      bool keepRunning() noexcept;
+
+      /*!\brief Excludes the following code from the measurement (e.g.
+       * setup of the next iteration)
+       */
+      void pauseTiming() noexcept;
+      void resumeTiming() noexcept;
+
+      //! Sets items processed by all iterations
+      inline void setItemsProcessed(uint64_t items) noexcept
+      { this->items = items; }
+      inline uint64_t getItemsProcessed() const noexcept { return items; }
+
+      //! Sets bytes processed by all iterations
+      inline void setBytesProcessed(uint64_t bytes) noexcept
+      { this->bytes = bytes; }
+      inline uint64_t getBytesProcessed() const noexcept { return bytes; }
+
+      inline std::chrono::nanoseconds getDuration() const noexcept
+      { return duration; }
+      //! Returns CPU time of the process (all threads) in seconds
+      double getCpuDuration() const noexcept;
+    };
+
+    typedef std::function<void(State &)> BenchmarkFunction;
+
+    /*!\brief Adds benchmark to the benchmarks run by runBenchmarks
+     * \param name
+     * \param fn
+     * \return Returns true
+     */
+    bool registerBenchmark(const std::string &name,
+        BenchmarkFunction &&fn) noexcept;
+
+    /*!\brief Runs all registered benchmarks matching cfg.filter
+     * \param cfg
+     * \param json Print results as JSON (Google Benchmark format), otherwise
+     * as table
+     * \param out
+     */
+    void runBenchmarks(const BenchmarkConfig &cfg, bool json,
+        std::ostream &out) noexcept;
+
+    /*!\brief Prints names of all registered benchmarks
+     * \param out
+     */
+    void listBenchmarks(std::ostream &out) noexcept;
+  }
+}
+
+//! Registers fn with name at static initialization
+#define PFEDERC_BENCHMARK(name, fn) \
+  static const bool _registered_##fn = \
+    ::pfederc::bench::registerBenchmark(name, fn)
+
+#endif /* PFEDERC_BENCH_BENCH_HPP */
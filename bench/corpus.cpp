@@ -0,0 +1,35 @@
+#include "corpus.hpp"
+#include "generator.hpp"
+using namespace pfederc;
+using namespace pfederc::bench;
+
+//! Seed of all corpora, benchmarks are comparable between runs
+constexpr uint64_t CORPUS_SEED = 0;
+
+static std::mutex _mtxCorpora;
+
+const std::string &pfederc::bench::getProgramCorpus(size_t size) noexcept {
+  static std::map<size_t, std::string> corpora;
+  std::lock_guard<std::mutex> lck(_mtxCorpora);
+  std::string &program = corpora[size];
+  if (program.empty()) {
+    GeneratorShape shape;
+    getGeneratorShape(shape, "mixed");
+    program = ProgramGenerator(shape, CORPUS_SEED).generate(size);
+  }
+
+  return program;
+}
+
+const std::string &pfederc::bench::getExpressionCorpus(size_t size) noexcept {
+  static std::map<size_t, std::string> corpora;
+  std::lock_guard<std::mutex> lck(_mtxCorpora);
+  std::string &expr = corpora[size];
+  if (expr.empty()) {
+    GeneratorShape shape;
+    getGeneratorShape(shape, "expressions");
+    expr = ProgramGenerator(shape, CORPUS_SEED).generateExpression(size);
+  }
+
+  return expr;
+}
@@ -0,0 +1,20 @@
+#ifndef PFEDERC_BENCH_CORPUS_HPP
+#define PFEDERC_BENCH_CORPUS_HPP
+
+#include "pfederc/core.hpp"
+
+namespace pfederc {
+  namespace bench {
+    /*!\return Returns a program of about size bytes with functions, classes
+     * and variables. Equal sizes return the same (cached) program.
+     */
+    const std::string &getProgramCorpus(size_t size) noexcept;
+
+    /*!\return Returns a single expression of about size bytes (arithmetic,
+     * comparisons, calls and brackets)
+     */
+    const std::string &getExpressionCorpus(size_t size) noexcept;
+  }
+}
+
+#endif /* PFEDERC_BENCH_CORPUS_HPP */
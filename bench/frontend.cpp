@@ -0,0 +1,223 @@
+#include "bench.hpp"
+#include "corpus.hpp"
+#include "pfederc/lexer.hpp"
+#include "pfederc/syntax.hpp"
+#include "pfederc/syntax_optimizer.hpp"
+#include "pfederc/semantics.hpp"
+#include <sstream>
+using namespace pfederc;
+using namespace pfederc::bench;
+
+//! Number of symbols of context benchmarks
+constexpr size_t SYMBOLS = 10000;
+//! Depth of the context chain of resolve benchmarks
+constexpr size_t DEPTH = 16;
+//! Depth of the context chain of context tree benchmarks
+constexpr size_t TREE_DEPTH = 1024;
+
+static const LanguageConfiguration _cfg = createDefaultLanguageConfiguration();
+
+//! Parses program, aborts the benchmark on errors
+static std::unique_ptr<ProgramExpr> _parseProgram(Lexer &lex) noexcept {
+  lex.next();
+  Parser parser(lex);
+  std::unique_ptr<ProgramExpr> program = parser.parseProgram();
+  if (!program || !parser.getErrors().empty() || !lex.getErrors().empty()) {
+    std::cerr << "Corpus doesn't parse" << std::endl;
+    std::exit(1);
+  }
+
+  return program;
+}
+
+static void _lexerNext(State &state) {
+  const std::string &corpus = getProgramCorpus(state.getConfig().corpusSize);
+  uint64_t tokens = 0;
+  while (state.keepRunning()) {
+    std::istringstream input(corpus);
+    Lexer lex(_cfg, input, "<corpus>");
+    while (lex.next() != TokenType::TOK_EOF)
+      ++tokens;
+  }
+
+  state.setItemsProcessed(tokens);
+  state.setBytesProcessed(corpus.size() * state.getIterations());
+}
+PFEDERC_BENCHMARK("lexer/next", _lexerNext);
+
+static void _parserProgram(State &state) {
+  const std::string &corpus = getProgramCorpus(state.getConfig().corpusSize);
+  uint64_t definitions = 0;
+  while (state.keepRunning()) {
+    std::istringstream input(corpus);
+    Lexer lex(_cfg, input, "<corpus>");
+    definitions += _parseProgram(lex)->getDefinitions().size();
+  }
+
+  state.setItemsProcessed(definitions);
+  state.setBytesProcessed(corpus.size() * state.getIterations());
+}
+PFEDERC_BENCHMARK("parser/parseProgram", _parserProgram);
+
+static void _parserExpression(State &state) {
+  const std::string &corpus =
+    getExpressionCorpus(state.getConfig().corpusSize);
+  while (state.keepRunning()) {
+    std::istringstream input(corpus);
+    Lexer lex(_cfg, input, "<corpus>");
+    lex.next();
+    Parser parser(lex);
+    if (!parser.parseExpression() || !parser.getErrors().empty()) {
+      std::cerr << "Corpus doesn't parse" << std::endl;
+      std::exit(1);
+    }
+  }
+
+  state.setBytesProcessed(corpus.size() * state.getIterations());
+}
+PFEDERC_BENCHMARK("parser/parseExpression", _parserExpression);
+
+static void _optimizeAll(State &state, size_t threads) {
+  const std::string &corpus = getProgramCorpus(state.getConfig().corpusSize);
+  // expressions reference their lexer, both are replaced every iteration
+  std::unique_ptr<Lexer> lex;
+  std::unique_ptr<Expr> expr;
+  OptimizerStats stats;
+  TaskScheduler scheduler(threads);
+  while (state.keepRunning()) {
+    state.pauseTiming();
+    expr.reset();
+    std::istringstream input(corpus);
+    lex = std::make_unique<Lexer>(_cfg, input, "<corpus>");
+    expr = _parseProgram(*lex);
+    state.resumeTiming();
+
+    expr = optimizeAll(std::move(expr), stats, scheduler);
+  }
+
+  state.setItemsProcessed(stats.getRewrites());
+  state.setBytesProcessed(corpus.size() * state.getIterations());
+}
+
+static void _optimizeAllSerial(State &state) {
+  _optimizeAll(state, 1);
+}
+PFEDERC_BENCHMARK("optimizer/optimizeAll", _optimizeAllSerial);
+
+static void _optimizeAllParallel(State &state) {
+  _optimizeAll(state, state.getConfig().threads);
+}
+PFEDERC_BENCHMARK("optimizer/optimizeAll/threads", _optimizeAllParallel);
+
+static const std::vector<InternedId> &_symbolNames() noexcept {
+  static const std::vector<InternedId> names = []() {
+      std::vector<InternedId> result;
+      for (size_t i = 0; i < SYMBOLS; ++i)
+        result.push_back(intern("s" + std::to_string(i)));
+
+      return result;
+    }();
+
+  return names;
+}
+
+static void _contextAddSymbol(State &state) {
+  const std::vector<InternedId> &names = _symbolNames();
+  NullSymbol type;
+  while (state.keepRunning()) {
+    Context ctx;
+    for (InternedId name : names)
+      ctx.addSymbol(std::make_unique<VariableSymbol>(0, name, &type));
+  }
+
+  state.setItemsProcessed(names.size() * state.getIterations());
+}
+PFEDERC_BENCHMARK("context/addSymbol", _contextAddSymbol);
+
+static void _contextResolve(State &state) {
+  const std::vector<InternedId> &names = _symbolNames();
+  NullSymbol type;
+  Context root;
+  for (InternedId name : names)
+    root.addSymbol(std::make_unique<VariableSymbol>(0, name, &type));
+
+  // names are resolved through block scopes
+  Context *ctx = &root;
+  for (size_t i = 0; i < DEPTH; ++i)
+    ctx = ctx->createContext();
+
+  size_t found = 0;
+  while (state.keepRunning()) {
+    for (InternedId name : names)
+      found += ctx->resolve(name).ctx == &root;
+  }
+
+  if (found != names.size() * state.getIterations()) {
+    std::cerr << "Unresolved symbols" << std::endl;
+    std::exit(1);
+  }
+
+  state.setItemsProcessed(found);
+}
+PFEDERC_BENCHMARK("context/resolve", _contextResolve);
+
+//! Deep block scopes, each with a context id
+static void _contextCreate(State &state) {
+  while (state.keepRunning()) {
+    Context root;
+    root.setConcurrent(false);
+    Context *ctx = &root;
+    for (size_t i = 0; i < TREE_DEPTH; ++i) {
+      ctx->createCtxId();
+      ctx = ctx->createContext();
+    }
+  }
+
+  state.setItemsProcessed(2 * TREE_DEPTH * state.getIterations());
+}
+PFEDERC_BENCHMARK("context/createContext", _contextCreate);
+
+//! Program order and common parents of context ids in deep block scopes
+static void _contextOrder(State &state) {
+  Context root;
+  std::vector<Context*> chain{&root};
+  std::vector<const CtxId*> ids;
+  for (size_t i = 0; i < TREE_DEPTH; ++i) {
+    ids.push_back(chain.back()->createCtxId());
+    chain.push_back(chain.back()->createContext());
+  }
+
+  size_t ordered = 0;
+  while (state.keepRunning()) {
+    for (size_t i = 1; i < TREE_DEPTH; ++i) {
+      ordered += *ids[i - 1] < *ids[i];
+      ordered += chain[TREE_DEPTH]->getCommonParent(*chain[i]) == chain[i];
+    }
+  }
+
+  if (ordered != 2 * (TREE_DEPTH - 1) * state.getIterations()) {
+    std::cerr << "Unordered context ids" << std::endl;
+    std::exit(1);
+  }
+
+  state.setItemsProcessed(ordered);
+}
+PFEDERC_BENCHMARK("context/programOrder", _contextOrder);
+
+static void _semanticBuild(State &state) {
+  const std::string &corpus = getProgramCorpus(state.getConfig().corpusSize);
+  std::istringstream input(corpus);
+  Lexer lex(_cfg, input, "<corpus>");
+  const std::unique_ptr<ProgramExpr> program = _parseProgram(lex);
+
+  while (state.keepRunning()) {
+    TypeAnalyzer analyzer(state.getConfig().threads);
+    analyzer.buildSemantics(std::list<BuildSemanticParam>{
+        BuildSemanticParam{"<corpus>", true, program.get()}});
+  }
+
+  state.setItemsProcessed(program->getDefinitions().size()
+      * state.getIterations());
+  state.setBytesProcessed(corpus.size() * state.getIterations());
+}
+PFEDERC_BENCHMARK("semantic/buildSemantics", _semanticBuild);
@@ -0,0 +1,130 @@
+#include "generator.hpp"
+#include <fstream>
+using namespace pfederc;
+using namespace pfederc::bench;
+
+inline static bool _startsWith(const std::string &str,
+    const std::string &prefix) noexcept {
+  return str.compare(0, prefix.length(), prefix) == 0;
+}
+
+/*!\brief Parses decimal number with optional suffix K, M or G (powers of
+ * 1024)
+ */
+static bool _parseSize(size_t &num, std::string value) noexcept {
+  size_t factor = 1;
+  if (!value.empty()) {
+    switch (value.back()) {
+    case 'K':
+      factor = size_t(1) << 10;
+      break;
+    case 'M':
+      factor = size_t(1) << 20;
+      break;
+    case 'G':
+      factor = size_t(1) << 30;
+      break;
+    }
+
+    if (factor != 1)
+      value.pop_back();
+  }
+
+  if (value.empty() || value.length() > 12
+      || value.find_first_not_of("0123456789") != std::string::npos)
+    return false;
+
+  num = std::stoull(value) * factor;
+  return true;
+}
+
+static void _printUsage() noexcept {
+  std::cout << "pfederc_gen [options]\n"
+    "  --seed=N                 seed (default: 0)\n"
+    "  --size=BYTES[K|M|G]      minimal size of the program (default: 64K)\n"
+    "  --shape=NAME             preset:";
+  for (const std::string &name : getGeneratorShapeNames())
+    std::cout << ' ' << name;
+
+  std::cout << " (default: mixed)\n"
+    "  --depth=N                maximal nesting of blocks (at most "
+    << GENERATOR_MAX_NESTING_DEPTH << ")\n"
+    "  --statements=N           maximal statements per block\n"
+    "  --expression-length=N    maximal operands per expression\n"
+    "  --members=N              maximal members of classes/enums/traits\n"
+    "  --templates=N            maximal template parameters\n"
+    "  --output=FILE            output file (default: stdout)\n";
+}
+
+int main(int argsc, char *argsv[]) {
+  const std::vector<std::pair<std::string, size_t GeneratorShape::*>> limits{
+    {"--depth=", &GeneratorShape::nestingDepth},
+    {"--statements=", &GeneratorShape::blockStatements},
+    {"--expression-length=", &GeneratorShape::expressionLength},
+    {"--members=", &GeneratorShape::members},
+    {"--templates=", &GeneratorShape::templateParameters}};
+
+  GeneratorShape shape;
+  getGeneratorShape(shape, "mixed");
+  // limits are applied after the preset
+  std::vector<std::pair<size_t GeneratorShape::*, size_t>> overrides;
+  size_t seed = 0, size = size_t(64) << 10;
+  std::string output;
+  for (int i = 1; i < argsc; ++i) {
+    const std::string arg(argsv[i]);
+    auto limit = std::find_if(limits.begin(), limits.end(),
+        [&arg](const auto &limit) { return _startsWith(arg, limit.first); });
+    if (arg == "--help") {
+      _printUsage();
+      return 0;
+    } else if (limit != limits.end()) {
+      size_t value;
+      if (!_parseSize(value, arg.substr(limit->first.length()))) {
+        std::cerr << "Invalid limit: " << arg << std::endl;
+        return 1;
+      }
+
+      overrides.emplace_back(limit->second, value);
+    } else if (_startsWith(arg, "--seed=")) {
+      if (!_parseSize(seed, arg.substr(std::strlen("--seed=")))) {
+        std::cerr << "Invalid seed: " << arg << std::endl;
+        return 1;
+      }
+    } else if (_startsWith(arg, "--size=")) {
+      if (!_parseSize(size, arg.substr(std::strlen("--size=")))
+          || size == 0) {
+        std::cerr << "Invalid size: " << arg << std::endl;
+        return 1;
+      }
+    } else if (_startsWith(arg, "--shape=")) {
+      if (!getGeneratorShape(shape, arg.substr(std::strlen("--shape=")))) {
+        std::cerr << "Unknown shape: " << arg << std::endl;
+        return 1;
+      }
+    } else if (_startsWith(arg, "--output=")) {
+      output = arg.substr(std::strlen("--output="));
+    } else {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      return 1;
+    }
+  }
+
+  for (const auto &limit : overrides)
+    shape.*limit.first = limit.second;
+
+  ProgramGenerator generator(shape, seed);
+  if (output.empty()) {
+    generator.generate(std::cout, size);
+    return std::cout.flush() ? 0 : 1;
+  }
+
+  std::ofstream file(output, std::ios::binary);
+  if (!file) {
+    std::cerr << "Cannot open file: " << output << std::endl;
+    return 1;
+  }
+
+  generator.generate(file, size);
+  file.close();
+  return file ? 0 : 1;
+}
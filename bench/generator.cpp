@@ -0,0 +1,546 @@
+#include "generator.hpp"
+using namespace pfederc;
+using namespace pfederc::bench;
+
+//! Operands per line of long expressions
+constexpr size_t OPERANDS_PER_LINE = 16;
+//! Maximal depth of nested modules
+constexpr size_t MODULE_DEPTH = 2;
+
+static const char *const _arithmetic[] = {
+  " + ", " - ", " * ", " / ", " % ", " + ", " - ", " * ", " & ", " | ", " ^ "};
+static const char *const _comparisons[] = {
+  " < ", " <= ", " > ", " >= ", " == ", " != "};
+static const char *const _assignments[] = {" = ", " += ", " -= ", " *= "};
+static const char *const _types[] = {"i32", "i64", "u32", "bool", "u8"};
+
+template<size_t N>
+constexpr size_t _length(const char *const (&)[N]) noexcept {
+  return N;
+}
+
+bool pfederc::bench::getGeneratorShape(GeneratorShape &shape,
+    const std::string &name) noexcept {
+  if (name == "mixed")
+    shape = GeneratorShape{8, 3, 2, 2, 1, 3, 3, 4, 8, 6, 2};
+  else if (name == "functions")
+    shape = GeneratorShape{1, 0, 0, 0, 0, 0, 1, 3, 6, 0, 0};
+  else if (name == "nested")
+    shape = GeneratorShape{1, 0, 0, 0, 0, 0, 24, 2, 4, 0, 0};
+  else if (name == "expressions")
+    shape = GeneratorShape{4, 0, 0, 0, 0, 1, 1, 2, 256, 0, 0};
+  else if (name == "types")
+    shape = GeneratorShape{1, 4, 4, 4, 1, 0, 1, 2, 4, 64, 0};
+  else if (name == "templates")
+    shape = GeneratorShape{4, 3, 2, 3, 0, 0, 2, 3, 6, 8, 6};
+  else
+    return false;
+
+  return true;
+}
+
+const std::vector<std::string> &
+    pfederc::bench::getGeneratorShapeNames() noexcept {
+  static const std::vector<std::string> names{
+    "mixed", "functions", "nested", "expressions", "types", "templates"};
+  return names;
+}
+
+//! Arity of generated function with index i (calls pass the same count)
+inline static size_t _arity(size_t i) noexcept {
+  return 1 + i % 3;
+}
+
+// ProgramGenerator
+ProgramGenerator::ProgramGenerator(const GeneratorShape &shape,
+    uint64_t seed) noexcept
+    : shape{shape}, state{seed}, functions{0}, classes{0}, enums{0},
+      traits{0}, modules{0}, variables{0}, locals{0}, nesting{0} {
+}
+
+ProgramGenerator::~ProgramGenerator() {
+}
+
+uint64_t ProgramGenerator::next() noexcept {
+  uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+size_t ProgramGenerator::uniform(size_t n) noexcept {
+  return n == 0 ? 0 : static_cast<size_t>(next() % n);
+}
+
+size_t ProgramGenerator::between1(size_t n) noexcept {
+  return 1 + uniform(std::max<size_t>(n, 1));
+}
+
+bool ProgramGenerator::chance(size_t percent) noexcept {
+  return uniform(100) < percent;
+}
+
+void ProgramGenerator::indent(std::string &out, size_t depth) noexcept {
+  out.append(2 * depth, ' ');
+}
+
+void ProgramGenerator::templates(std::string &out, bool constraints) noexcept {
+  if (shape.templateParameters == 0 || !chance(40))
+    return;
+
+  out += '{';
+  const size_t count = between1(shape.templateParameters);
+  for (size_t i = 0; i < count; ++i) {
+    if (i > 0)
+      out += ", ";
+
+    out += "A" + std::to_string(i);
+    if (constraints && traits > 0 && chance(50))
+      out += ": T" + std::to_string(uniform(traits));
+  }
+
+  out += '}';
+}
+
+void ProgramGenerator::parameters(std::string &out, size_t arity) noexcept {
+  out += '(';
+  for (size_t i = 0; i < arity; ++i) {
+    if (i > 0)
+      out += ", ";
+
+    const std::string name = "p" + std::to_string(i);
+    out += name + ": " + _types[uniform(_length(_types))];
+    scope.push_back(name);
+  }
+
+  out += ')';
+}
+
+void ProgramGenerator::leaf(std::string &out) noexcept {
+  if (!scope.empty() && chance(60))
+    out += scope[uniform(scope.size())];
+  else
+    out += std::to_string(between1(999));
+}
+
+void ProgramGenerator::atom(std::string &out, size_t parens) noexcept {
+  const size_t kind = uniform(100);
+  if (kind < 60) {
+    leaf(out);
+  } else if (kind < 72 && functions > 0) {
+    call(out);
+  } else if (kind < 78 && parens > 0) {
+    out += '[';
+    chain(out, between1(2), parens - 1);
+    out += ", ";
+    chain(out, between1(2), parens - 1);
+    out += "][" + std::to_string(uniform(2)) + ']';
+  } else if (kind < 92 && parens > 0) {
+    out += '(';
+    chain(out, 1 + between1(4), parens - 1);
+    out += ')';
+  } else {
+    out += '-';
+    leaf(out);
+  }
+}
+
+void ProgramGenerator::call(std::string &out) noexcept {
+  const size_t fn = uniform(functions);
+  out += "f" + std::to_string(fn);
+  if (shape.templateParameters > 0 && chance(30)) {
+    out += '{';
+    const size_t count = between1(shape.templateParameters);
+    for (size_t i = 0; i < count; ++i) {
+      if (i > 0)
+        out += ", ";
+
+      if (classes > 0 && chance(50))
+        out += "C" + std::to_string(uniform(classes));
+      else
+        out += _types[uniform(_length(_types))];
+    }
+
+    out += '}';
+  }
+
+  out += '(';
+  for (size_t i = 0; i < _arity(fn); ++i) {
+    if (i > 0)
+      out += ", ";
+
+    leaf(out);
+  }
+
+  out += ')';
+}
+
+void ProgramGenerator::chain(std::string &out, size_t operands,
+    size_t parens) noexcept {
+  for (size_t i = 0; i < operands; ++i) {
+    if (i > 0) {
+      out += _arithmetic[uniform(_length(_arithmetic))];
+      // binary operators continue on the next line
+      if (i % OPERANDS_PER_LINE == 0) {
+        out.pop_back();
+        out += '\n';
+      }
+    }
+
+    atom(out, parens);
+  }
+}
+
+void ProgramGenerator::expression(std::string &out) noexcept {
+  chain(out, between1(shape.expressionLength), 2);
+}
+
+void ProgramGenerator::condition(std::string &out) noexcept {
+  const size_t comparisons = chance(30) ? 2 : 1;
+  for (size_t i = 0; i < comparisons; ++i) {
+    if (i > 0)
+      out += chance(50) ? " && " : " || ";
+
+    const bool negate = chance(10);
+    if (negate)
+      out += "!(";
+
+    chain(out, between1((shape.expressionLength + 1) / 2), 1);
+    out += _comparisons[uniform(_length(_comparisons))];
+    chain(out, between1((shape.expressionLength + 1) / 2), 1);
+    if (negate)
+      out += ')';
+  }
+}
+
+void ProgramGenerator::statement(std::string &out, size_t depth,
+    bool spine) noexcept {
+  const size_t scopeSize = scope.size();
+  size_t kind = uniform(60);
+  if (nesting < std::min(shape.nestingDepth, GENERATOR_MAX_NESTING_DEPTH))
+    kind = spine ? 60 + uniform(40) : uniform(100);
+
+  indent(out, depth);
+  if (kind < 30 || (kind < 45 && scope.empty())) {
+    const std::string name = "v" + std::to_string(locals++);
+    out += name + " := ";
+    expression(out);
+    out += '\n';
+    // declared after the expression
+    scope.push_back(name);
+    return;
+  } else if (kind < 45) {
+    out += scope[uniform(scope.size())]
+      + _assignments[uniform(_length(_assignments))];
+    expression(out);
+    out += '\n';
+    return;
+  } else if (kind < 60) {
+    if (functions > 0)
+      call(out);
+    else
+      out += "v" + std::to_string(locals++) + " := 0";
+
+    out += '\n';
+    return;
+  }
+
+  // the spine continues in one block only, else programs grow exponentially
+  ++nesting;
+  if (kind < 75) {
+    out += "if ";
+    condition(out);
+    out += '\n';
+    block(out, depth + 1, spine);
+    for (size_t i = chance(30) ? between1(2) : 0; i > 0; --i) {
+      indent(out, depth);
+      out += "else if ";
+      condition(out);
+      out += '\n';
+      block(out, depth + 1, false);
+    }
+
+    if (chance(40)) {
+      indent(out, depth);
+      out += "else\n";
+      block(out, depth + 1, false);
+    }
+  } else if (kind < 87) {
+    const std::string name = "v" + std::to_string(locals++);
+    out += "for " + name + " := 0; " + name + " < ";
+    atom(out, 0);
+    out += "; ++" + name + '\n';
+    scope.push_back(name);
+    block(out, depth + 1, spine);
+  } else if (kind < 94) {
+    out += "do\n";
+    block(out, depth + 1, spine);
+    indent(out, depth);
+    out += "; for ";
+    condition(out);
+    out += '\n';
+    --nesting;
+    scope.resize(scopeSize);
+    return;
+  } else {
+    out += "match ";
+    expression(out);
+    out += '\n';
+    for (size_t i = between1(3); i > 0; --i) {
+      indent(out, depth + 1);
+      out += std::to_string(i) + " =>\n";
+      block(out, depth + 2, spine && i == 1);
+      indent(out, depth + 1);
+      out += ";\n";
+    }
+
+    indent(out, depth + 1);
+    out += "_ =>\n";
+    indent(out, depth + 1);
+    out += ";\n";
+  }
+
+  indent(out, depth);
+  out += ";\n";
+  --nesting;
+  scope.resize(scopeSize);
+}
+
+void ProgramGenerator::block(std::string &out, size_t depth,
+    bool spine) noexcept {
+  const size_t scopeSize = scope.size();
+  const size_t statements = between1(shape.blockStatements);
+  const size_t spineStatement = uniform(statements);
+  for (size_t i = 0; i < statements; ++i)
+    statement(out, depth, spine && i == spineStatement);
+
+  scope.resize(scopeSize);
+}
+
+void ProgramGenerator::function(std::string &out, size_t depth,
+    const std::string &name, size_t arity, bool body) noexcept {
+  const size_t scopeSize = scope.size();
+  indent(out, depth);
+  out += "func";
+  // trait functions aren't templates
+  if (body)
+    templates(out, true);
+
+  out += ' ' + name;
+  parameters(out, arity);
+  out += ": i32";
+  if (!body) {
+    out += ";\n";
+    scope.resize(scopeSize);
+    return;
+  }
+
+  out += '\n';
+  locals = 0;
+  nesting = 0;
+  block(out, depth + 1, chance(50));
+  indent(out, depth + 1);
+  out += "return ";
+  expression(out);
+  out += '\n';
+  indent(out, depth);
+  out += ";\n";
+  scope.resize(scopeSize);
+}
+
+void ProgramGenerator::definition(std::string &out, size_t depth) noexcept {
+  const size_t modulesWeight = depth < MODULE_DEPTH ? shape.moduleWeight : 0;
+  const size_t weights[] = {shape.functionWeight, shape.classWeight,
+    shape.enumWeight, shape.traitWeight, modulesWeight, shape.variableWeight};
+  size_t total = 0;
+  for (size_t weight : weights)
+    total += weight;
+
+  // functions, if all weights are 0
+  size_t pick = uniform(total);
+  size_t kind = 0;
+  while (kind + 1 < sizeof(weights) / sizeof(*weights) && pick >= weights[kind])
+    pick -= weights[kind++];
+
+  switch (kind) {
+  case 1:
+    classDefinition(out, depth);
+    break;
+  case 2:
+    enumDefinition(out, depth);
+    break;
+  case 3:
+    traitDefinition(out, depth);
+    break;
+  case 4:
+    moduleDefinition(out, depth);
+    break;
+  case 5:
+    variableDefinition(out, depth);
+    break;
+  default:
+    functionDefinition(out, depth);
+    break;
+  }
+}
+
+void ProgramGenerator::functionDefinition(std::string &out,
+    size_t depth) noexcept {
+  const size_t directive = uniform(100);
+  if (directive < 10) {
+    indent(out, depth);
+    out += "#Inline\n";
+  } else if (directive < 15) {
+    indent(out, depth);
+    out += "#!requires p0 > 0\n";
+  }
+
+  const size_t fn = functions++;
+  function(out, depth, "f" + std::to_string(fn), _arity(fn), true);
+}
+
+void ProgramGenerator::classDefinition(std::string &out,
+    size_t depth) noexcept {
+  indent(out, depth);
+  const bool classTrait = traits > 0 && classes > 0 && chance(25);
+  if (classTrait) {
+    out += "class trait C" + std::to_string(uniform(classes))
+      + " : T" + std::to_string(uniform(traits)) + '\n';
+  } else {
+    out += "class";
+    templates(out, true);
+    out += " C" + std::to_string(classes++);
+    if (chance(60))
+      parameters(out, between1(3));
+
+    out += '\n';
+  }
+
+  const size_t scopeSize = scope.size();
+  const size_t members = between1(shape.members);
+  for (size_t i = 0; i < members; ++i) {
+    const std::string name = "w" + std::to_string(i);
+    if (!classTrait && chance(50)) {
+      indent(out, depth + 1);
+      out += name + ": " + _types[uniform(_length(_types))] + '\n';
+      scope.push_back(name);
+    } else {
+      function(out, depth + 1, "get" + std::to_string(i), 1, true);
+    }
+  }
+
+  scope.resize(scopeSize);
+  indent(out, depth);
+  out += ";\n";
+}
+
+void ProgramGenerator::enumDefinition(std::string &out, size_t depth) noexcept {
+  indent(out, depth);
+  out += "enum";
+  templates(out, false);
+  out += " E" + std::to_string(enums++) + '\n';
+  const size_t constructors = between1(shape.members);
+  for (size_t i = 0; i < constructors; ++i) {
+    indent(out, depth + 1);
+    out += "K" + std::to_string(i);
+    if (chance(50)) {
+      out += '(';
+      for (size_t j = between1(3); j > 0; --j) {
+        out += _types[uniform(_length(_types))];
+        if (j > 1)
+          out += ", ";
+      }
+
+      out += ')';
+    }
+
+    out += '\n';
+  }
+
+  indent(out, depth);
+  out += ";\n";
+}
+
+void ProgramGenerator::traitDefinition(std::string &out,
+    size_t depth) noexcept {
+  indent(out, depth);
+  out += "trait";
+  templates(out, true);
+  out += " T" + std::to_string(traits);
+  if (traits > 0 && chance(30))
+    out += " : T" + std::to_string(uniform(traits));
+
+  ++traits;
+  out += '\n';
+  const size_t functions = between1(shape.members);
+  for (size_t i = 0; i < functions; ++i)
+    function(out, depth + 1, "t" + std::to_string(i), between1(3), false);
+
+  indent(out, depth);
+  out += ";\n";
+}
+
+void ProgramGenerator::moduleDefinition(std::string &out,
+    size_t depth) noexcept {
+  indent(out, depth);
+  out += "module m" + std::to_string(modules++) + '\n';
+  for (size_t i = between1(shape.members); i > 0; --i)
+    definition(out, depth + 1);
+
+  indent(out, depth);
+  out += ";\n";
+}
+
+void ProgramGenerator::variableDefinition(std::string &out,
+    size_t depth) noexcept {
+  indent(out, depth);
+  out += "g" + std::to_string(variables++);
+  if (chance(30))
+    out += " : i32 =";
+  else
+    out += " :=";
+
+  // no variables in scope, literals and calls only
+  out += ' ';
+  expression(out);
+  out += '\n';
+}
+
+size_t ProgramGenerator::generate(std::ostream &out, size_t size) noexcept {
+  std::string definitions;
+  size_t written = 0;
+  while (written < size) {
+    definitions.clear();
+    definition(definitions, 0);
+    out.write(definitions.data(), definitions.size());
+    written += definitions.size();
+  }
+
+  return written;
+}
+
+std::string ProgramGenerator::generate(size_t size) noexcept {
+  std::string program;
+  while (program.size() < size)
+    definition(program, 0);
+
+  return program;
+}
+
+std::string ProgramGenerator::generateExpression(size_t size) noexcept {
+  std::vector<std::string> scopeBackup = std::move(scope);
+  scope = {"x", "y", "z"};
+  functions = std::max<size_t>(functions, 1);
+
+  std::string expr;
+  while (expr.size() < size) {
+    if (!expr.empty())
+      expr += _arithmetic[uniform(_length(_arithmetic))];
+
+    chain(expr, OPERANDS_PER_LINE - 1, 2);
+  }
+
+  expr += '\n';
+  scope = std::move(scopeBackup);
+  return expr;
+}
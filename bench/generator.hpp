@@ -0,0 +1,130 @@
+#ifndef PFEDERC_BENCH_GENERATOR_HPP
+#define PFEDERC_BENCH_GENERATOR_HPP
+
+#include "pfederc/core.hpp"
+#include "pfederc/syntax.hpp"
+
+namespace pfederc {
+  namespace bench {
+    /*!\brief Maximal depth of nested blocks, deeper programs wouldn't
+     * parse. Modules, functions and expressions in the innermost blocks
+     * nest further (up to PARSER_MAX_DEPTH).
+     */
+    constexpr size_t GENERATOR_MAX_NESTING_DEPTH = PARSER_MAX_DEPTH - 32;
+
+    /*!\brief Shape of generated programs
+     *
+     * Weights are relative frequencies of top-level definitions, a weight of
+     * 0 disables the definition. Limits bound the size of single
+     * definitions, so programs of any size are generated with constant
+     * memory.
+     */
+    struct GeneratorShape {
+      size_t functionWeight;
+      size_t classWeight;
+      size_t enumWeight;
+      size_t traitWeight;
+      size_t moduleWeight;
+      size_t variableWeight;
+
+      //! Maximal depth of nested if/for/do/match blocks (at most
+      //! GENERATOR_MAX_NESTING_DEPTH)
+      size_t nestingDepth;
+      //! Maximal statements per block
+      size_t blockStatements;
+      //! Maximal operands per expression
+      size_t expressionLength;
+      //! Maximal fields/methods of classes, constructors of enums and
+      //! functions of traits
+      size_t members;
+      //! Maximal template parameters (0: no templates)
+      size_t templateParameters;
+    };
+
+    /*!\brief Sets shape to the preset name (mixed, functions, nested,
+     * expressions, types, templates)
+     * \param shape
+     * \param name
+     * \return Returns false, if name isn't a preset
+     */
+    bool getGeneratorShape(GeneratorShape &shape,
+        const std::string &name) noexcept;
+
+    //! Names of all presets accepted by getGeneratorShape
+    const std::vector<std::string> &getGeneratorShapeNames() noexcept;
+
+    /*!\brief Deterministic generator of Feder programs
+     *
+     * Equal seeds and shapes generate equal programs on all platforms.
+     * Generated programs lex and parse without errors, names are only
+     * partially resolvable (no semantic guarantees).
+     */
+    class ProgramGenerator final {
+      const GeneratorShape shape;
+      uint64_t state;
+
+      size_t functions, classes, enums, traits, modules, variables;
+      size_t locals; //!< local variables of the current function
+      size_t nesting; //!< depth of nested blocks in the current function
+      std::vector<std::string> scope; //!< variables usable in expressions
+
+      //! Returns next pseudo-random number (splitmix64)
+      uint64_t next() noexcept;
+      //! Returns a pseudo-random number in [0, n)
+      size_t uniform(size_t n) noexcept;
+      //! Returns a pseudo-random number in [1, max(n, 1)]
+      size_t between1(size_t n) noexcept;
+      bool chance(size_t percent) noexcept;
+
+      void indent(std::string &out, size_t depth) noexcept;
+      void templates(std::string &out, bool constraints) noexcept;
+      void parameters(std::string &out, size_t arity) noexcept;
+
+      //! Appends a variable or literal
+      void leaf(std::string &out) noexcept;
+      void atom(std::string &out, size_t parens) noexcept;
+      void call(std::string &out) noexcept;
+      void chain(std::string &out, size_t operands, size_t parens) noexcept;
+      void expression(std::string &out) noexcept;
+      void condition(std::string &out) noexcept;
+
+      /*!\brief Appends a statement, spine statements are nested blocks
+       * until the nesting depth is reached
+       */
+      void statement(std::string &out, size_t depth, bool spine) noexcept;
+      void block(std::string &out, size_t depth, bool spine) noexcept;
+
+      void function(std::string &out, size_t depth,
+          const std::string &name, size_t arity, bool body) noexcept;
+      void definition(std::string &out, size_t depth) noexcept;
+      void functionDefinition(std::string &out, size_t depth) noexcept;
+      void classDefinition(std::string &out, size_t depth) noexcept;
+      void enumDefinition(std::string &out, size_t depth) noexcept;
+      void traitDefinition(std::string &out, size_t depth) noexcept;
+      void moduleDefinition(std::string &out, size_t depth) noexcept;
+      void variableDefinition(std::string &out, size_t depth) noexcept;
+    public:
+      ProgramGenerator(const GeneratorShape &shape, uint64_t seed) noexcept;
+      ProgramGenerator(const ProgramGenerator &) = delete;
+      ~ProgramGenerator();
+
+      /*!\brief Writes top-level definitions to out, until at least size
+       * bytes are written
+       * \param out
+       * \param size
+       * \return Returns number of written bytes
+       */
+      size_t generate(std::ostream &out, size_t size) noexcept;
+
+      //! Returns a program of at least size bytes
+      std::string generate(size_t size) noexcept;
+
+      /*!\return Returns a single expression (one line) of at least size
+       * bytes
+       */
+      std::string generateExpression(size_t size) noexcept;
+    };
+  }
+}
+
+#endif /* PFEDERC_BENCH_GENERATOR_HPP */
@@ -0,0 +1,261 @@
+#include "fuzz.hpp"
+#include "pfederc/instrumentation.hpp"
+#include <csignal>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sys/time.h>
+#include <unistd.h>
+using namespace pfederc;
+
+/* Runs fuzz targets without libFuzzer. Inputs are files and directories
+ * (their files in sorted order), each input is run once and fails if it
+ * runs longer than --timeout (a CPU timer stops runs, which don't end).
+ * With --detect each input is repeated until a run takes
+ * DETECT_MIN_SECONDS, then the repetitions are multiplied by
+ * DETECT_GROWTH. Inputs fail if time or peak memory (with
+ * instrumentation) grow by more than --max-ratio, linear inputs grow by
+ * DETECT_GROWTH and quadratic ones by its square. Time is CPU time, so
+ * concurrently running processes (e.g. ctest -j) don't distort ratios.
+ * Grown inputs run longer by design, so --timeout only limits plain runs.
+ */
+
+//! Repeated inputs run at least (unless limited by DETECT_MAX_SIZE)
+constexpr double DETECT_MIN_SECONDS = 0.02;
+//! Maximal size of grown inputs in bytes
+constexpr size_t DETECT_MAX_SIZE = size_t(4) << 20;
+//! Factor of repetitions of the grown input
+constexpr size_t DETECT_GROWTH = 4;
+//! Runs per measurement, the minimum is measured
+constexpr size_t DETECT_RUNS = 5;
+
+//! Input of the current run, reported by _onTimeout
+static const char *volatile _currentInput = "";
+//! CPU time limit per run in seconds, 0 is no limit
+static double _timeout = 0;
+
+static void _write(const char *str) noexcept {
+  const ssize_t written = write(STDOUT_FILENO, str, std::strlen(str));
+  (void) written;
+}
+
+//! SIGPROF handler, the run exceeded _timeout
+static void _onTimeout(int) noexcept {
+  _write(_currentInput);
+  _write(": timeout\n");
+  _exit(1);
+}
+
+//! Sets the CPU timer (SIGPROF) to seconds, 0 stops the timer
+static void _setTimer(double seconds) noexcept {
+  itimerval timer{};
+  timer.it_value.tv_sec = static_cast<time_t>(seconds);
+  timer.it_value.tv_usec = static_cast<suseconds_t>(
+      (seconds - timer.it_value.tv_sec) * 1e6);
+  if (seconds > 0 && timer.it_value.tv_sec == 0 && timer.it_value.tv_usec == 0)
+    timer.it_value.tv_usec = 1;
+
+  setitimer(ITIMER_PROF, &timer, nullptr);
+}
+
+struct _Measurement final {
+  double seconds; //!< CPU time
+  //! Peak allocated bytes, 0 without instrumentation
+  uint64_t bytes;
+};
+
+/*!\brief Runs input once, lexer and parser are measured as parse phase
+ * \param timeout CPU time limit in seconds, 0 is no limit
+ */
+static _Measurement _run(const std::string &input,
+    double timeout = 0) noexcept {
+  instrumentation::reset();
+  _setTimer(timeout);
+  const std::clock_t start = std::clock();
+  {
+    ScopedPhase phase(Phase::PARSE);
+    LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(input.data()),
+        input.size());
+  }
+  const std::clock_t duration = std::clock() - start;
+  _setTimer(0);
+
+  return _Measurement{static_cast<double>(duration) / CLOCKS_PER_SEC,
+    instrumentation::collect().getPhase(Phase::PARSE).peakBytes};
+}
+
+static std::string _repeat(const std::string &input,
+    size_t repetitions) noexcept {
+  std::string result;
+  result.reserve(input.size() * repetitions);
+  for (size_t i = 0; i < repetitions; ++i)
+    result += input;
+
+  return result;
+}
+
+static _Measurement _measure(const std::string &input) noexcept {
+  _Measurement result{std::numeric_limits<double>::max(),
+    std::numeric_limits<uint64_t>::max()};
+  for (size_t i = 0; i < DETECT_RUNS; ++i) {
+    const _Measurement measurement = _run(input);
+    result.seconds = std::min(result.seconds, measurement.seconds);
+    result.bytes = std::min(result.bytes, measurement.bytes);
+  }
+
+  return result;
+}
+
+/*!\return Returns false, if time or memory of input grow superlinear with
+ * its repetitions
+ */
+static bool _detect(const std::string &path, const std::string &input,
+    double maxRatio) noexcept {
+  if (input.empty())
+    return true;
+
+  size_t repetitions = 1;
+  while (input.size() * repetitions * 2 * DETECT_GROWTH <= DETECT_MAX_SIZE
+      && _run(_repeat(input, repetitions)).seconds < DETECT_MIN_SECONDS)
+    repetitions *= 2;
+
+  const _Measurement base = _measure(_repeat(input, repetitions));
+  const _Measurement grown =
+    _measure(_repeat(input, repetitions * DETECT_GROWTH));
+  const double timeRatio = grown.seconds
+    / std::max(base.seconds, std::numeric_limits<double>::min());
+  const double memoryRatio = base.bytes == 0 ? 0
+    : static_cast<double>(grown.bytes) / base.bytes;
+  if (timeRatio <= maxRatio && memoryRatio <= maxRatio)
+    return true;
+
+  std::cout << path << ": superlinear, " << repetitions << " to "
+    << repetitions * DETECT_GROWTH << " repetitions: time "
+    << base.seconds << " s to " << grown.seconds << " s";
+  if (base.bytes != 0)
+    std::cout << ", memory " << base.bytes << " B to " << grown.bytes << " B";
+
+  std::cout << std::endl;
+  return false;
+}
+
+//! Appends path, or the files of directory path in sorted order
+static bool _addInputs(const std::string &path,
+    std::vector<std::string> &inputs) noexcept {
+  std::error_code err;
+  if (!std::filesystem::is_directory(path, err)) {
+    inputs.push_back(path);
+    return true;
+  }
+
+  std::vector<std::string> files;
+  for (std::filesystem::directory_iterator it(path, err), end;
+      !err && it != end; it.increment(err)) {
+    if (it->is_regular_file(err))
+      files.push_back(it->path().string());
+  }
+
+  if (err) {
+    std::cerr << "Cannot read directory: " << path << std::endl;
+    return false;
+  }
+
+  std::sort(files.begin(), files.end());
+  inputs.insert(inputs.end(), files.begin(), files.end());
+  return true;
+}
+
+static bool _readFile(const std::string &path, std::string &result) noexcept {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    std::cerr << "Cannot open file: " << path << std::endl;
+    return false;
+  }
+
+  result.assign(std::istreambuf_iterator<char>(file),
+    std::istreambuf_iterator<char>());
+  return !file.bad();
+}
+
+inline static bool _startsWith(const std::string &str,
+    const std::string &prefix) noexcept {
+  return str.compare(0, prefix.length(), prefix) == 0;
+}
+
+static void _printUsage(const char *program) noexcept {
+  std::cout << program << " [options] FILE|DIRECTORY...\n"
+    "  --timeout=SECONDS    fail runs of inputs running longer (CPU time,\n"
+    "                       default: no limit, ignored with --detect)\n"
+    "  --detect             fail inputs with superlinear time or memory\n"
+    "  --max-ratio=R        maximal growth of time and memory, if the input\n"
+    "                       is repeated " << DETECT_GROWTH
+    << " times as often (default: 8)\n";
+}
+
+int main(int argsc, char *argsv[]) {
+  bool detect = false;
+  double maxRatio = 8;
+  std::vector<std::string> inputs;
+  for (int i = 1; i < argsc; ++i) {
+    const std::string arg(argsv[i]);
+    if (arg == "--help") {
+      _printUsage(argsv[0]);
+      return 0;
+    } else if (arg == "--detect") {
+      detect = true;
+    } else if (_startsWith(arg, "--timeout=")) {
+      _timeout = std::strtod(arg.c_str() + std::strlen("--timeout="), nullptr);
+      if (!(_timeout > 0)) {
+        std::cerr << "Invalid timeout: " << arg << std::endl;
+        return 1;
+      }
+    } else if (_startsWith(arg, "--max-ratio=")) {
+      maxRatio = std::strtod(arg.c_str() + std::strlen("--max-ratio="),
+          nullptr);
+      if (!(maxRatio > 0)) {
+        std::cerr << "Invalid ratio: " << arg << std::endl;
+        return 1;
+      }
+    } else if (_startsWith(arg, "--")) {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      return 1;
+    } else if (!_addInputs(arg, inputs)) {
+      return 1;
+    }
+  }
+
+  if (inputs.empty()) {
+    std::cerr << "Expected inputs" << std::endl;
+    return 1;
+  }
+
+  if (_timeout > 0)
+    std::signal(SIGPROF, _onTimeout);
+
+  instrumentation::setEnabled(detect);
+  size_t failed = 0;
+  for (const std::string &path : inputs) {
+    std::string input;
+    if (!_readFile(path, input))
+      return 1;
+
+    _currentInput = path.c_str();
+
+    if (detect) {
+      failed += !_detect(path, input, maxRatio);
+      continue;
+    }
+
+    const double seconds = _run(input, _timeout).seconds;
+    // the timer fires late, if the run ends before the next tick
+    if (_timeout > 0 && seconds > _timeout) {
+      std::cout << path << ": timeout, " << seconds << " s" << std::endl;
+      ++failed;
+    }
+  }
+
+  std::cout << inputs.size() << " inputs, " << failed << " failed"
+    << std::endl;
+  return failed > 0;
+}
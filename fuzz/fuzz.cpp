@@ -0,0 +1,113 @@
+#include "fuzz.hpp"
+#include "pfederc/errors.hpp"
+#include "pfederc/lexer.hpp"
+#include "pfederc/syntax.hpp"
+#include <sstream>
+using namespace pfederc;
+
+static const LanguageConfiguration _cfg = createDefaultLanguageConfiguration();
+
+//! Tokens of printable bytes, see decodeTokens
+static const std::pair<char, const char *> _PRINTABLE_TOKENS[] {
+  {' ', ""}, {'\t', ""}, {'\r', ""}, {'\n', "\n"},
+  {',', ","}, {'=', "="}, {'|', "|"}, {'^', "^"}, {'&', "&"}, {'>', ">"},
+  {'<', "<"}, {'+', "+"}, {'-', "-"}, {'%', "%"}, {'*', "*"}, {'/', "/"},
+  {':', ":"}, {'!', "!"}, {'~', "~"}, {'.', "."}, {';', ";"},
+  {'(', "("}, {')', ")"}, {'[', "["}, {']', "]"}, {'{', "{"}, {'}', "}"},
+  {'$', ":="}, {'?', "=>"}, {'`', "=="}, {'\'', "->"}, {'"', "&&"},
+  {'\\', "++"}, {'#', "#Inline"}, {'@', "#!requires"}, {'_', "_"},
+  {'0', "0"}, {'1', "1"}, {'2', "42u"}, {'3', "1.5"}, {'4', "0x1F"},
+  {'5', "'c'"}, {'6', "\"s\""}, {'7', "True"}, {'8', "False"},
+  {'9', "0b101s"},
+  {'b', "break"}, {'c', "class"}, {'d', "do"}, {'e', "else"},
+  {'f', "func"}, {'g', "module"}, {'h', "ensure"}, {'i', "if"},
+  {'j', "include"}, {'k', "continue"}, {'l', "lambda"}, {'m', "match"},
+  {'n', "enum"}, {'o', "for"}, {'p', "import"}, {'r', "return"},
+  {'s', "safe"}, {'t', "trait"}, {'u', "use"}, {'w', "switch"},
+  {'y', "type"},
+  {'a', "a"}, {'q', "q"}, {'v', "v"}, {'x', "x"}, {'z', "z"},
+};
+
+//! Returns tokens of all bytes
+static const std::array<std::string, 256> &_tokens() noexcept {
+  static const std::array<std::string, 256> tokens = []() {
+      std::vector<std::string> spellings;
+      for (const auto &keywords : KEYWORDS) {
+        for (const KeywordTuple &keyword : keywords)
+          spellings.push_back(std::get<1>(keyword));
+      }
+
+      for (const auto &operators : OPERATORS) {
+        for (const OperatorTuple &op : operators)
+          spellings.push_back(std::get<1>(op));
+      }
+
+      for (const char *bracket : {")", "]", "}"})
+        spellings.push_back(bracket);
+
+      std::array<std::string, 256> result;
+      for (size_t i = 0; i < result.size(); ++i)
+        result[i] = spellings[i % spellings.size()];
+
+      for (char c = 'A'; c <= 'Z'; ++c)
+        result[static_cast<uint8_t>(c)] = std::string(1, c);
+
+      for (const auto &token : _PRINTABLE_TOKENS)
+        result[static_cast<uint8_t>(token.first)] = token.second;
+
+      return result;
+    }();
+
+  return tokens;
+}
+
+//! Renders the diagnostics of lex and parser (optional) into a discarded
+//! stream, rendering reads the source around the positions
+static void _renderDiagnostics(const Lexer &lex,
+    const Parser *parser) noexcept {
+  std::ostringstream out;
+  Logger log(LVL_ALL, BaseLogger(out, out));
+  logLexerErrors(log, lex);
+  if (parser)
+    logParserErrors(log, *parser);
+}
+
+void pfederc::fuzz::lexBytes(const uint8_t *data, size_t size) noexcept {
+  std::istringstream input(std::string(
+      reinterpret_cast<const char *>(data), size));
+  Lexer lex(_cfg, input, "<fuzz>");
+  while (lex.next().getType() != TokenType::TOK_EOF) {
+  }
+
+  _renderDiagnostics(lex, nullptr);
+}
+
+std::string pfederc::fuzz::decodeTokens(const uint8_t *data,
+    size_t size) noexcept {
+  const std::array<std::string, 256> &tokens = _tokens();
+  std::string result;
+  result.reserve(size * 2);
+  for (size_t i = 0; i < size; ++i) {
+    const std::string &token = tokens[data[i]];
+    if (token.empty())
+      continue;
+
+    result += token;
+    if (token != "\n")
+      result += ' ';
+  }
+
+  return result;
+}
+
+void pfederc::fuzz::parseTokens(const uint8_t *data, size_t size) noexcept {
+  std::istringstream input(decodeTokens(data, size));
+  Lexer lex(_cfg, input, "<fuzz>");
+  lex.next();
+  Parser parser(lex);
+  std::unique_ptr<ProgramExpr> prog(parser.parseProgram());
+  if (prog)
+    prog->toString();
+
+  _renderDiagnostics(lex, &parser);
+}
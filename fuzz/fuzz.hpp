@@ -0,0 +1,41 @@
+#ifndef PFEDERC_FUZZ_FUZZ_HPP
+#define PFEDERC_FUZZ_FUZZ_HPP
+
+#include "pfederc/core.hpp"
+
+/*!\brief Entry point of a fuzz target (libFuzzer interface), defined once
+ * per target
+ * \return Returns 0
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+namespace pfederc {
+  namespace fuzz {
+    /*!\brief Lexes data (raw bytes) till end-of-file and renders the
+     * diagnostics
+     * \param data
+     * \param size
+     */
+    void lexBytes(const uint8_t *data, size_t size) noexcept;
+
+    /*!\brief Returns Feder code of the token stream data, every byte is one
+     * token
+     *
+     * Printable bytes are readable: operators and brackets are themselves,
+     * lowercase letters are keywords (f func, i if, e else, c class, ...)
+     * or identifiers (a, q, v, x, z), uppercase letters are identifiers,
+     * digits are literals and spaces are skipped. Other bytes select any
+     * keyword or operator of the lexer.
+     */
+    std::string decodeTokens(const uint8_t *data, size_t size) noexcept;
+
+    /*!\brief Parses the program of token stream data (see decodeTokens)
+     * and renders the diagnostics
+     * \param data
+     * \param size
+     */
+    void parseTokens(const uint8_t *data, size_t size) noexcept;
+  }
+}
+
+#endif /* PFEDERC_FUZZ_FUZZ_HPP */
@@ -0,0 +1,7 @@
+#include "fuzz.hpp"
+
+//! Lexes raw bytes (any input, including binary input)
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  pfederc::fuzz::lexBytes(data, size);
+  return 0;
+}
@@ -0,0 +1,7 @@
+#include "fuzz.hpp"
+
+//! Parses programs of token streams, see decodeTokens
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  pfederc::fuzz::parseTokens(data, size);
+  return 0;
+}
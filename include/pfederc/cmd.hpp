@@ -1,4 +1,62 @@
 #ifndef PFEDERC_EXE_CMD_HPP
 #define PFEDERC_EXE_CMD_HPP
 
+#include "pfederc/core.hpp"
+#include "pfederc/errors.hpp"
+
+namespace pfederc {
+  enum class StatsFormat {
+    NONE,
+    TEXT,
+    JSON,
+  };
+
+  /*!\brief Settings given by the command-line
+   */
+  struct CommandLine {
+    std::vector<std::string> files;
+    //! -O0, -O1, -O2 or --passes=pass0,pass1,...
+    std::string pipeline;
+    //! -jN or --jobs=N, number of threads
+    size_t jobs;
+    //! --list-passes, print registered passes and pipelines
+    bool listPasses;
+    //! --optimizer-stats[=text|json]
+    StatsFormat optimizerStats;
+    //! --print-ast, print optimized programs
+    bool printAst;
+    //! --unbuffered-diagnostics, write diagnostics immediately instead of
+    //! ordered after each file
+    bool unbufferedDiagnostics;
+    //! --diagnostics-format=text|jsonl|sarif
+    DiagnosticFormat diagnosticsFormat;
+    //! --diagnostics-output=FILE, write diagnostics to FILE instead of
+    //! stdout and stderr
+    std::string diagnosticsOutput;
+    //! -ferror-limit=N, stop after N errors (0: no limit)
+    size_t errorLimit;
+    //! -ftime-report[=text|json], print phase timings, memory and counters
+    StatsFormat timeReport;
+    //! -ftime-trace=FILE, write spans of all threads as Chrome trace events
+    std::string timeTrace;
+  };
+
+  inline CommandLine createDefaultCommandLine() noexcept {
+    return CommandLine{{}, "O1",
+      std::max<size_t>(std::thread::hardware_concurrency(), 1),
+      false, StatsFormat::NONE, false, false, DiagnosticFormat::TEXT, "",
+      20, StatsFormat::NONE, ""};
+  }
+
+  /*!\brief Parses command-line arguments
+   * \param cmd Is modified by arguments
+   * \param argsc
+   * \param argsv
+   * \param err Receives error messages
+   * \return Returns true, if arguments are valid, otherwise false.
+   */
+  bool parseCommandLine(CommandLine &cmd, int argsc, char * argsv[],
+      std::ostream &err) noexcept;
+}
+
 #endif /* PFEDERC_EXE_CMD_HPP */
@@ -2,11 +2,16 @@
 #define PFEDERC_CORE_CORE_HPP
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <bitset>
 #include <cassert>
 #include <cctype>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <cstring>
+#include <deque>
 #include <functional>
 #include <future>
 #include <iostream>
@@ -18,9 +23,12 @@
 #include <mutex>
 #include <ostream>
 #include <set>
+#include <shared_mutex>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -90,6 +98,15 @@ namespace pfederc {
       return (~c & 0x80) == 0x80
         || d == 0xC0 || d == 0xE0 || d == 0xF0;
     }
+
+    /*!\return Returns true, if data contains no NUL characters and is valid
+     * UTF-8 (no overlong encodings, surrogates or code points above
+     * U+10FFFF), otherwise false.
+     * \param data
+     * \param size
+     * \param partial If true, data may end with an incomplete character
+     */
+    bool isText(const char *data, size_t size, bool partial) noexcept;
   }
 }
 
@@ -0,0 +1,196 @@
+#ifndef PFEDERC_CORE_INSTRUMENTATION_HPP
+#define PFEDERC_CORE_INSTRUMENTATION_HPP
+
+#include "pfederc/core.hpp"
+#include <string_view>
+
+namespace pfederc {
+  /*!\brief Compiler phases measured by ScopedPhase
+   */
+  enum class Phase {
+    LEX,
+    PARSE,
+    OPTIMIZE,
+    SEMANTIC,
+    NONE, //!< No phase, ScopedPhase(Phase::NONE) doesn't measure anything
+  };
+
+  constexpr size_t PHASE_COUNT = static_cast<size_t>(Phase::SEMANTIC) + 1;
+
+  /*!\brief Events counted by instrumentation::count
+   */
+  enum class Counter {
+    TOKENS,      //!< Tokens lexed
+    EXPRESSIONS, //!< Expr nodes created
+    SYMBOLS,     //!< Symbols added to contexts
+    REWRITES,    //!< Rewrites applied by the optimizer
+  };
+
+  constexpr size_t COUNTER_COUNT = static_cast<size_t>(Counter::REWRITES) + 1;
+
+  /*!\return Returns name of phase
+   */
+  const char *phaseToString(Phase phase) noexcept;
+
+  /*!\return Returns name of counter
+   */
+  const char *counterToString(Counter counter) noexcept;
+
+  /*!\brief Measurements of a phase summed over all threads
+   */
+  struct PhaseMeasurement {
+    //! Thread time spent in the phase, excluding nested phases. Phases run
+    //! by several threads at once can exceed the wall time.
+    std::chrono::nanoseconds duration;
+    //! Number of ScopedPhase instances
+    uint64_t entries;
+    //! Allocations, excluding nested phases
+    uint64_t allocations;
+    //! Maximum bytes held by a thread above the level at phase start,
+    //! including nested phases
+    uint64_t peakBytes;
+  };
+
+  /*!\brief Snapshot of all phases and counters
+   */
+  class InstrumentationReport final {
+    std::array<PhaseMeasurement, PHASE_COUNT> phases;
+    std::array<uint64_t, COUNTER_COUNT> counters;
+  public:
+    InstrumentationReport() noexcept;
+    InstrumentationReport(const InstrumentationReport &) = default;
+    ~InstrumentationReport();
+
+    inline PhaseMeasurement &getPhase(Phase phase) noexcept
+    { return phases[static_cast<size_t>(phase)]; }
+    inline const PhaseMeasurement &getPhase(Phase phase) const noexcept
+    { return phases[static_cast<size_t>(phase)]; }
+
+    inline uint64_t &getCounter(Counter counter) noexcept
+    { return counters[static_cast<size_t>(counter)]; }
+    inline uint64_t getCounter(Counter counter) const noexcept
+    { return counters[static_cast<size_t>(counter)]; }
+
+    void printText(std::ostream &out) const noexcept;
+    void printJson(std::ostream &out) const noexcept;
+  };
+
+  /*!\brief Phase timers, counters, allocation tracking and tracing
+   *
+   * Measurements are only taken after setEnabled(true) was called, spans are
+   * only recorded after setTracing(true) was called. Without the compile
+   * definition PFEDERC_INSTRUMENTATION all functions are empty and the
+   * global allocation functions aren't replaced.
+   */
+  namespace instrumentation {
+#ifdef PFEDERC_INSTRUMENTATION
+    constexpr bool AVAILABLE = true;
+
+    void setEnabled(bool enabled) noexcept;
+    bool isEnabled() noexcept;
+
+    /*!\brief Adds n to counter, if enabled
+     * \param counter
+     * \param n
+     */
+    void count(Counter counter, uint64_t n = 1) noexcept;
+
+    /*!\return Returns the phase of the calling thread's innermost
+     * ScopedPhase, otherwise Phase::NONE.
+     *
+     * Worker threads pass it to their own ScopedPhase to continue the phase
+     * of the thread, which started them.
+     */
+    Phase getCurrentPhase() noexcept;
+
+    /*!\return Returns measurements of all threads (running and finished)
+     */
+    InstrumentationReport collect() noexcept;
+
+    /*!\brief Discards measurements of all threads
+     */
+    void reset() noexcept;
+
+    /*!\brief Starts or stops recording ScopedSpan instances. Timestamps are
+     * relative to the first call with tracing = true.
+     * \param tracing
+     */
+    void setTracing(bool tracing) noexcept;
+    bool isTracing() noexcept;
+
+    /*!\brief Writes the recorded spans of all threads in the Chrome trace
+     * event format (JSON object format, complete events)
+     * \param out
+     */
+    void writeTrace(std::ostream &out) noexcept;
+#else
+    constexpr bool AVAILABLE = false;
+
+    inline void setEnabled(bool) noexcept {}
+    inline bool isEnabled() noexcept { return false; }
+    inline void count(Counter, uint64_t = 1) noexcept {}
+    inline Phase getCurrentPhase() noexcept { return Phase::NONE; }
+    inline InstrumentationReport collect() noexcept { return {}; }
+    inline void reset() noexcept {}
+    inline void setTracing(bool) noexcept {}
+    inline bool isTracing() noexcept { return false; }
+    inline void writeTrace(std::ostream &) noexcept {}
+#endif /* PFEDERC_INSTRUMENTATION */
+  }
+
+  /*!\brief Measures the calling thread while in scope
+   *
+   * Nested phases pause the enclosing phase.
+   */
+  class ScopedPhase final {
+#ifdef PFEDERC_INSTRUMENTATION
+    Phase phase;
+    //! Phase of the enclosing ScopedPhase
+    Phase parent;
+    //! Allocated bytes of the thread at phase start
+    int64_t baseBytes;
+    //! Peak of the enclosing phase
+    int64_t parentPeakBytes;
+  public:
+    ScopedPhase(Phase phase) noexcept;
+    ~ScopedPhase();
+#else
+  public:
+    inline ScopedPhase(Phase) noexcept {}
+    inline ~ScopedPhase() {}
+#endif /* PFEDERC_INSTRUMENTATION */
+    ScopedPhase(const ScopedPhase &) = delete;
+  };
+
+  /*!\brief Records a span of the calling thread for the trace, if tracing
+   *
+   * Names are copied only while tracing. Callers computing a name should
+   * check instrumentation::isTracing() first.
+   */
+  class ScopedSpan final {
+#ifdef PFEDERC_INSTRUMENTATION
+    const char *category;
+    std::string name;
+    std::string file;
+    //! Start in nanoseconds, negative if not tracing
+    int64_t start;
+  public:
+    /*!\brief Initializes ScopedSpan
+     * \param category Static string, e.g. phase name
+     * \param name
+     * \param file Source file of the span, may be empty
+     */
+    ScopedSpan(const char *category, std::string_view name,
+        std::string_view file = std::string_view()) noexcept;
+    ~ScopedSpan();
+#else
+  public:
+    inline ScopedSpan(const char *, std::string_view,
+        std::string_view = std::string_view()) noexcept {}
+    inline ~ScopedSpan() {}
+#endif /* PFEDERC_INSTRUMENTATION */
+    ScopedSpan(const ScopedSpan &) = delete;
+  };
+}
+
+#endif /* PFEDERC_CORE_INSTRUMENTATION_HPP */
@@ -0,0 +1,93 @@
+#ifndef PFEDERC_CORE_INTERNER_HPP
+#define PFEDERC_CORE_INTERNER_HPP
+
+#include "pfederc/core.hpp"
+#include <string_view>
+
+namespace pfederc {
+  /*!\brief Identifier of an interned string. Equal strings have equal
+   * identifiers.
+   */
+  typedef uint32_t InternedId;
+
+  //! No string (e.g. unnamed symbols), never returned by intern
+  constexpr InternedId INTERNED_NONE = 0;
+
+  //! Number of independently locked parts of a StringInterner
+  constexpr size_t INTERNER_SHARDS = 16;
+  //! Number of strings in the first storage chunk (power of two)
+  constexpr size_t INTERNER_CHUNK0 = 1024;
+  //! Every chunk is twice the size of the previous one
+  constexpr size_t INTERNER_CHUNKS = 23;
+
+  /*!\brief Thread-safe string interner
+   *
+   * Strings are stored in chunks, which are never moved or freed before
+   * the interner is destroyed. Therefore get doesn't lock and returned
+   * references stay valid. The lookup table is split into INTERNER_SHARDS
+   * shards by string hash, every shard is guarded by a shared mutex.
+   */
+  class StringInterner final {
+    struct Shard {
+      mutable std::shared_mutex mtx;
+      //! keys reference strings in chunks
+      std::unordered_map<std::string_view, InternedId> ids;
+    };
+
+    std::array<Shard, INTERNER_SHARDS> shards;
+
+    std::mutex mtxChunks;
+    std::array<std::atomic<std::string*>, INTERNER_CHUNKS> chunks;
+    //! Next identifier
+    std::atomic<InternedId> next;
+
+    /*!\return Returns storage of string with id, the chunk is allocated if
+     * it doesn't exist yet.
+     */
+    std::string &store(InternedId id) noexcept;
+  public:
+    StringInterner() noexcept;
+    StringInterner(const StringInterner &) = delete;
+    ~StringInterner();
+
+    /*!\return Returns identifier of str. str is added, if it hasn't been
+     * interned yet.
+     * \param str
+     *
+     * This function is thread-safe.
+     */
+    InternedId intern(std::string_view str) noexcept;
+
+    /*!\return Returns identifier of str, INTERNED_NONE if str hasn't been
+     * interned yet.
+     * \param str
+     *
+     * This function is thread-safe.
+     */
+    InternedId find(std::string_view str) const noexcept;
+
+    /*!\return Returns interned string with identifier id. The empty string
+     * is returned for INTERNED_NONE.
+     * \param id Return value of intern
+     *
+     * This function is thread-safe and doesn't lock.
+     */
+    const std::string &get(InternedId id) const noexcept;
+
+    //! Returns number of interned strings
+    inline size_t size() const noexcept { return next - 1; }
+  };
+
+  /*!\return Returns the interner used for identifiers. Identifiers of
+   * different lexers (and threads) are comparable.
+   */
+  StringInterner &getStringInterner() noexcept;
+
+  inline InternedId intern(std::string_view str) noexcept
+  { return getStringInterner().intern(str); }
+
+  inline const std::string &internedString(InternedId id) noexcept
+  { return getStringInterner().get(id); }
+}
+
+#endif /* PFEDERC_CORE_INTERNER_HPP */
@@ -0,0 +1,61 @@
+#ifndef PFEDERC_CORE_JSON_HPP
+#define PFEDERC_CORE_JSON_HPP
+
+#include "pfederc/core.hpp"
+#include <string_view>
+
+namespace pfederc {
+  /*!\brief Appends str as quoted and escaped JSON string to out
+   * \param out
+   * \param str UTF-8 string, control characters are escaped
+   */
+  void appendJsonString(std::string &out, std::string_view str) noexcept;
+
+  /*!\brief Streaming JSON serializer
+   *
+   * Values are appended to a string as they are written, no document is
+   * built. Commas between members and elements are inserted automatically.
+   */
+  class JsonWriter final {
+    std::string &out;
+    //! Per open object/array: true, if no member/element was written yet
+    std::vector<bool> empty;
+    //! true, if a key was written and its value wasn't
+    bool afterKey;
+
+    //! Writes a comma, if the value isn't the first or follows a key
+    void separate() noexcept;
+  public:
+    /*!\brief Initializes JsonWriter
+     * \param out Values are appended to out
+     */
+    JsonWriter(std::string &out) noexcept;
+    JsonWriter(const JsonWriter &) = delete;
+    ~JsonWriter();
+
+    JsonWriter &beginObject() noexcept;
+    JsonWriter &endObject() noexcept;
+    JsonWriter &beginArray() noexcept;
+    JsonWriter &endArray() noexcept;
+
+    //! Writes the key of the next object member
+    JsonWriter &key(std::string_view name) noexcept;
+
+    JsonWriter &value(std::string_view str) noexcept;
+    inline JsonWriter &value(const char *str) noexcept
+    { return value(std::string_view(str)); }
+    inline JsonWriter &value(const std::string &str) noexcept
+    { return value(std::string_view(str)); }
+    JsonWriter &value(uint64_t num) noexcept;
+    JsonWriter &value(double num) noexcept;
+    JsonWriter &value(bool b) noexcept;
+
+    /*!\brief Writes key and value
+     */
+    template<class T>
+    inline JsonWriter &member(std::string_view name, const T &val) noexcept
+    { return key(name).value(val); }
+  };
+}
+
+#endif /* PFEDERC_CORE_JSON_HPP */
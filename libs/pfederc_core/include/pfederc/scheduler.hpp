@@ -0,0 +1,125 @@
+#ifndef PFEDERC_CORE_SCHEDULER_HPP
+#define PFEDERC_CORE_SCHEDULER_HPP
+
+#include "pfederc/core.hpp"
+#include "pfederc/instrumentation.hpp"
+
+namespace pfederc {
+  class TaskScheduler;
+
+  enum class TaskStatus {
+    //! Task is finished
+    DONE,
+    //! Task called TaskScheduler::suspend and has to be run again
+    SUSPENDED,
+  };
+
+  typedef std::function<TaskStatus(TaskScheduler&)> TaskFunction;
+
+  /*!\brief Work-stealing task pool
+   *
+   * Every worker has its own deque of tasks. Tasks spawned by a task are
+   * pushed to the deque of the current worker and are run in LIFO order by
+   * the owner, idle workers steal the oldest task from other workers.
+   *
+   * A task, which cannot continue before some other task has finished
+   * (e.g. a symbol isn't declared yet), calls suspend(key) and returns
+   * TaskStatus::SUSPENDED. The task is run again after notify(key) was
+   * called. If no task can run anymore, but suspended tasks exist, the
+   * scheduler is stalled: all suspended tasks are run again and isStalled()
+   * returns true.
+   *
+   * The worker threads are started by the first run and wait for the next
+   * run afterwards, so a scheduler can be reused without creating threads
+   * again.
+   */
+  class TaskScheduler final {
+    struct Worker {
+      std::mutex mtx;
+      std::deque<TaskFunction> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    //! Tasks in deques
+    std::atomic<size_t> queued;
+    //! Workers searching for or running a task
+    std::atomic<size_t> running;
+    std::atomic<bool> stalled;
+
+    //! Incremented by every notify
+    std::atomic<uint64_t> epoch;
+
+    //! Guards waiting, notified, finished
+    std::mutex mtxState;
+    std::condition_variable cvState;
+    std::map<std::string, std::vector<TaskFunction>> waiting;
+    //! Epoch of the last notify per key
+    std::map<std::string, uint64_t> notified;
+    bool finished;
+
+    //! Workers 1 to getThreads() - 1, started by the first run
+    std::vector<std::thread> threads;
+    //! Guards generation, active, stopping
+    std::mutex mtxRun;
+    std::condition_variable cvRun;
+    //! Incremented by every run
+    uint64_t generation;
+    //! Threads, which haven't finished the current run
+    size_t active;
+    bool stopping;
+    //! Phase of the thread calling run
+    Phase phase;
+
+    void push(size_t worker, TaskFunction &&task) noexcept;
+    bool pop(size_t worker, TaskFunction &task) noexcept;
+    void work(size_t worker) noexcept;
+    void park(std::string &&key, uint64_t start, TaskFunction &&task) noexcept;
+    //! Runs worker in every run until destruction
+    void serve(size_t worker) noexcept;
+  public:
+    /*!\brief Initializes TaskScheduler
+     * \param threads Number of workers (at least 1)
+     */
+    TaskScheduler(size_t threads = 1) noexcept;
+    TaskScheduler(const TaskScheduler &) = delete;
+    ~TaskScheduler();
+
+    inline size_t getThreads() const noexcept { return workers.size(); }
+
+    /*!\brief Adds task. Can be called before or while run is executed.
+     * \param task
+     *
+     * This function is thread-safe.
+     */
+    void spawn(TaskFunction &&task) noexcept;
+
+    /*!\brief Marks the currently running task as waiting for key. The task
+     * has to return TaskStatus::SUSPENDED afterwards.
+     * \param key
+     */
+    void suspend(const std::string &key) noexcept;
+
+    /*!\brief Resumes all tasks waiting for key (and tasks, which were
+     * running during notify and suspend on key)
+     * \param key
+     *
+     * This function is thread-safe.
+     */
+    void notify(const std::string &key) noexcept;
+
+    /*!\return Returns true, if suspended tasks were resumed, because no
+     * other task could run anymore.
+     */
+    inline bool isStalled() const noexcept { return stalled; }
+
+    /*!\brief Runs tasks until all tasks are done. The calling thread is
+     * worker 0.
+     *
+     * This function must not be called concurrently.
+     */
+    void run() noexcept;
+  };
+}
+
+#endif /* PFEDERC_CORE_SCHEDULER_HPP */
@@ -1,3 +1,50 @@
 #include "pfederc/core.hpp"
 using namespace pfederc;
 
+
+bool charset::isText(const char *data, size_t size, bool partial) noexcept {
+  for (size_t i = 0; i < size;) {
+    const uint8_t c = data[i];
+    if (c == 0)
+      return false;
+
+    if (c < 0x80) {
+      ++i;
+      continue;
+    }
+
+    // length of the sequence and the valid range of its second byte
+    size_t length;
+    uint8_t min = 0x80, max = 0xBF;
+    if (c >= 0xC2 && c <= 0xDF) {
+      length = 2;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+      length = 3;
+      if (c == 0xE0)
+        min = 0xA0; // overlong
+      else if (c == 0xED)
+        max = 0x9F; // surrogates
+    } else if (c >= 0xF0 && c <= 0xF4) {
+      length = 4;
+      if (c == 0xF0)
+        min = 0x90; // overlong
+      else if (c == 0xF4)
+        max = 0x8F; // above U+10FFFF
+    } else {
+      return false;
+    }
+
+    for (size_t k = 1; k < length; ++k) {
+      if (i + k == size)
+        return partial;
+
+      const uint8_t d = data[i + k];
+      if (d < (k == 1 ? min : 0x80) || d > (k == 1 ? max : 0xBF))
+        return false;
+    }
+
+    i += length;
+  }
+
+  return true;
+}
@@ -0,0 +1,457 @@
+#include "pfederc/instrumentation.hpp"
+#include "pfederc/json.hpp"
+#include <new>
+#if defined(PFEDERC_INSTRUMENTATION) && defined(__GLIBC__)
+#include <malloc.h>
+#define PFEDERC_INSTRUMENTATION_MEMORY
+#endif
+using namespace pfederc;
+
+const char *pfederc::phaseToString(Phase phase) noexcept {
+  switch (phase) {
+  case Phase::LEX:
+    return "lex";
+  case Phase::PARSE:
+    return "parse";
+  case Phase::OPTIMIZE:
+    return "optimize";
+  case Phase::SEMANTIC:
+    return "semantic";
+  default:
+    assert(false && "Unknown phase");
+    return "";
+  }
+}
+
+const char *pfederc::counterToString(Counter counter) noexcept {
+  switch (counter) {
+  case Counter::TOKENS:
+    return "tokens";
+  case Counter::EXPRESSIONS:
+    return "expressions";
+  case Counter::SYMBOLS:
+    return "symbols";
+  case Counter::REWRITES:
+    return "rewrites";
+  default:
+    assert(false && "Unknown counter");
+    return "";
+  }
+}
+
+// InstrumentationReport
+InstrumentationReport::InstrumentationReport() noexcept
+    : phases{}, counters{} {
+}
+
+InstrumentationReport::~InstrumentationReport() {
+}
+
+inline static double _toMilliseconds(std::chrono::nanoseconds duration) noexcept {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void InstrumentationReport::printText(std::ostream &out) const noexcept {
+  for (size_t i = 0; i < PHASE_COUNT; ++i) {
+    const PhaseMeasurement &phase = phases[i];
+    out << "phase " << phaseToString(static_cast<Phase>(i)) << ": "
+        << _toMilliseconds(phase.duration) << " ms, "
+        << phase.entries << " entries, "
+        << phase.allocations << " allocations, "
+        << phase.peakBytes << " peak bytes" << std::endl;
+  }
+
+  for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+    out << "counter " << counterToString(static_cast<Counter>(i))
+        << ": " << counters[i] << std::endl;
+  }
+}
+
+void InstrumentationReport::printJson(std::ostream &out) const noexcept {
+  std::string json;
+  JsonWriter writer(json);
+  writer.beginObject().key("phases").beginObject();
+  for (size_t i = 0; i < PHASE_COUNT; ++i) {
+    const PhaseMeasurement &phase = phases[i];
+    writer.key(phaseToString(static_cast<Phase>(i))).beginObject()
+      .member("ms", _toMilliseconds(phase.duration))
+      .member("entries", phase.entries)
+      .member("allocations", phase.allocations)
+      .member("peakBytes", phase.peakBytes)
+      .endObject();
+  }
+
+  writer.endObject().key("counters").beginObject();
+  for (size_t i = 0; i < COUNTER_COUNT; ++i)
+    writer.member(counterToString(static_cast<Counter>(i)), counters[i]);
+
+  writer.endObject().endObject();
+  out << json << std::endl;
+}
+
+#ifdef PFEDERC_INSTRUMENTATION
+static std::atomic<bool> _enabled{false};
+static std::atomic<bool> _tracing{false};
+//! Steady clock time of the first setTracing(true) in nanoseconds
+static std::atomic<int64_t> _traceOrigin{0};
+
+// Allocation counters of the calling thread. Constant-initialized, because
+// they are accessed by the allocation functions (also while a thread starts
+// or exits).
+static thread_local int64_t _allocatedBytes = 0;
+static thread_local int64_t _peakBytes = 0;
+static thread_local uint64_t _allocations = 0;
+
+// Innermost phase of the calling thread and when it was last charged
+static thread_local Phase _currentPhase = Phase::NONE;
+static thread_local int64_t _lastCharge = 0;
+static thread_local uint64_t _lastAllocations = 0;
+
+//! Span recorded by ScopedSpan
+struct _TraceEvent {
+  const char *category;
+  std::string name;
+  std::string file;
+  int64_t start;
+  int64_t duration;
+  uint64_t thread;
+};
+
+/*!\brief Measurements of a single thread
+ *
+ * Only written by its thread, but read by collect: values are relaxed
+ * atomics updated by load and store.
+ */
+struct _ThreadMeasurements final {
+  //! Sequential number of the thread, used as trace thread id
+  uint64_t thread;
+  //! Guards events (written by this thread, read by writeTrace)
+  std::mutex mtxEvents;
+  std::vector<_TraceEvent> events;
+
+  std::array<std::atomic<int64_t>, PHASE_COUNT> durations;
+  std::array<std::atomic<uint64_t>, PHASE_COUNT> entries;
+  std::array<std::atomic<uint64_t>, PHASE_COUNT> allocations;
+  std::array<std::atomic<uint64_t>, PHASE_COUNT> peakBytes;
+  std::array<std::atomic<uint64_t>, COUNTER_COUNT> counters;
+
+  _ThreadMeasurements() noexcept;
+  _ThreadMeasurements(const _ThreadMeasurements &) = delete;
+  ~_ThreadMeasurements();
+
+  void addTo(InstrumentationReport &report) const noexcept;
+  void clear() noexcept;
+};
+
+//! Measurements of running threads and sum of finished threads
+struct _Registry final {
+  std::mutex mtx;
+  std::unordered_set<_ThreadMeasurements*> threads;
+  InstrumentationReport finished;
+  std::vector<_TraceEvent> finishedEvents;
+  uint64_t nextThread = 0;
+};
+
+static _Registry &_registry() noexcept {
+  static _Registry registry;
+  return registry;
+}
+
+template<class T>
+inline static void _add(std::atomic<T> &value, T n) noexcept {
+  value.store(value.load(std::memory_order_relaxed) + n,
+      std::memory_order_relaxed);
+}
+
+template<class T>
+inline static void _max(std::atomic<T> &value, T n) noexcept {
+  if (value.load(std::memory_order_relaxed) < n)
+    value.store(n, std::memory_order_relaxed);
+}
+
+_ThreadMeasurements::_ThreadMeasurements() noexcept {
+  clear();
+  _Registry &registry = _registry();
+  std::lock_guard<std::mutex> lck(registry.mtx);
+  thread = registry.nextThread++;
+  registry.threads.insert(this);
+}
+
+_ThreadMeasurements::~_ThreadMeasurements() {
+  _Registry &registry = _registry();
+  std::lock_guard<std::mutex> lck(registry.mtx);
+  registry.threads.erase(this);
+  addTo(registry.finished);
+  std::move(events.begin(), events.end(),
+      std::back_inserter(registry.finishedEvents));
+}
+
+void _ThreadMeasurements::addTo(InstrumentationReport &report) const noexcept {
+  for (size_t i = 0; i < PHASE_COUNT; ++i) {
+    PhaseMeasurement &phase = report.getPhase(static_cast<Phase>(i));
+    phase.duration += std::chrono::nanoseconds(
+        durations[i].load(std::memory_order_relaxed));
+    phase.entries += entries[i].load(std::memory_order_relaxed);
+    phase.allocations += allocations[i].load(std::memory_order_relaxed);
+    phase.peakBytes = std::max<uint64_t>(phase.peakBytes,
+        peakBytes[i].load(std::memory_order_relaxed));
+  }
+
+  for (size_t i = 0; i < COUNTER_COUNT; ++i)
+    report.getCounter(static_cast<Counter>(i)) +=
+      counters[i].load(std::memory_order_relaxed);
+}
+
+void _ThreadMeasurements::clear() noexcept {
+  for (size_t i = 0; i < PHASE_COUNT; ++i) {
+    durations[i].store(0, std::memory_order_relaxed);
+    entries[i].store(0, std::memory_order_relaxed);
+    allocations[i].store(0, std::memory_order_relaxed);
+    peakBytes[i].store(0, std::memory_order_relaxed);
+  }
+
+  for (std::atomic<uint64_t> &counter : counters)
+    counter.store(0, std::memory_order_relaxed);
+}
+
+static _ThreadMeasurements &_measurements() noexcept {
+  static thread_local _ThreadMeasurements measurements;
+  return measurements;
+}
+
+inline static int64_t _now() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//! Adds time and allocations since the last charge to the current phase
+static void _charge(int64_t now) noexcept {
+  if (_currentPhase != Phase::NONE) {
+    _ThreadMeasurements &measurements = _measurements();
+    const size_t phase = static_cast<size_t>(_currentPhase);
+    _add(measurements.durations[phase], now - _lastCharge);
+    _add(measurements.allocations[phase], _allocations - _lastAllocations);
+  }
+
+  _lastCharge = now;
+  _lastAllocations = _allocations;
+}
+
+void instrumentation::setEnabled(bool enabled) noexcept {
+  _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool instrumentation::isEnabled() noexcept {
+  return _enabled.load(std::memory_order_relaxed);
+}
+
+void instrumentation::count(Counter counter, uint64_t n) noexcept {
+  if (isEnabled())
+    _add(_measurements().counters[static_cast<size_t>(counter)], n);
+}
+
+Phase instrumentation::getCurrentPhase() noexcept {
+  return _currentPhase;
+}
+
+InstrumentationReport instrumentation::collect() noexcept {
+  _Registry &registry = _registry();
+  std::lock_guard<std::mutex> lck(registry.mtx);
+  InstrumentationReport report(registry.finished);
+  for (const _ThreadMeasurements *measurements : registry.threads)
+    measurements->addTo(report);
+
+  return report;
+}
+
+void instrumentation::reset() noexcept {
+  _Registry &registry = _registry();
+  std::lock_guard<std::mutex> lck(registry.mtx);
+  registry.finished = InstrumentationReport();
+  registry.finishedEvents.clear();
+  for (_ThreadMeasurements *measurements : registry.threads) {
+    measurements->clear();
+    std::lock_guard<std::mutex> lckEvents(measurements->mtxEvents);
+    measurements->events.clear();
+  }
+}
+
+void instrumentation::setTracing(bool tracing) noexcept {
+  int64_t origin = 0;
+  if (tracing)
+    _traceOrigin.compare_exchange_strong(origin, _now());
+
+  _tracing.store(tracing, std::memory_order_relaxed);
+}
+
+bool instrumentation::isTracing() noexcept {
+  return _tracing.load(std::memory_order_relaxed);
+}
+
+static void _writeTraceEvent(JsonWriter &writer,
+    const _TraceEvent &event) noexcept {
+  const int64_t origin = _traceOrigin.load(std::memory_order_relaxed);
+  writer.beginObject()
+    .member("name", event.name)
+    .member("cat", event.category)
+    .member("ph", "X")
+    .member("ts", (event.start - origin) / 1000.0)
+    .member("dur", event.duration / 1000.0)
+    .member("pid", uint64_t(1))
+    .member("tid", event.thread);
+  if (!event.file.empty())
+    writer.key("args").beginObject().member("file", event.file).endObject();
+
+  writer.endObject();
+}
+
+void instrumentation::writeTrace(std::ostream &out) noexcept {
+  std::string json;
+  JsonWriter writer(json);
+  writer.beginObject().member("displayTimeUnit", "ms")
+    .key("traceEvents").beginArray();
+
+  _Registry &registry = _registry();
+  std::lock_guard<std::mutex> lck(registry.mtx);
+  for (uint64_t thread = 0; thread < registry.nextThread; ++thread) {
+    writer.beginObject()
+      .member("name", "thread_name")
+      .member("ph", "M")
+      .member("pid", uint64_t(1))
+      .member("tid", thread)
+      .key("args").beginObject()
+        .member("name", "thread " + std::to_string(thread))
+      .endObject()
+      .endObject();
+  }
+
+  for (const _TraceEvent &event : registry.finishedEvents)
+    _writeTraceEvent(writer, event);
+
+  for (_ThreadMeasurements *measurements : registry.threads) {
+    std::lock_guard<std::mutex> lckEvents(measurements->mtxEvents);
+    for (const _TraceEvent &event : measurements->events)
+      _writeTraceEvent(writer, event);
+  }
+
+  writer.endArray().endObject();
+  out << json << std::endl;
+}
+
+// ScopedPhase
+ScopedPhase::ScopedPhase(Phase phase) noexcept
+    : phase{Phase::NONE}, parent{_currentPhase},
+      baseBytes{_allocatedBytes}, parentPeakBytes{_peakBytes} {
+  if (phase == Phase::NONE || !instrumentation::isEnabled())
+    return;
+
+  _charge(_now());
+  this->phase = phase;
+  _currentPhase = phase;
+  _peakBytes = _allocatedBytes;
+}
+
+ScopedPhase::~ScopedPhase() {
+  if (phase == Phase::NONE)
+    return;
+
+  _charge(_now());
+  _currentPhase = parent;
+
+  _ThreadMeasurements &measurements = _measurements();
+  const size_t index = static_cast<size_t>(phase);
+  _add<uint64_t>(measurements.entries[index], 1);
+  _max<uint64_t>(measurements.peakBytes[index], _peakBytes - baseBytes);
+  _peakBytes = std::max(parentPeakBytes, _peakBytes);
+}
+
+// ScopedSpan
+ScopedSpan::ScopedSpan(const char *category, std::string_view name,
+    std::string_view file) noexcept
+    : category{category}, start{-1} {
+  if (!instrumentation::isTracing())
+    return;
+
+  this->name = name;
+  this->file = file;
+  start = _now();
+}
+
+ScopedSpan::~ScopedSpan() {
+  if (start < 0)
+    return;
+
+  const int64_t end = _now();
+  _ThreadMeasurements &measurements = _measurements();
+  std::lock_guard<std::mutex> lck(measurements.mtxEvents);
+  measurements.events.push_back(_TraceEvent{category, std::move(name),
+      std::move(file), start, end - start, measurements.thread});
+}
+#endif /* PFEDERC_INSTRUMENTATION */
+
+#ifdef PFEDERC_INSTRUMENTATION_MEMORY
+// Replaced global allocation functions. All unaligned variants are
+// replaced, because sanitizer runtimes don't forward them to each other.
+// Aligned allocations aren't tracked.
+inline static void *_allocate(size_t size) noexcept {
+  void *ptr = std::malloc(size ? size : 1);
+  if (ptr && _enabled.load(std::memory_order_relaxed)) {
+    _allocatedBytes += malloc_usable_size(ptr);
+    _allocations++;
+    _peakBytes = std::max(_peakBytes, _allocatedBytes);
+  }
+
+  return ptr;
+}
+
+inline static void _deallocate(void *ptr) noexcept {
+  if (ptr && _enabled.load(std::memory_order_relaxed))
+    _allocatedBytes -= malloc_usable_size(ptr);
+
+  std::free(ptr);
+}
+
+void *operator new(size_t size) {
+  void *ptr = _allocate(size);
+  if (!ptr)
+    throw std::bad_alloc();
+
+  return ptr;
+}
+
+void *operator new[](size_t size) {
+  return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  return _allocate(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  return _allocate(size);
+}
+
+void operator delete(void *ptr) noexcept {
+  _deallocate(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+  _deallocate(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+  _deallocate(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+  _deallocate(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+  _deallocate(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+  _deallocate(ptr);
+}
+#endif /* PFEDERC_INSTRUMENTATION_MEMORY */
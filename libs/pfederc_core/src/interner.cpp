@@ -0,0 +1,88 @@
+#include "pfederc/interner.hpp"
+using namespace pfederc;
+
+// StringInterner
+StringInterner::StringInterner() noexcept
+    : next{1} {
+  for (auto &chunk : chunks)
+    chunk = nullptr;
+
+  // INTERNED_NONE
+  store(INTERNED_NONE);
+}
+
+StringInterner::~StringInterner() {
+  for (auto &chunk : chunks)
+    delete[] chunk.load();
+}
+
+//! Sets chunk and index of string with id in chunk
+inline static void _chunkPosition(InternedId id,
+    size_t &chunk, size_t &index) noexcept {
+  const uint64_t pos = static_cast<uint64_t>(id) + INTERNER_CHUNK0;
+  chunk = 0;
+  while ((pos >> (chunk + 1)) >= INTERNER_CHUNK0)
+    ++chunk;
+
+  index = pos - (static_cast<uint64_t>(INTERNER_CHUNK0) << chunk);
+}
+
+std::string &StringInterner::store(InternedId id) noexcept {
+  size_t chunk, index;
+  _chunkPosition(id, chunk, index);
+  std::string *strs = chunks[chunk].load(std::memory_order_acquire);
+  if (!strs) {
+    std::lock_guard<std::mutex> guard(mtxChunks);
+    strs = chunks[chunk].load(std::memory_order_acquire);
+    if (!strs) {
+      strs = new std::string[INTERNER_CHUNK0 << chunk];
+      chunks[chunk].store(strs, std::memory_order_release);
+    }
+  }
+
+  return strs[index];
+}
+
+InternedId StringInterner::intern(std::string_view str) noexcept {
+  Shard &shard = shards[std::hash<std::string_view>{}(str) % INTERNER_SHARDS];
+  {
+    std::shared_lock<std::shared_mutex> guard(shard.mtx);
+    auto it = shard.ids.find(str);
+    if (it != shard.ids.end())
+      return it->second;
+  }
+
+  std::unique_lock<std::shared_mutex> guard(shard.mtx);
+  // str might have been added after releasing the shared lock
+  auto it = shard.ids.find(str);
+  if (it != shard.ids.end())
+    return it->second;
+
+  const InternedId id = next++;
+  assert(id != INTERNED_NONE);
+
+  std::string &stored = store(id);
+  stored = str;
+  shard.ids.emplace(std::string_view(stored), id);
+
+  return id;
+}
+
+InternedId StringInterner::find(std::string_view str) const noexcept {
+  const Shard &shard =
+    shards[std::hash<std::string_view>{}(str) % INTERNER_SHARDS];
+  std::shared_lock<std::shared_mutex> guard(shard.mtx);
+  auto it = shard.ids.find(str);
+  return it != shard.ids.end() ? it->second : INTERNED_NONE;
+}
+
+const std::string &StringInterner::get(InternedId id) const noexcept {
+  size_t chunk, index;
+  _chunkPosition(id, chunk, index);
+  return chunks[chunk].load(std::memory_order_acquire)[index];
+}
+
+StringInterner &pfederc::getStringInterner() noexcept {
+  static StringInterner interner;
+  return interner;
+}
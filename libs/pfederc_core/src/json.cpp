@@ -0,0 +1,128 @@
+#include "pfederc/json.hpp"
+#include <cmath>
+#include <cstdio>
+using namespace pfederc;
+
+void pfederc::appendJsonString(std::string &out, std::string_view str) noexcept {
+  constexpr char HEX[] = "0123456789abcdef";
+  out += '"';
+  for (const char c : str) {
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      if (static_cast<uint8_t>(c) < 0x20) {
+        out += "\\u00";
+        out += HEX[c >> 4];
+        out += HEX[c & 0xf];
+      } else {
+        out += c;
+      }
+      break;
+    }
+  }
+  out += '"';
+}
+
+// JsonWriter
+JsonWriter::JsonWriter(std::string &out) noexcept
+    : out{out}, empty(), afterKey{false} {
+}
+
+JsonWriter::~JsonWriter() {
+}
+
+void JsonWriter::separate() noexcept {
+  if (afterKey) {
+    afterKey = false;
+    return;
+  }
+
+  if (!empty.empty()) {
+    if (!empty.back())
+      out += ',';
+
+    empty.back() = false;
+  }
+}
+
+JsonWriter &JsonWriter::beginObject() noexcept {
+  separate();
+  out += '{';
+  empty.push_back(true);
+  return *this;
+}
+
+JsonWriter &JsonWriter::endObject() noexcept {
+  assert(!empty.empty());
+  out += '}';
+  empty.pop_back();
+  return *this;
+}
+
+JsonWriter &JsonWriter::beginArray() noexcept {
+  separate();
+  out += '[';
+  empty.push_back(true);
+  return *this;
+}
+
+JsonWriter &JsonWriter::endArray() noexcept {
+  assert(!empty.empty());
+  out += ']';
+  empty.pop_back();
+  return *this;
+}
+
+JsonWriter &JsonWriter::key(std::string_view name) noexcept {
+  separate();
+  appendJsonString(out, name);
+  out += ':';
+  afterKey = true;
+  return *this;
+}
+
+JsonWriter &JsonWriter::value(std::string_view str) noexcept {
+  separate();
+  appendJsonString(out, str);
+  return *this;
+}
+
+JsonWriter &JsonWriter::value(uint64_t num) noexcept {
+  separate();
+  out += std::to_string(num);
+  return *this;
+}
+
+JsonWriter &JsonWriter::value(double num) noexcept {
+  separate();
+  // JSON has no representation of nan and infinity
+  if (!std::isfinite(num)) {
+    out += "null";
+    return *this;
+  }
+
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%.17g", num);
+  out += buf;
+  return *this;
+}
+
+JsonWriter &JsonWriter::value(bool b) noexcept {
+  separate();
+  out += b ? "true" : "false";
+  return *this;
+}
@@ -0,0 +1,216 @@
+#include "pfederc/scheduler.hpp"
+using namespace pfederc;
+
+//! Worker state of the current thread
+struct _WorkerState {
+  TaskScheduler *scheduler;
+  size_t worker;
+  std::string key; //!< set by suspend
+};
+
+static thread_local _WorkerState _currentWorker{nullptr, 0, ""};
+
+TaskScheduler::TaskScheduler(size_t threads) noexcept
+    : queued{0}, running{0}, stalled{false}, epoch{0}, finished{false},
+      generation{0}, active{0}, stopping{false}, phase{Phase::NONE} {
+  for (size_t i = 0; i < std::max<size_t>(threads, 1); ++i)
+    workers.push_back(std::make_unique<Worker>());
+}
+
+TaskScheduler::~TaskScheduler() {
+  {
+    std::lock_guard<std::mutex> guard(mtxRun);
+    stopping = true;
+  }
+
+  cvRun.notify_all();
+  for (std::thread &thread : threads)
+    thread.join();
+}
+
+void TaskScheduler::push(size_t worker, TaskFunction &&task) noexcept {
+  Worker &w = *workers[worker];
+  std::lock_guard<std::mutex> guard(w.mtx);
+  w.tasks.push_back(std::move(task));
+  ++queued;
+}
+
+bool TaskScheduler::pop(size_t worker, TaskFunction &task) noexcept {
+  {
+    // newest task of own deque
+    Worker &w = *workers[worker];
+    std::lock_guard<std::mutex> guard(w.mtx);
+    if (!w.tasks.empty()) {
+      task = std::move(w.tasks.back());
+      w.tasks.pop_back();
+      --queued;
+      return true;
+    }
+  }
+
+  // steal oldest task of other workers
+  for (size_t i = 1; i < workers.size(); ++i) {
+    Worker &w = *workers[(worker + i) % workers.size()];
+    std::lock_guard<std::mutex> guard(w.mtx);
+    if (!w.tasks.empty()) {
+      task = std::move(w.tasks.front());
+      w.tasks.pop_front();
+      --queued;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void TaskScheduler::park(std::string &&key, uint64_t start,
+    TaskFunction &&task) noexcept {
+  {
+    std::lock_guard<std::mutex> guard(mtxState);
+    auto it = notified.find(key);
+    if (it == notified.end() || it->second <= start) {
+      waiting[std::move(key)].push_back(std::move(task));
+      return;
+    }
+  }
+
+  // notify was called, while task was running (the task might have missed
+  // the change)
+  push(_currentWorker.worker, std::move(task));
+  cvState.notify_one();
+}
+
+void TaskScheduler::work(size_t worker) noexcept {
+  _currentWorker = _WorkerState{this, worker, ""};
+
+  while (true) {
+    // incremented before pop, so idle workers cannot miss a popped task
+    ++running;
+    TaskFunction task;
+    if (pop(worker, task)) {
+      _currentWorker.key.clear();
+      const uint64_t start = epoch;
+      if (task(*this) == TaskStatus::SUSPENDED)
+        park(std::move(_currentWorker.key), start, std::move(task));
+
+      --running;
+      continue;
+    }
+
+    --running;
+
+    std::unique_lock<std::mutex> lock(mtxState);
+    if (finished)
+      break;
+
+    if (queued == 0 && running == 0) {
+      if (waiting.empty()) {
+        finished = true;
+        cvState.notify_all();
+        break;
+      }
+
+      // nothing can run anymore: resume all suspended tasks
+      stalled = true;
+      auto tasks = std::move(waiting);
+      waiting.clear();
+      for (auto &entry : tasks) {
+        for (TaskFunction &suspended : entry.second)
+          push(worker, std::move(suspended));
+      }
+
+      cvState.notify_all();
+      continue;
+    }
+
+    if (queued == 0)
+      cvState.wait(lock);
+  }
+
+  _currentWorker = _WorkerState{nullptr, 0, ""};
+}
+
+void TaskScheduler::spawn(TaskFunction &&task) noexcept {
+  push(_currentWorker.scheduler == this ? _currentWorker.worker : 0,
+      std::move(task));
+
+  // synchronizes with idle workers checking queued
+  { std::lock_guard<std::mutex> guard(mtxState); }
+  cvState.notify_one();
+}
+
+void TaskScheduler::suspend(const std::string &key) noexcept {
+  assert(_currentWorker.scheduler == this);
+  _currentWorker.key = key;
+}
+
+void TaskScheduler::notify(const std::string &key) noexcept {
+  std::vector<TaskFunction> tasks;
+  {
+    std::lock_guard<std::mutex> guard(mtxState);
+    notified[key] = ++epoch;
+    auto it = waiting.find(key);
+    if (it == waiting.end())
+      return;
+
+    tasks = std::move(it->second);
+    waiting.erase(it);
+  }
+
+  const size_t worker = _currentWorker.scheduler == this ?
+    _currentWorker.worker : 0;
+  for (TaskFunction &task : tasks)
+    push(worker, std::move(task));
+
+  { std::lock_guard<std::mutex> guard(mtxState); }
+  cvState.notify_all();
+}
+
+void TaskScheduler::serve(size_t worker) noexcept {
+  uint64_t served = 0;
+  while (true) {
+    std::unique_lock<std::mutex> lock(mtxRun);
+    cvRun.wait(lock, [this, served]() {
+        return stopping || generation != served;
+      });
+    if (stopping)
+      break;
+
+    served = generation;
+    lock.unlock();
+
+    {
+      // workers continue the phase of the thread calling run
+      ScopedPhase scope(phase);
+      work(worker);
+    }
+
+    lock.lock();
+    if (--active == 0)
+      cvRun.notify_all();
+  }
+}
+
+void TaskScheduler::run() noexcept {
+  finished = false;
+  stalled = false;
+  phase = instrumentation::getCurrentPhase();
+
+  {
+    std::lock_guard<std::mutex> guard(mtxRun);
+    if (threads.empty()) {
+      for (size_t i = 1; i < workers.size(); ++i)
+        threads.emplace_back([this, i]() { serve(i); });
+    }
+
+    active = workers.size() - 1;
+    generation++;
+  }
+
+  cvRun.notify_all();
+  work(0);
+
+  // tasks and state of this run mustn't be touched by the next run
+  std::unique_lock<std::mutex> lock(mtxRun);
+  cvRun.wait(lock, [this]() { return active == 0; });
+}
@@ -7,6 +7,28 @@ namespace pfederc {
   class BaseLogger;
   class Logger;
   class LogMessage;
+  struct DiagnosticBuffer;
+  struct DiagnosticRecord;
+
+  /*!\brief Creates the message of a diagnostic, called only if the
+   * diagnostic isn't filtered
+   */
+  typedef std::function<LogMessage()> DiagnosticRenderer;
+  /*!\brief Creates the structured diagnostic for machine-readable formats,
+   * called only if the diagnostic isn't filtered
+   */
+  typedef std::function<DiagnosticRecord()> DiagnosticDescriber;
+
+  /*!\brief Output format of reported diagnostics
+   */
+  enum class DiagnosticFormat {
+    //! Human-readable messages with source excerpts
+    TEXT,
+    //! One JSON object per diagnostic and line
+    JSON_LINES,
+    //! One SARIF 2.1.0 log, completed by ~Logger
+    SARIF,
+  };
 
   enum Level : uint16_t {
     /*!\brief Code Warning
@@ -37,28 +59,84 @@ namespace pfederc {
       | LVL_NOTE | LVL_HELP | LVL_FATAL | LVL_FAILURE);
 
   /*!\brief Wrapping output streams
+   *
+   * Lines are collected and written at once, when the other stream is
+   * written or flush is called.
    */
   class BaseLogger {
     std::ostream &out, &err;
+    //! Stream of pending, nullptr if nothing is pending
+    std::ostream *pendingStream;
+    std::string pending;
+
+    void write(std::ostream &stream, const std::string &msg) noexcept;
   public:
     BaseLogger(std::ostream &out = std::cout, std::ostream &err = std::cerr) noexcept;
+    //! Copies the streams, not the pending lines
     BaseLogger(const BaseLogger &log) noexcept;
     virtual ~BaseLogger();
 
     void info(const std::string &msg) noexcept;
     void error(const std::string &msg) noexcept;
+
+    /*!\brief Writes pending lines and flushes the stream
+     */
+    void flush() noexcept;
   };
 
   /*!\brief Logger with filtering
+   *
+   * Diagnostics are reported with report, which is thread-safe. In buffered
+   * mode, diagnostics are collected per thread and written ordered by file
+   * and position by flush (or if the flush limit is reached). In unbuffered
+   * mode (interactive use), diagnostics are written immediately.
    */
   class Logger {
     Level allowedLevels;
     BaseLogger baseLog;
+    bool buffered;
+    DiagnosticFormat format;
+    //! Number of diagnostics written in a machine-readable format
+    size_t records;
+    //! Identifies the logger in thread-local caches
+    uint64_t id;
+    size_t flushLimit;
+    std::atomic<size_t> bufferedCount;
+    std::atomic<uint64_t> sequence;
+    //! Guards buffers and writes of reported diagnostics
+    std::mutex mtx;
+    std::unordered_map<std::thread::id, std::unique_ptr<DiagnosticBuffer>>
+      buffers;
+
+    DiagnosticBuffer &getBuffer() noexcept;
+    //! Writes a diagnostic in format, mtx must be locked
+    void write(const std::string &file, const DiagnosticRenderer &render,
+        const DiagnosticDescriber &describe) noexcept;
   public:
+    /*!\brief Initializes Logger
+     * \param allowedLevels
+     * \param baseLog
+     * \param buffered If true, reported diagnostics are written by flush
+     * \param format Output format of reported diagnostics, machine-readable
+     * formats are written to the output stream
+     */
     Logger(Level allowedLevels = LVL_ALL,
-        const BaseLogger &baseLog = BaseLogger()) noexcept;
+        const BaseLogger &baseLog = BaseLogger(),
+        bool buffered = false,
+        DiagnosticFormat format = DiagnosticFormat::TEXT) noexcept;
+    Logger(const Logger &) = delete;
+    //! Flushes diagnostics
     virtual ~Logger();
 
+    inline bool isBuffered() const noexcept { return buffered; }
+    inline DiagnosticFormat getFormat() const noexcept { return format; }
+
+    /*!\brief Diagnostics are flushed by the reporting thread, if limit
+     * diagnostics are buffered
+     * \param limit 0 (default) disables the limit
+     */
+    inline void setFlushLimit(size_t limit) noexcept { flushLimit = limit; }
+
     /*!\return Returns true if logLevels are not filtered by Logger, otherwise
      * false.
      * \param logLevels Log levels to check
@@ -70,8 +148,43 @@ namespace pfederc {
      * Message is filtered if accept(logLevel) returns false.
      *
      * \return Returns true if message wasn't filtered, otherwise false.
+     *
+     * This function isn't synchronized and doesn't flush.
      */
     bool log(Level logLevel, const std::string &msg) noexcept;
+
+    /*!\brief Reports a diagnostic
+     * \param file File path used for ordering
+     * \param index Position in file used for ordering
+     * \param logLevel Level of the rendered message
+     * \param render Called by report (unbuffered) or flush (buffered), if
+     * logLevel is accepted and the format is TEXT. Referenced data must stay
+     * valid until then.
+     * \param describe Like render, used by machine-readable formats. If
+     * empty, the record is created from the rendered message.
+     *
+     * This function is thread-safe.
+     */
+    void report(const std::string &file, size_t index, Level logLevel,
+        DiagnosticRenderer &&render,
+        DiagnosticDescriber &&describe = nullptr) noexcept;
+
+    /*!\brief Reports a rendered diagnostic
+     * \param file File path used for ordering
+     * \param index Position in file used for ordering
+     * \param msg
+     *
+     * This function is thread-safe.
+     */
+    void report(const std::string &file, size_t index,
+        LogMessage &&msg) noexcept;
+
+    /*!\brief Writes buffered diagnostics ordered by file and position (in
+     * one write per stream) and flushes the streams
+     *
+     * This function is thread-safe.
+     */
+    void flush() noexcept;
   };
 
   /*!\brief Log message with optional attached messages
@@ -81,9 +194,10 @@ namespace pfederc {
     std::string msg;
     std::vector<LogMessage> msgs;
   public:
-    LogMessage(Level logLevel, const std::string &msg,
-               const std::vector<LogMessage> &msgs = {}) noexcept;
+    LogMessage(Level logLevel, std::string msg,
+               std::vector<LogMessage> msgs = {}) noexcept;
     LogMessage(const LogMessage &msg) noexcept;
+    LogMessage(LogMessage &&msg) noexcept;
     virtual ~LogMessage();
 
     Level getLogLevel() const noexcept;
@@ -101,6 +215,86 @@ namespace pfederc {
     void log(Logger &log) const noexcept;
   };
 
+  /*!\brief Structured diagnostic written by machine-readable formats
+   */
+  struct DiagnosticRecord final {
+    Level logLevel;
+    //! Error code, e.g. LEX0007
+    std::string code;
+    std::string file;
+    //! Starting at 1, 0 if unknown
+    size_t line, column;
+    //! Byte range (inclusive) in file
+    size_t startIndex, endIndex;
+    //! Message without location and source excerpt
+    std::string msg;
+    //! Attached messages (e.g. fix-it notes)
+    std::vector<LogMessage> msgs;
+  };
+
+  /*!\brief Reported diagnostic, rendered when it's written
+   */
+  struct Diagnostic final {
+    std::string file;
+    size_t index;
+    //! Report order, orders diagnostics with the same position
+    uint64_t sequence;
+    DiagnosticRenderer render;
+    DiagnosticDescriber describe;
+  };
+
+  //! Diagnostics reported by one thread
+  struct DiagnosticBuffer final {
+    std::mutex mtx;
+    std::vector<Diagnostic> diagnostics;
+  };
+
+  /*!\brief Maximum number of errors, shared by lexer, parser and semantic
+   * analysis. Work stops, after the limit is reached.
+   */
+  class ErrorLimit final {
+    size_t limit;
+    std::atomic<size_t> count;
+  public:
+    /*!\brief Initializes ErrorLimit
+     * \param limit 0 disables the limit
+     */
+    ErrorLimit(size_t limit = 0) noexcept;
+    ErrorLimit(const ErrorLimit &) = delete;
+    ~ErrorLimit();
+
+    inline size_t getLimit() const noexcept { return limit; }
+
+    /*!\return Returns number of counted errors (at most the limit)
+     */
+    size_t getCount() const noexcept;
+
+    /*!\brief Counts an error
+     * \return Returns true, if the error is within the limit and should be
+     * stored, otherwise false.
+     *
+     * This function is thread-safe.
+     */
+    bool add() noexcept;
+
+    /*!\return Returns true, if the limit is reached and work should stop
+     */
+    inline bool isReached() const noexcept
+    { return limit != 0 && count.load(std::memory_order_relaxed) >= limit; }
+  };
+
+  /*!\brief Reports a summary, if limit is reached
+   * \return Returns true, if limit is reached, otherwise false.
+   */
+  bool logErrorLimit(Logger &log, const ErrorLimit &limit) noexcept;
+
+  /*!\return Returns error code prefix followed by code with at least 4
+   * digits (e.g. LEX0007)
+   * \param prefix
+   * \param code
+   */
+  std::string formatDiagnosticCode(const char *prefix, size_t code) noexcept;
+
   void fatal(const char *file, int line, const std::string &msg) noexcept;
 }
 
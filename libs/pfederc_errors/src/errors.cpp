@@ -1,23 +1,65 @@
 #include "pfederc/errors.hpp"
+#include "pfederc/json.hpp"
 using namespace pfederc;
 
+std::string pfederc::formatDiagnosticCode(const char *prefix,
+    size_t code) noexcept {
+  std::string digits = std::to_string(code);
+  if (digits.length() < 4)
+    digits.insert(0, 4 - digits.length(), '0');
+
+  return prefix + digits;
+}
+
 void pfederc::fatal(const char *file,
     int line, const std::string &msg) noexcept {
   std::cerr << file << ':' << line << ": " << msg << std::endl;
   std::exit(1);
 }
 
+// ErrorLimit
+ErrorLimit::ErrorLimit(size_t limit) noexcept
+    : limit{limit}, count{0} {
+}
+
+ErrorLimit::~ErrorLimit() {
+}
+
+size_t ErrorLimit::getCount() const noexcept {
+  const size_t result = count.load(std::memory_order_relaxed);
+  return limit != 0 ? std::min(result, limit) : result;
+}
+
+bool ErrorLimit::add() noexcept {
+  return count.fetch_add(1, std::memory_order_relaxed) < limit || limit == 0;
+}
+
+bool pfederc::logErrorLimit(Logger &log, const ErrorLimit &limit) noexcept {
+  if (!limit.isReached())
+    return false;
+
+  log.report("", 0, LogMessage(LVL_FATAL, "Too many errors, stopped after "
+        + std::to_string(limit.getLimit()) + " errors (-ferror-limit="
+        + std::to_string(limit.getLimit()) + ")"));
+  return true;
+}
+
 // LogMessage
 
 LogMessage::LogMessage(Level logLevel,
-    const std::string &msg, const std::vector<LogMessage> &msgs) noexcept
-    : logLevel{logLevel}, msg(msg), msgs(msgs) {
+    std::string msg, std::vector<LogMessage> msgs) noexcept
+    : logLevel{logLevel}, msg(std::move(msg)), msgs(std::move(msgs)) {
 }
 
 LogMessage::LogMessage(const LogMessage &msg) noexcept
     : logLevel{msg.logLevel}, msg(msg.msg), msgs(msg.msgs) {
 }
 
+LogMessage::LogMessage(LogMessage &&msg) noexcept
+    : logLevel{msg.logLevel}, msg(std::move(msg.msg)),
+      msgs(std::move(msg.msgs)) {
+}
+
 LogMessage::~LogMessage() {
 }
 
@@ -45,31 +87,92 @@ void LogMessage::log(Logger &log) const noexcept {
 // BaseLogger
 
 BaseLogger::BaseLogger(std::ostream &out, std::ostream &err) noexcept
-    : out{out}, err{err} {
+    : out{out}, err{err}, pendingStream{nullptr} {
 }
 
 BaseLogger::BaseLogger(const BaseLogger &log) noexcept
-  : out{log.out}, err{log.err} {
+  : out{log.out}, err{log.err}, pendingStream{nullptr} {
 }
 
 BaseLogger::~BaseLogger() {
+  flush();
+}
+
+void BaseLogger::write(std::ostream &stream, const std::string &msg) noexcept {
+  // keep the order of lines written to different streams
+  if (pendingStream != &stream)
+    flush();
+
+  pendingStream = &stream;
+  pending += msg;
+  pending += '\n';
 }
 
 void BaseLogger::info(const std::string &msg) noexcept {
-  out << msg << std::endl;
+  write(out, msg);
 }
 
 void BaseLogger::error(const std::string &msg) noexcept {
-  err << msg << std::endl;
+  write(err, msg);
+}
+
+void BaseLogger::flush() noexcept {
+  if (!pendingStream)
+    return;
+
+  pendingStream->write(pending.data(), pending.size());
+  pendingStream->flush();
+  pendingStream = nullptr;
+  pending.clear();
 }
 
 // Logger
 
-Logger::Logger(Level allowedLevels, const BaseLogger &baseLog) noexcept
-    : allowedLevels{allowedLevels}, baseLog(baseLog) {
+static std::atomic<uint64_t> _loggerIds{1};
+
+//! Buffer of the current thread, valid if logger matches
+struct _BufferCache {
+  uint64_t logger;
+  DiagnosticBuffer *buffer;
+};
+
+static thread_local _BufferCache _currentBuffer{0, nullptr};
+
+constexpr const char *_SARIF_BEGIN = "{\"version\":\"2.1.0\","
+  "\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\","
+  "\"runs\":[{\"tool\":{\"driver\":{\"name\":\"pfederc\"}},"
+  "\"results\":[";
+constexpr const char *_SARIF_END = "]}]}";
+
+Logger::Logger(Level allowedLevels, const BaseLogger &baseLog,
+    bool buffered, DiagnosticFormat format) noexcept
+    : allowedLevels{allowedLevels}, baseLog(baseLog), buffered{buffered},
+      format{format}, records{0}, id{_loggerIds++}, flushLimit{0},
+      bufferedCount{0}, sequence{0} {
 }
 
 Logger::~Logger() {
+  flush();
+  if (format == DiagnosticFormat::SARIF) {
+    if (records == 0)
+      baseLog.info(_SARIF_BEGIN);
+
+    baseLog.info(_SARIF_END);
+    baseLog.flush();
+  }
+}
+
+DiagnosticBuffer &Logger::getBuffer() noexcept {
+  if (_currentBuffer.logger == id)
+    return *_currentBuffer.buffer;
+
+  std::lock_guard<std::mutex> guard(mtx);
+  auto &buffer = buffers[std::this_thread::get_id()];
+  if (!buffer)
+    buffer = std::make_unique<DiagnosticBuffer>();
+
+  _currentBuffer = _BufferCache{id, buffer.get()};
+  return *buffer;
 }
 
 bool Logger::accept(Level logLevel) const noexcept {
@@ -87,3 +190,179 @@ bool Logger::log(Level logLevel, const std::string &msg) noexcept {
 
   return true;
 }
+
+inline static const char *_levelName(Level logLevel) noexcept {
+  switch (logLevel) {
+  case LVL_WARNING:
+    return "warning";
+  case LVL_ERROR:
+    return "error";
+  case LVL_NOTE:
+    return "note";
+  case LVL_HELP:
+    return "help";
+  case LVL_FATAL:
+    return "fatal";
+  default:
+    return "failure";
+  }
+}
+
+inline static const char *_sarifLevelName(Level logLevel) noexcept {
+  switch (logLevel) {
+  case LVL_WARNING:
+    return "warning";
+  case LVL_NOTE:
+  case LVL_HELP:
+    return "note";
+  default:
+    return "error";
+  }
+}
+
+//! Writes accepted attached messages (nested ones flattened)
+static void _writeMessages(JsonWriter &json, const Logger &log,
+    const std::vector<LogMessage> &msgs) noexcept {
+  for (const LogMessage &msg : msgs) {
+    if (!log.accept(msg.getLogLevel()))
+      continue;
+
+    json.beginObject()
+      .member("level", _levelName(msg.getLogLevel()))
+      .member("message", msg.getMessage())
+      .endObject();
+    _writeMessages(json, log, msg.getMessages());
+  }
+}
+
+static void _writeJsonLine(std::string &out, const Logger &log,
+    const DiagnosticRecord &record) noexcept {
+  JsonWriter json(out);
+  json.beginObject()
+    .member("file", record.file)
+    .member("line", uint64_t(record.line))
+    .member("column", uint64_t(record.column))
+    .member("startIndex", uint64_t(record.startIndex))
+    .member("endIndex", uint64_t(record.endIndex))
+    .member("level", _levelName(record.logLevel))
+    .member("code", record.code)
+    .member("message", record.msg)
+    .key("notes").beginArray();
+  _writeMessages(json, log, record.msgs);
+  json.endArray().endObject();
+}
+
+static void _writeSarifResult(std::string &out, const Logger &log,
+    const DiagnosticRecord &record) noexcept {
+  JsonWriter json(out);
+  json.beginObject()
+    .member("ruleId", record.code)
+    .member("level", _sarifLevelName(record.logLevel))
+    .key("message").beginObject().member("text", record.msg).endObject()
+    .key("locations").beginArray().beginObject()
+    .key("physicalLocation").beginObject()
+    .key("artifactLocation").beginObject()
+    .member("uri", record.file).endObject()
+    .key("region").beginObject();
+  // lines and columns start at 1
+  if (record.line != 0)
+    json.member("startLine", uint64_t(record.line));
+  if (record.column != 0)
+    json.member("startColumn", uint64_t(record.column));
+
+  json.member("byteOffset", uint64_t(record.startIndex))
+    .member("byteLength", uint64_t(record.endIndex - record.startIndex + 1))
+    .endObject().endObject().endObject().endArray()
+    .key("properties").beginObject().key("notes").beginArray();
+  _writeMessages(json, log, record.msgs);
+  json.endArray().endObject().endObject();
+}
+
+void Logger::write(const std::string &file, const DiagnosticRenderer &render,
+    const DiagnosticDescriber &describe) noexcept {
+  if (format == DiagnosticFormat::TEXT) {
+    render().log(*this);
+    return;
+  }
+
+  DiagnosticRecord record;
+  if (describe) {
+    record = describe();
+  } else {
+    LogMessage msg = render();
+    record = DiagnosticRecord{msg.getLogLevel(), "", file, 0, 0, 0, 0,
+      msg.getMessage(), msg.getMessages()};
+  }
+
+  std::string line;
+  if (format == DiagnosticFormat::SARIF) {
+    line = records == 0 ? _SARIF_BEGIN : ",";
+    _writeSarifResult(line, *this, record);
+  } else {
+    _writeJsonLine(line, *this, record);
+  }
+
+  ++records;
+  baseLog.info(line);
+}
+
+void Logger::report(const std::string &file, size_t index, Level logLevel,
+    DiagnosticRenderer &&render, DiagnosticDescriber &&describe) noexcept {
+  // filtered diagnostics are neither buffered nor rendered
+  if (!accept(logLevel))
+    return;
+
+  if (!buffered) {
+    std::lock_guard<std::mutex> guard(mtx);
+    write(file, render, describe);
+    baseLog.flush();
+    return;
+  }
+
+  DiagnosticBuffer &buffer = getBuffer();
+  bool full;
+  {
+    std::lock_guard<std::mutex> guard(buffer.mtx);
+    buffer.diagnostics.push_back(Diagnostic{file, index, sequence++,
+        std::move(render), std::move(describe)});
+    full = ++bufferedCount == flushLimit;
+  }
+
+  if (full)
+    flush();
+}
+
+void Logger::report(const std::string &file, size_t index,
+    LogMessage &&msg) noexcept {
+  const Level logLevel = msg.getLogLevel();
+  report(file, index, logLevel,
+      [msg = std::move(msg)]() mutable { return std::move(msg); });
+}
+
+void Logger::flush() noexcept {
+  std::lock_guard<std::mutex> guard(mtx);
+  std::vector<Diagnostic> diagnostics;
+  for (auto &entry : buffers) {
+    DiagnosticBuffer &buffer = *entry.second;
+    std::lock_guard<std::mutex> bufferGuard(buffer.mtx);
+    bufferedCount -= buffer.diagnostics.size();
+    std::move(buffer.diagnostics.begin(), buffer.diagnostics.end(),
+        std::back_inserter(diagnostics));
+    buffer.diagnostics.clear();
+  }
+
+  std::vector<const Diagnostic*> ordered;
+  for (const Diagnostic &diag : diagnostics)
+    ordered.push_back(&diag);
+
+  std::sort(ordered.begin(), ordered.end(),
+      [](const Diagnostic *diag0, const Diagnostic *diag1) {
+        return std::tie(diag0->file, diag0->index, diag0->sequence)
+          < std::tie(diag1->file, diag1->index, diag1->sequence);
+      });
+
+  for (const Diagnostic *diag : ordered)
+    write(diag->file, diag->render, diag->describe);
+
+  baseLog.flush();
+}
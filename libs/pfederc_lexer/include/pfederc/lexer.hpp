@@ -3,6 +3,7 @@
 
 #include "pfederc/core.hpp"
 #include "pfederc/errors.hpp"
+#include "pfederc/instrumentation.hpp"
 #include "pfederc/token.hpp"
 
 namespace pfederc {
@@ -20,8 +21,12 @@ namespace pfederc {
     LEX_ERR_NUM_UNEXPECTED_CHAR_DIGIT,
     LEX_ERR_NUM_UNEXPECTED_CHAR,
     LEX_ERR_REGION_COMMENT_END,
+    LEX_ERR_BINARY_INPUT,
   };
 
+  //! Number of bytes checked for binary or non-UTF-8 input before lexing
+  constexpr size_t LEXER_TEXT_CHECK_SIZE = 4096;
+
   template<class ErrorCode>
   class Error final {
     Level logLevel;
@@ -62,6 +67,15 @@ namespace pfederc {
     int currentChar; //!< Current character invalid if currentToken == nullptr
     Token *currentToken; //!< Current token. nullptr before first next call.
     std::string lastComment; //!< Important for generating some documentation
+    ErrorLimit *errorLimit; //!< nullptr if unlimited
+    //! Input read by readLookahead, consumed by nextChar before input
+    std::string lookahead;
+    size_t lookaheadIndex;
+
+    /*!\brief Reads the first LEXER_TEXT_CHECK_SIZE bytes
+     * \return Returns true, if they are text (UTF-8 without NUL characters)
+     */
+    bool readLookahead() noexcept;
 
     // METHODS for next()
     //! Reads nextChar. Sets currentChar to read character.
@@ -127,6 +141,18 @@ namespace pfederc {
       return errors;
     }
 
+    /*!\brief Errors are counted by limit, next returns TOK_EOF after the
+     * limit is reached (also by other users of limit, e.g. the parser)
+     * \param limit nullptr disables the limit
+     */
+    inline void setErrorLimit(ErrorLimit *limit) noexcept {
+      errorLimit = limit;
+    }
+
+    inline ErrorLimit *getErrorLimit() const noexcept {
+      return errorLimit;
+    }
+
     /*!\return Returns current token position (last next call)
      */
     Position getCurrentCursor() const noexcept;
@@ -152,6 +178,9 @@ namespace pfederc {
     size_t getLineNumber(size_t index) const noexcept;
 
     /*!\brief Aquire next token from input stream
+     *
+     * Binary or non-UTF-8 input is rejected by the first call
+     * (LEX_ERR_BINARY_INPUT), it returns TOK_EOF.
      *
      * \return Never returns nullptr (except out-of-memory)
      */
@@ -168,10 +197,25 @@ namespace pfederc {
 
   LogMessage logLexerError(const Lexer &lexer, const LexerError &err) noexcept;
 
+  /*!\return Returns structured diagnostic of err (code LEX...)
+   */
+  DiagnosticRecord describeLexerError(const Lexer &lexer,
+      const LexerError &err) noexcept;
+
   std::string logCreateErrorMessage(const Lexer &lexer,
     const Position &pos, const std::string &msg) noexcept;
 
+  /*!\return Returns structured diagnostic located at pos in the file of
+   * lexer
+   */
+  DiagnosticRecord createDiagnosticRecord(const Lexer &lexer,
+      Level logLevel, std::string &&code, const Position &pos,
+      std::string &&msg, std::vector<LogMessage> &&msgs = {}) noexcept;
+
   /*!\return Returns true if an error occured
+   *
+   * Errors are rendered when log writes them, a buffered log must be
+   * flushed before lex is destroyed.
    */
   bool logLexerErrors(Logger &log, const Lexer &lex) noexcept;
 }
@@ -2,6 +2,7 @@
 #define PFEDERC_LEXER_TOKEN_HPP
 
 #include "pfederc/core.hpp"
+#include "pfederc/interner.hpp"
 #include "pfederc/errors.hpp"
 
 namespace pfederc {
@@ -271,6 +272,25 @@ namespace pfederc {
     bool operator ==(TokenType type) const noexcept;
 
     virtual std::string toString(const Lexer &lexer) const noexcept;
+
+    /*!\return Returns interned identifier of toString(lexer). Identifier
+     * tokens are interned while lexing and don't allocate.
+     * \param lexer
+     */
+    virtual InternedId toInternedId(const Lexer &lexer) const noexcept;
+  };
+
+  //! Identifier (TOK_ID), interned while lexing
+  class IdentifierToken final : public Token {
+    InternedId id;
+  public:
+    IdentifierToken(Token *last, const Position &pos, InternedId id) noexcept;
+    virtual ~IdentifierToken();
+
+    inline InternedId getIdentifier() const noexcept { return id; }
+
+    virtual std::string toString(const Lexer &lexer) const noexcept override;
+    virtual InternedId toInternedId(const Lexer &lexer) const noexcept override;
   };
 
   class NumberToken : public Token {
@@ -7,7 +7,8 @@ Lexer::Lexer(const LanguageConfiguration &cfg,
     : cfg(cfg), input{input}, filePath(filePath),
       fileContent(""), tokens(), lineIndices(), errors(),
       currentStartIndex{0}, currentEndIndex{0},
-      currentChar{EOF}, currentToken{nullptr}, lastComment() {
+      currentChar{EOF}, currentToken{nullptr}, lastComment(),
+      errorLimit{nullptr}, lookahead(), lookaheadIndex{0} {
   // 1 KiB should cover most programs
   constexpr size_t FILE_CONTENT_RESERVE = 1024 * 1024;
   fileContent.reserve(FILE_CONTENT_RESERVE); 
@@ -71,14 +72,69 @@ size_t Lexer::getLineNumber(size_t index) const noexcept {
     return 0;
   }
 
-  size_t lineIndex = lineIndices.size() - 1;
-  for (; index < lineIndices[lineIndex]; --lineIndex);
-
-  return lineIndex;
+  // last line beginning before or at index
+  return std::upper_bound(lineIndices.begin(), lineIndices.end(), index)
+    - lineIndices.begin() - 1;
 }
 
 // error reporting
 
+//! Maximal bytes of a line in excerpts, longer lines are clipped
+constexpr size_t EXCERPT_WIDTH = 160;
+//! Maximal lines in excerpts of positions spanning multiple lines
+constexpr size_t EXCERPT_LINES = 8;
+
+/*!\return Returns true, if line of lexer (without line ending and
+ * trailing spaces, end-of-file is read as space) is longer than
+ * EXCERPT_WIDTH
+ */
+static bool _isLongLine(const Lexer &lexer, size_t line,
+    size_t &lineBegin, size_t &lineEnd) noexcept {
+  const std::string &content = lexer.getFileContent();
+  const auto &lines = lexer.getLineIndices();
+  lineBegin = lines[line];
+  lineEnd = std::max(lineBegin,
+    line + 1 < lines.size() ? lines[line + 1] : content.length());
+  while (lineEnd > lineBegin
+      && (content[lineEnd - 1] == '\n' || content[lineEnd - 1] == '\r'
+        || content[lineEnd - 1] == ' '))
+    --lineEnd;
+
+  return lineEnd - lineBegin > EXCERPT_WIDTH;
+}
+
+/*!\brief Returns line of lexer. Long lines are clipped around index and
+ * marked with "..." (UTF-8 compatible), so errors on long lines are
+ * reported in constant space.
+ * \param begin Set to the index of the first character of the excerpt
+ */
+static std::string _excerptLine(const Lexer &lexer, size_t line,
+    size_t index, size_t &begin) noexcept {
+  size_t lineEnd;
+  if (!_isLongLine(lexer, line, begin, lineEnd))
+    return lexer.getLineAt(line);
+
+  const std::string &content = lexer.getFileContent();
+  const size_t lineBegin = begin;
+  index = std::min(std::max(index, lineBegin), lineEnd);
+  begin = std::min(std::max(index, lineBegin + EXCERPT_WIDTH / 2)
+      - EXCERPT_WIDTH / 2, lineEnd - EXCERPT_WIDTH);
+  while (begin > lineBegin
+      && !charset::isCharEnd<charset::UTF8>(content[begin]))
+    --begin;
+
+  size_t end = std::min(begin + EXCERPT_WIDTH, lineEnd);
+  while (end < lineEnd && !charset::isCharEnd<charset::UTF8>(content[end]))
+    ++end;
+
+  std::string result(begin > lineBegin ? "..." : "");
+  result.append(content, begin, end - begin);
+  if (end < lineEnd)
+    result += "...";
+
+  return result;
+}
+
 inline static std::string _logLexerErrorBase(const Lexer &lexer, const Position &pos) noexcept {
   return lexer.getFilePath() + ":"
     + std::to_string((pos.line + 1)) + ":" 
@@ -87,18 +143,22 @@ inline static std::string _logLexerErrorBase(const Lexer &lexer, const Position
 }
 
 inline static std::string _logLexerErrorMark(const Lexer &lexer, const Position &pos) noexcept {
-  std::string result = lexer.getLineAt(pos.line) + '\n';
-  const size_t lineStartIdx = lexer.getLineIndices()[lexer.getLineNumber(pos.startIndex)];
-  const size_t lineEndIdx = lexer.getLineIndices()[lexer.getLineNumber(pos.endIndex)];
+  size_t lineStartIdx;
+  std::string result = _excerptLine(lexer, pos.line, pos.startIndex,
+      lineStartIdx) + '\n';
   const size_t end = std::max(pos.startIndex, pos.endIndex);
   // if end position not in same line
   const size_t lastLine = lexer.getLineNumber(pos.endIndex);
   if (lastLine > pos.line) {
-    for (size_t i = pos.line; i <= lastLine; ++i) {
-      result += lexer.getLineAt(i) + '\n';
+    for (size_t i = pos.line;
+        i <= lastLine && i - pos.line < EXCERPT_LINES; ++i) {
+      size_t lineBegin;
+      result += _excerptLine(lexer, i, pos.startIndex, lineBegin) + '\n';
     }
   }
   // print space till start
+  if (lineStartIdx > lexer.getLineIndices()[pos.line])
+    result += "   "; // "..." of clipped line
   for (size_t i = lineStartIdx; i < pos.startIndex && i < lexer.getFileContent().size(); ++i)  {
     const uint8_t c = lexer.getFileContent()[i];
     if (c == '\t')
@@ -107,13 +167,18 @@ inline static std::string _logLexerErrorMark(const Lexer &lexer, const Position
       result += ' ';
   }
   // print marks till end
-  for (size_t i = pos.startIndex;
-       i <= end && i <= lexer.getFileContent().size(); ++i)  {
+  for (size_t i = pos.startIndex, marks = 0;
+       i <= end && i <= lexer.getFileContent().size()
+         && marks < EXCERPT_WIDTH; ++i)  {
     const uint8_t c = (i == lexer.getFileContent().size()) ? ' ' : lexer.getFileContent()[i];
     if (c == '\t')
       result += "^^";
     else if (charset::isCharEnd<charset::UTF8>(c)) // utf-8 compatible
       result += '^';
+    else
+      continue;
+
+    ++marks;
   }
   return result;
 }
@@ -122,74 +187,120 @@ std::string pfederc::logCreateErrorMessage(const Lexer &lexer, const Position &p
   return _logLexerErrorBase(lexer, pos) + msg + "\n" + _logLexerErrorMark(lexer, pos);
 }
 
+DiagnosticRecord pfederc::createDiagnosticRecord(const Lexer &lexer,
+    Level logLevel, std::string &&code, const Position &pos,
+    std::string &&msg, std::vector<LogMessage> &&msgs) noexcept {
+  return DiagnosticRecord{logLevel, std::move(code), lexer.getFilePath(),
+    pos.line + 1, pos.startIndex - lexer.getLineIndices()[pos.line] + 1,
+    pos.startIndex, std::max(pos.startIndex, pos.endIndex),
+    std::move(msg), std::move(msgs)};
+}
+
+/*!\brief Returns line of err with count characters at the error position
+ * replaced by replacement (clipped like error marks)
+ */
+static std::string _fixLine(const Lexer &lexer, const LexerError &err,
+    size_t count, const std::string &replacement) noexcept {
+  const Position &pos = err.getPosition();
+  size_t lineBegin, lineEnd;
+  if (!_isLongLine(lexer, pos.line, lineBegin, lineEnd)) {
+    std::string line(lexer.getLineFromIndex(pos.startIndex));
+    return line.replace(std::min(pos.startIndex - lineBegin, line.length()),
+        count, replacement);
+  }
+
+  size_t begin;
+  std::string line(_excerptLine(lexer, pos.line, pos.startIndex, begin));
+  const size_t column = pos.startIndex - begin + (begin > lineBegin ? 3 : 0);
+  return line.replace(std::min(column, line.length()), count, replacement);
+}
+
 inline static LogMessage _logLexerErrorLeadingZero(const Lexer &lexer, const LexerError &err) noexcept {
   return LogMessage(LVL_NOTE, "Fix: Remove zero\n"
-        + lexer.getLineFromIndex(err.getPosition().startIndex)
-          .erase(err.getPosition().startIndex - lexer.getLineIndices()[err.getPosition().line], 1));
+    + _fixLine(lexer, err, 1, ""));
 }
 
 inline static LogMessage _logLexerErrorCharInvalidEnd(const Lexer &lexer, const LexerError &err) noexcept {
   return LogMessage(LVL_NOTE, "Fix: Insert '\n"
-    + lexer.getLineFromIndex(err.getPosition().startIndex)
-      .insert(err.getPosition().startIndex - lexer.getLineIndices()[err.getPosition().line], "'"));
+    + _fixLine(lexer, err, 0, "'"));
 }
 
 inline static LogMessage _logLexerErrorStrInvalidEnd(const Lexer &lexer, const LexerError &err) noexcept {
   return LogMessage(LVL_NOTE, "Fix: Insert \"\n"
-    + lexer.getLineFromIndex(err.getPosition().startIndex)
-      .insert(err.getPosition().startIndex - lexer.getLineIndices()[err.getPosition().line], "\""));
+    + _fixLine(lexer, err, 0, "\""));
 }
 
-// global
-LogMessage pfederc::logLexerError(const Lexer &lexer, const LexerError &err) noexcept {
-  const Position &pos = err.getPosition();
-  switch (err.getErrorCode()) {
+inline static const char *_lexerErrorText(LexerErrorCode code) noexcept {
+  switch (code) {
   case LexerErrorCode::LEX_ERR_GENERAL_INVALID_CHARACTER:
-    return LogMessage(err.getLogLevel(),
-      logCreateErrorMessage(lexer, pos, "Invalid character"));  
+    return "Invalid character";
   case LexerErrorCode::LEX_ERR_ID_NO_DIGIT_AFTER_ANYS:
-    return LogMessage(err.getLogLevel(),
-      logCreateErrorMessage(lexer, pos, "Leading _ must not be followed by digit"));  
+    return "Leading _ must not be followed by digit";
   case LexerErrorCode::LEX_ERR_ID_NOT_JUST_ANYS:
-    return LogMessage(err.getLogLevel(),
-      logCreateErrorMessage(lexer, pos, "Identifier must not consist of just _"));  
+    return "Identifier must not consist of just _";
   case LexerErrorCode::LEX_ERR_STR_INVALID_ESCAPE_CODE:
-    return LogMessage(err.getLogLevel(),
-      logCreateErrorMessage(lexer, pos, "Invalid escape sequence"));  
+    return "Invalid escape sequence";
   case LexerErrorCode::LEX_ERR_CHAR_INVALID_END:
-    return LogMessage(err.getLogLevel(),
-      logCreateErrorMessage(lexer, pos, "Expected '"),
-      { _logLexerErrorCharInvalidEnd(lexer, err) });  
+    return "Expected '";
   case LexerErrorCode::LEX_ERR_STR_INVALID_END:
-    return LogMessage(err.getLogLevel(),
-      logCreateErrorMessage(lexer, pos, "Expected \""),
-      { _logLexerErrorStrInvalidEnd(lexer, err) });  
+    return "Expected \"";
   case LexerErrorCode::LEX_ERR_STR_HEXADECIMAL_CHAR:
-    return LogMessage(err.getLogLevel(),
-      logCreateErrorMessage(lexer, pos, "Expected hexadecimal character"));
+    return "Expected hexadecimal character";
   case LexerErrorCode::LEX_ERR_NUM_LEADING_ZERO:
-    return LogMessage(err.getLogLevel(),
-      logCreateErrorMessage(lexer, pos, "Zero must not be the first character of decimal number"),
-      { _logLexerErrorLeadingZero(lexer, err) });  
+    return "Zero must not be the first character of decimal number";
   case LexerErrorCode::LEX_ERR_NUM_UNEXPECTED_CHAR_DIGIT:
-    return LogMessage(err.getLogLevel(),
-      logCreateErrorMessage(lexer, pos, "Unexpected digit"));  
+    return "Unexpected digit";
   case LexerErrorCode::LEX_ERR_NUM_UNEXPECTED_CHAR:
-    return LogMessage(err.getLogLevel(), logCreateErrorMessage(lexer, pos, "Unexpected character"));  
+    return "Unexpected character";
   case LexerErrorCode::LEX_ERR_REGION_COMMENT_END:
-    return LogMessage(err.getLogLevel(), logCreateErrorMessage(lexer, pos, "Expected '*/'"));
+    return "Expected '*/'";
+  case LexerErrorCode::LEX_ERR_BINARY_INPUT:
+    return "Binary or non-UTF-8 input";
+  default:
+    return "Unknown error";
+  }
+}
+
+//! Returns fix-it notes of err
+static std::vector<LogMessage> _lexerErrorNotes(const Lexer &lexer,
+    const LexerError &err) noexcept {
+  switch (err.getErrorCode()) {
+  case LexerErrorCode::LEX_ERR_CHAR_INVALID_END:
+    return { _logLexerErrorCharInvalidEnd(lexer, err) };
+  case LexerErrorCode::LEX_ERR_STR_INVALID_END:
+    return { _logLexerErrorStrInvalidEnd(lexer, err) };
+  case LexerErrorCode::LEX_ERR_NUM_LEADING_ZERO:
+    return { _logLexerErrorLeadingZero(lexer, err) };
   default:
-    return LogMessage(err.getLogLevel(), logCreateErrorMessage(lexer, pos, "Unknown error"));
+    return {};
   }
 }
 
+// global
+LogMessage pfederc::logLexerError(const Lexer &lexer, const LexerError &err) noexcept {
+  return LogMessage(err.getLogLevel(), logCreateErrorMessage(lexer,
+        err.getPosition(), _lexerErrorText(err.getErrorCode())),
+      _lexerErrorNotes(lexer, err));
+}
+
+DiagnosticRecord pfederc::describeLexerError(const Lexer &lexer,
+    const LexerError &err) noexcept {
+  return createDiagnosticRecord(lexer, err.getLogLevel(),
+      formatDiagnosticCode("LEX", static_cast<size_t>(err.getErrorCode())),
+      err.getPosition(), _lexerErrorText(err.getErrorCode()),
+      _lexerErrorNotes(lexer, err));
+}
+
 bool pfederc::logLexerErrors(Logger &log, const Lexer &lex) noexcept {
   bool result = false;
   for (const auto &lexErr : lex.getErrors()) {
-    LogMessage msg = logLexerError(lex, *lexErr);
-    if (msg.getLogLevel() == LVL_ERROR)
+    const LexerError &err = *lexErr;
+    if (err.getLogLevel() == LVL_ERROR)
       result = true;
-    msg.log(log);
+    log.report(lex.getFilePath(), err.getPosition().startIndex,
+        err.getLogLevel(),
+        [&lex, &err]() { return logLexerError(lex, err); },
+        [&lex, &err]() { return describeLexerError(lex, err); });
   }
 
   return result;
@@ -207,3 +318,7 @@ std::string Token::toString(const Lexer &lexer) const noexcept {
   	  getPosition().endIndex - getPosition().startIndex + 1);
 	}
 }
+
+InternedId Token::toInternedId(const Lexer &lexer) const noexcept {
+  return intern(toString(lexer));
+}
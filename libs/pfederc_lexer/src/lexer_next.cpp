@@ -10,18 +10,30 @@ inline static bool _isNewLineCharacter(char ch) noexcept {
 // global
 
 Token& Lexer::next() noexcept {
+  ScopedPhase phase(Phase::LEX);
   if  (!currentToken) {
     lineIndices.push_back(0);
+    const bool text = readLookahead();
     nextChar();
     currentEndIndex = 0;
+    if (!text) {
+      if (!errorLimit || errorLimit->add())
+        errors.push_back(std::make_unique<LexerError>(LVL_ERROR,
+            LexerErrorCode::LEX_ERR_BINARY_INPUT, Position(0, 0, 0)));
+
+      currentChar = EOF;
+    }
   } else if (*currentToken == TokenType::TOK_EOF)
     return *currentToken;
+  else if (errorLimit && errorLimit->isReached())
+    currentChar = EOF; // stop reading
 
 
   std::unique_ptr<Token> result(nextToken());
   Token &tok = *result;
   currentToken = result.get();
   tokens.push_back(std::move(result));
+  instrumentation::count(Counter::TOKENS);
   return tok;
 }
 
@@ -30,8 +42,19 @@ void Lexer::skipSpace() noexcept {
     nextChar();
 }
 
+bool Lexer::readLookahead() noexcept {
+  lookahead.resize(LEXER_TEXT_CHECK_SIZE);
+  input.read(&lookahead[0], lookahead.size());
+  lookahead.resize(input.gcount());
+  // a character may be split by the end of the lookahead
+  return charset::isText(lookahead.data(), lookahead.size(),
+      lookahead.size() == LEXER_TEXT_CHECK_SIZE);
+}
+
 std::unique_ptr<Token> Lexer::generateError(std::unique_ptr<LexerError> &&err) noexcept {
-  errors.push_back(std::move(err));
+  if (!errorLimit || errorLimit->add())
+    errors.push_back(std::move(err));
+
   while (currentChar != EOF
       && currentChar != '\n' && currentChar != '\r')
     nextChar();
@@ -39,7 +62,10 @@ std::unique_ptr<Token> Lexer::generateError(std::unique_ptr<LexerError> &&err) n
 }
 
 int Lexer::nextChar() noexcept {
-  currentChar = input.get();
+  if (lookaheadIndex < lookahead.size())
+    currentChar = static_cast<uint8_t>(lookahead[lookaheadIndex++]);
+  else
+    currentChar = input.get();
   if (currentChar != std::char_traits<char>::eof()) {
     fileContent += static_cast<char>(currentChar);
   } else
@@ -157,7 +183,8 @@ std::unique_ptr<Token> Lexer::nextTokenId() noexcept {
   if (id == "null")
     return std::make_unique<Token>(currentToken, TokenType::TOK_OP_NULL, getCurrentCursor());
 
-  return std::make_unique<Token>(currentToken, TokenType::TOK_ID, getCurrentCursor());
+  return std::make_unique<IdentifierToken>(currentToken, getCurrentCursor(),
+      intern(id));
 }
 
 inline static bool _hasOperatorStr(const std::string &op, TokenType &type) noexcept {
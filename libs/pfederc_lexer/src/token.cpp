@@ -288,6 +288,23 @@ bool Token::operator ==(TokenType type) const noexcept {
   return getType() == type;
 }
 
+// IdentifierToken
+IdentifierToken::IdentifierToken(Token *last, const Position &pos,
+    InternedId id) noexcept
+    : Token(last, TokenType::TOK_ID, pos), id{id} {
+}
+
+IdentifierToken::~IdentifierToken() {
+}
+
+std::string IdentifierToken::toString(const Lexer &) const noexcept {
+  return internedString(id);
+}
+
+InternedId IdentifierToken::toInternedId(const Lexer &) const noexcept {
+  return id;
+}
+
 // NumberToken
 NumberToken::NumberToken(Token *last, TokenType type,
     const Position &pos, uint64_t num) noexcept
@@ -4,12 +4,16 @@
 #include "pfederc/core.hpp"
 #include "pfederc/errors.hpp"
 #include "pfederc/token.hpp"
+#include "pfederc/expr.hpp"
+#include "pfederc/scheduler.hpp"
 #include "pfederc/semantics_internals.hpp"
+#include "pfederc/semantics_deps.hpp"
 
 namespace pfederc {
   class Context;
   class CtxId;
   class CtxIdHash;
+  struct ContextTree;
   class Symbol;
   class TemplateSymbol;
   class NamespaceSymbol;
@@ -24,6 +28,9 @@ namespace pfederc {
   class FunctionParamSymbol;
   class AliasSymbol;
   class NamespaceSymbol;
+  class Semantic;
+  class SafeSemantic;
+  class TypeAnalyzer;
 
   enum SymbolType : uint64_t {
     ST_MODULE   = 0x00000001ull,
@@ -51,16 +58,172 @@ namespace pfederc {
     ST_NULL     = 0x00200000ull,
   };
 
+  //! Number of independently locked parts of a SymbolTable
+  constexpr size_t SYMBOL_TABLE_SHARDS = 8;
+  /*!\brief Number of name version counters of a context tree. Names with
+   * the same counter invalidate each other's cached resolutions.
+   */
+  constexpr size_t RESOLVE_VERSION_STRIPES = 1024;
+
+  /*!\brief Symbol in a SymbolTable. Nodes with the same name are linked in
+   * insertion order and are never removed.
+   */
+  struct SymbolNode final {
+    std::unique_ptr<Symbol> sym;
+    std::atomic<SymbolNode*> next;
+  };
+
+  /*!\brief Non-allocating range over symbols with the same name
+   *
+   * The range stays valid while symbols are added concurrently, added
+   * symbols might not be visible.
+   */
+  template<class T>
+  class BasicSymbolRange final {
+    const CtxId *ctxid;
+    const SymbolNode *first;
+    bool fromtop;
+  public:
+    class iterator final {
+      const CtxId *ctxid;
+      const SymbolNode *node;
+      bool fromtop;
+
+      //! Skips hidden symbols, if fromtop is true
+      void skip() noexcept;
+    public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef T *value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef T **pointer;
+      typedef T *reference;
+
+      inline iterator(const CtxId *ctxid, const SymbolNode *node,
+          bool fromtop) noexcept
+        : ctxid{ctxid}, node{node}, fromtop{fromtop} { skip(); }
+
+      inline T *operator *() const noexcept { return node->sym.get(); }
+
+      inline iterator &operator ++() noexcept {
+        node = node->next.load(std::memory_order_acquire);
+        skip();
+        return *this;
+      }
+
+      inline bool operator !=(const iterator &it) const noexcept
+      { return node != it.node; }
+      inline bool operator ==(const iterator &it) const noexcept
+      { return node == it.node; }
+    };
+
+    /*!\brief Initializes BasicSymbolRange
+     * \param ctxid Context the symbols are looked up in
+     * \param first First node or nullptr
+     * \param fromtop If true, hidden symbols are skipped
+     */
+    inline BasicSymbolRange(const CtxId *ctxid, const SymbolNode *first,
+        bool fromtop) noexcept
+      : ctxid{ctxid}, first{first}, fromtop{fromtop} {}
+
+    inline iterator begin() const noexcept
+    { return iterator(ctxid, first, fromtop); }
+    inline iterator end() const noexcept
+    { return iterator(ctxid, nullptr, fromtop); }
+
+    inline bool empty() const noexcept { return begin() == end(); }
+  };
+
+  typedef BasicSymbolRange<Symbol> SymbolRange;
+  typedef BasicSymbolRange<const Symbol> ConstSymbolRange;
+
+  /*!\brief Result of Context::resolve
+   */
+  struct Resolution final {
+    //! Closest context declaring the name, nullptr if not declared
+    Context *ctx;
+    //! Symbols with the name in ctx (hidden symbols aren't skipped)
+    SymbolRange symbols;
+  };
+
+  /*!\brief Read-mostly hash table of named symbols, keyed by interned name
+   *
+   * The table is split into SYMBOL_TABLE_SHARDS shards by name. Every
+   * shard is an open-addressing table (linear probing) guarded by a
+   * shared mutex, so lookups of different names and concurrent lookups
+   * don't block each other. Slots are never moved (the table stores
+   * pointers to them) and symbols are never removed, so lookups return the
+   * first node without holding a lock.
+   */
+  class SymbolTable final {
+    struct Slot {
+      InternedId name;
+      std::atomic<SymbolNode*> head;
+      SymbolNode *tail; //!< guarded by shard mutex
+    };
+
+    struct Shard {
+      mutable std::shared_mutex mtx;
+      std::vector<std::unique_ptr<Slot>> slots; //!< size is power of two
+      size_t size;
+    };
+
+    std::array<Shard, SYMBOL_TABLE_SHARDS> shards;
+
+    static const Slot *findSlot(const Shard &shard, InternedId name) noexcept;
+    static void grow(Shard &shard) noexcept;
+  public:
+    SymbolTable() noexcept;
+    SymbolTable(const SymbolTable &) = delete;
+    ~SymbolTable();
+
+    /*!\return Returns first node of symbols with name, nullptr if no such
+     * symbol exists.
+     * \param name
+     *
+     * This function is thread-safe.
+     */
+    const SymbolNode *find(InternedId name) const noexcept;
+
+    /*!\brief Appends sym to symbols with name, if no equal symbol exists
+     * \param name
+     * \param sym
+     * \return Returns sym, if an equal symbol already exists, otherwise
+     * nullptr.
+     *
+     * This function is thread-safe.
+     */
+    std::unique_ptr<Symbol> insert(InternedId name,
+        std::unique_ptr<Symbol> &&sym) noexcept;
+  };
+
+  /*!\brief Symbols of a CtxId. Allocated by the first addSymbol, scopes
+   * without declarations don't have symbol storage.
+   */
+  struct SymbolStorage final {
+    SymbolTable symbols;
+    std::list<std::unique_ptr<Symbol>> unnamedSymbols;
+    std::mutex mtxUnnamedSymbols;
+  };
+
   class CtxId {
+    friend class Context;
+
     Context *ctx;
     uint32_t id;
     bool flagContext;
 
-    std::list<std::unique_ptr<Symbol>> unnamedSymbols;
-    std::map<std::string, std::list<std::unique_ptr<Symbol>>> symbols;
-    mutable std::recursive_mutex mtxSymbols;
+    //! nullptr until a symbol is added
+    std::atomic<SymbolStorage*> storage;
 
     const Context *commonParent(const CtxId &ctxid) const noexcept;
+
+    //! Allocates storage, if it doesn't exist yet
+    SymbolStorage &getStorage() noexcept;
+  protected:
+    inline const SymbolNode *findSymbols(InternedId name) const noexcept {
+      const SymbolStorage *result = storage.load(std::memory_order_acquire);
+      return result ? result->symbols.find(name) : nullptr;
+    }
   public:
     /*!
      * \param ctx Context CtxId was created in
@@ -68,10 +231,11 @@ namespace pfederc {
      * \param flagContext
      */
     inline CtxId(Context *ctx, uint32_t id, bool flagContext = false) noexcept
-      : ctx{ctx}, id{id}, flagContext{flagContext}, unnamedSymbols() {
+      : ctx{ctx}, id{id}, flagContext{flagContext}, storage{nullptr} {
       assert(this->ctx);
     }
-    virtual ~CtxId() {}
+    CtxId(const CtxId &) = delete;
+    virtual ~CtxId();
 
     inline bool operator == (const CtxId &ctxid) const noexcept {
       return ctx == ctxid.ctx && id == ctxid.id;
@@ -91,7 +255,10 @@ namespace pfederc {
 
     /*!\return Returns false, if ctxid is executed prior to this
      * (translates roughly to: the position of the code is above this),
-     * otherwise true is returned.
+     * otherwise true is returned. Identifiers of the enclosing contexts
+     * (from the origin context) followed by id are the program order key,
+     * the keys are compared lexicographically from the common parent.
+     * Context ids of different trees aren't ordered.
      */
     bool operator < (const CtxId &ctxid) const noexcept;
 
@@ -103,13 +270,39 @@ namespace pfederc {
       return id;
     }
 
-    std::list<Symbol*> getSymbols(const std::string &name, bool fromtop) noexcept;
-    std::list<const Symbol*> getSymbols(const std::string &name, bool fromtop) const noexcept;
+    /*!\return Returns true, if symbol storage was allocated (a symbol was
+     * added)
+     */
+    inline bool hasSymbols() const noexcept {
+      return storage.load(std::memory_order_acquire);
+    }
+
+    /*!\return Returns symbols with name in insertion order. The returned
+     * range doesn't allocate memory.
+     * \param name
+     * \param fromtop If true, hidden symbols are skipped
+     *
+     * This function is thread-safe.
+     */
+    inline SymbolRange getSymbols(InternedId name, bool fromtop) noexcept
+    { return SymbolRange(this, findSymbols(name), fromtop); }
+
+    inline ConstSymbolRange getSymbols(InternedId name, bool fromtop) const noexcept
+    { return ConstSymbolRange(this, findSymbols(name), fromtop); }
+
+    //! Looks up name without interning it
+    inline SymbolRange getSymbols(const std::string &name, bool fromtop) noexcept
+    { return getSymbols(getStringInterner().find(name), fromtop); }
+
+    inline ConstSymbolRange getSymbols(const std::string &name, bool fromtop) const noexcept
+    { return getSymbols(getStringInterner().find(name), fromtop); }
 
     /*!\brief Adds sym to symbols map
      * \param sym
-     * \return Returns nullptr, if sym does already exists in map. Otherwise
-     * the parameter sym is returned.
+     * \return Returns sym, if sym does already exists in map. Otherwise
+     * nullptr is returned.
+     *
+     * This function is thread-safe.
      */
     std::unique_ptr<Symbol> addSymbol(std::unique_ptr<Symbol> &&sym) noexcept;
   };
@@ -118,19 +311,47 @@ namespace pfederc {
    * Type for referencing the current context
    */
   class Context : public CtxId {
+    //! Allows construction by ContextTree only
+    struct CreateKey {};
+
+    //! Cached resolution of a name
+    struct CachedResolution {
+      Context *ctx;
+      const SymbolNode *first;
+      //! Name version, the entry is stale if the version changed
+      uint32_t version;
+    };
+
+    //! Allocated by the first resolve
+    struct ResolveCache {
+      std::shared_mutex mtx;
+      std::unordered_map<InternedId, CachedResolution> entries;
+    };
+
     Context *parent;
-    std::list<std::unique_ptr<CtxId>> children;
-    uint32_t id;
-    uint32_t lastId;
+    //! Owned by the origin context
+    ContextTree *tree;
+    //! Number of parents
+    uint32_t depth;
+    std::atomic<uint32_t> lastId;
+    /*!\brief Parent (or this in the origin context) for ancestor lookups
+     * in O(log depth) steps, see getAncestor. Skew-binary jump pointers:
+     * the depth of jump depends on depth only.
+     */
+    Context *jump;
 
-    mutable std::recursive_mutex mtxId;
+    std::atomic<ResolveCache*> resolved;
 
-    inline Context(Context *parent, uint32_t id) noexcept
-      : CtxId(this, id, true), lastId{0}, parent{parent},
-        children(),
-        mtxId() {
-      assert(id == 0 || parent);
-    }
+    //! Set in the origin context only
+    std::unique_ptr<ContextTree> ownTree;
+
+    std::atomic<uint32_t> &getNameVersion(InternedId name) noexcept;
+
+    //! Walks the parents, doesn't use the cache
+    CachedResolution lookup(InternedId name, uint32_t version) noexcept;
+
+    //! Allocates cache, if it doesn't exist yet
+    ResolveCache &getResolveCache() noexcept;
 
     /*!
      * \return Returns new Context id
@@ -138,27 +359,39 @@ namespace pfederc {
      * This function is thread-safe.
      */
     inline uint32_t createId() noexcept {
-      std::lock_guard<std::recursive_mutex> guard(mtxId);
-      return lastId++;
+      return lastId.fetch_add(1, std::memory_order_relaxed);
     }
   public:
     /*!\brief Creates the origin context
      */
-    inline Context() noexcept
-      : Context(nullptr, 0) {}
+    Context() noexcept;
+    //! Used by ContextTree, see createContext
+    Context(Context *parent, uint32_t id, CreateKey) noexcept;
+    Context(const Context &) = delete;
 
     virtual ~Context();
 
     /*!\return Returns new context id, which is a child of this context.
-     * The returned pointer is deleted on destruction of this.
+     * The returned pointer is deleted on destruction of the origin context.
+     *
+     * This function is thread-safe, unless setConcurrent(false) was called.
      */
     CtxId *createCtxId() noexcept;
 
     /*!\return Returns new context, which is a child of this context.
-     * The returned pointer is deleted on destruction of this.
+     * The returned pointer is deleted on destruction of the origin context.
+     *
+     * This function is thread-safe, unless setConcurrent(false) was called.
      */
     Context *createContext() noexcept;
 
+    /*!\brief Sets, if contexts of this tree can be created concurrently.
+     * Single-threaded phases can create contexts without locking. Default is
+     * true.
+     * \param concurrent
+     */
+    void setConcurrent(bool concurrent) noexcept;
+
     /*!\return Returns  this contenxt's parent. Can be nullptr.
      */
     inline Context *getParent() noexcept
@@ -169,9 +402,19 @@ namespace pfederc {
     inline const Context *getParent() const noexcept
     { return parent; }
 
-    /*!\return Returns direct child context, which is (indirect) parent of
-     * child.  Returns nullptr, if there's no direct child, was has 'child' as
-     * indirect child.
+    //! Returns number of parents
+    inline uint32_t getDepth() const noexcept
+    { return depth; }
+
+    /*!\return Returns this or the parent with depth, depth must not be
+     * greater than getDepth()
+     * \param depth
+     */
+    const Context *getAncestor(uint32_t depth) const noexcept;
+
+    /*!\return Returns direct child context, which is child or an (indirect)
+     * parent of child. Returns nullptr, if child isn't an indirect child of
+     * this.
      */
     const CtxId *getChildContextIdWithChild(const Context &child) const noexcept;
 
@@ -181,7 +424,69 @@ namespace pfederc {
     /*!\return Returns true, if ctx is a parent of this.
      * \param ctx Context
      */
-    bool isParent(const Context &ctx) const noexcept;
+    inline bool isParent(const Context &ctx) const noexcept
+    { return ctx.depth < depth && getAncestor(ctx.depth) == &ctx; }
+
+    /*!\return Returns the deepest context, which is this or a parent of this
+     * and ctx or a parent of ctx. Returns nullptr, if the contexts aren't in
+     * the same tree. Climbs jump pointers (O(log depth) steps).
+     * \param ctx
+     */
+    const Context *getCommonParent(const Context &ctx) const noexcept;
+
+    /*!\brief Invalidates cached resolutions of name in the context tree.
+     * Called by addSymbol.
+     * \param name
+     */
+    void invalidate(InternedId name) noexcept;
+
+    /*!\brief Removes sym from lookups in this context tree (e.g. the
+     * declaration of sym changed). sym stays allocated, so pointers to it
+     * remain valid.
+     * \param sym Symbol added to a context (id) of this tree
+     *
+     * This function must not be called while symbols are looked up.
+     */
+    void retireSymbol(Symbol &sym) noexcept;
+
+    /*!\return Returns the symbols of the closest context (this or a parent)
+     * declaring name. Results (also "not declared") are cached until a
+     * symbol with name is added to the context tree.
+     * \param name
+     *
+     * This function is thread-safe.
+     */
+    Resolution resolve(InternedId name) noexcept;
+
+    /*!\brief Resolves names at once (e.g. all identifiers in a function
+     * body). The cache is locked once for all names.
+     * \param names
+     * \param result Resolutions in the order of names
+     *
+     * This function is thread-safe.
+     */
+    void resolveAll(const std::vector<InternedId> &names,
+        std::vector<Resolution> &result) noexcept;
+  };
+
+  /*!\brief Storage of all contexts and context ids of a context tree, owned
+   * by the origin context. Contexts are allocated in blocks and are never
+   * moved.
+   */
+  struct ContextTree final {
+    //! If false, contexts are created without locking
+    std::atomic<bool> concurrent;
+    //! Guards contexts and ctxids
+    std::mutex mtx;
+    std::deque<Context> contexts;
+    std::deque<CtxId> ctxids;
+
+    //! Name versions, see Context::invalidate
+    std::array<std::atomic<uint32_t>, RESOLVE_VERSION_STRIPES> nameVersions;
+
+    ContextTree() noexcept;
+    ContextTree(const ContextTree &) = delete;
+    ~ContextTree();
   };
 
   class CtxIdHash final {
@@ -196,31 +501,75 @@ namespace pfederc {
     }
   };
 
+  /*!\brief Canonical template arguments (alias chains are followed), two
+   * argument lists denote the same instance, if they are equal
+   */
+  typedef std::vector<Symbol*> TemplateArguments;
+
+  class TemplateArgumentsHash final {
+  public:
+    constexpr TemplateArgumentsHash() noexcept {}
+    inline ~TemplateArgumentsHash() {}
+
+    inline size_t operator ()(const TemplateArguments &args) const noexcept {
+      size_t result = std::hash<size_t>{}(args.size());
+      for (const Symbol *arg : args)
+        result = pfederc::combineHashes(result,
+            std::hash<const void*>{}(arg));
+
+      return result;
+    }
+  };
+
+  //! Maximum number of nested template instantiations of a thread
+  constexpr size_t TEMPLATE_INSTANTIATION_DEPTH = 256;
+
+  /*!\brief Changes of a symbol, ordered by the program order of the
+   * context ids they happen at
+   */
   template<class T>
   class SymbolHistory {
-    std::set<CtxId*> ctxTypeChangeList;
-    std::unordered_map<const CtxId*, T> ctxTypeChanges;
   public:
-    inline SymbolHistory() noexcept :
-      ctxTypeChangeList(), ctxTypeChanges() {}
+    typedef std::tuple<const CtxId* /* ctxid */, T /* change */> Change;
+  private:
+    std::vector<Change> changes;
+  protected:
+    /*!\brief Called after a change was inserted
+     * \param index Index of the inserted change in getChanges()
+     */
+    virtual void changed(size_t /*index*/) noexcept {}
+  public:
+    inline SymbolHistory() noexcept : changes() {}
     virtual ~SymbolHistory();
 
-    const auto getChangesContextIds() const noexcept
-    { return ctxTypeChangeList; }
-
+    //! Returns changes in program order
     const auto &getChanges() const noexcept
-    { return ctxTypeChanges; }
+    { return changes; }
+
+    /*!\return Returns number of changes at or before id (in program order),
+     * these are the first changes in getChanges(). Binary search.
+     * \param id
+     */
+    size_t countChanges(const CtxId &id) const noexcept {
+      return std::upper_bound(changes.begin(), changes.end(), &id,
+          [](const CtxId *id, const Change &change) {
+            return *id < *std::get<0>(change);
+          }) - changes.begin();
+    }
 
     /**
-     * \param id id must not be element of getChangesContextIds()
+     * \param id There must not be another change at id
      * \param t The associated change
      */
-    void addChange(CtxId &id, T&& t) noexcept {
-      CtxId *ptrId = &id;
-      assert(ctxTypeChangeList.find(ptrId) != ctxTypeChangeList.end());
-      // insert into set and map
-      ctxTypeChangeList.emplace(ptrId);
-      ctxTypeChanges.emplace(std::move(ptrId), std::move(t));
+    void addChange(const CtxId &id, T&& t) noexcept {
+      auto it = std::lower_bound(changes.begin(), changes.end(), &id,
+          [](const Change &change, const CtxId *id) {
+            return *std::get<0>(change) < *id;
+          });
+      assert(it == changes.end() || std::get<0>(*it) != &id);
+      const size_t index = it - changes.begin();
+      changes.emplace(it, &id, std::move(t));
+      changed(index);
     }
   };
 
@@ -229,20 +578,40 @@ namespace pfederc {
     uint64_t changeType;
   };
   
+  /*!\brief Type changes with prefix-aggregated masks, computeType is a
+   * binary search
+   */
   class SymbolHistoryType : public SymbolHistory<CtxTypeChange> {
+    /*!\brief Composition of the first changes, applied to a type x:
+     * (x & keep) | set
+     */
+    struct TypeMask {
+      uint64_t keep;
+      uint64_t set;
+    };
+
+    std::vector<TypeMask> prefixes;
+  protected:
+    virtual void changed(size_t index) noexcept override;
   public:
     inline SymbolHistoryType() noexcept :
-      SymbolHistory<CtxTypeChange>() {}
+      SymbolHistory<CtxTypeChange>(), prefixes() {}
     virtual ~SymbolHistoryType();
 
     uint64_t computeType(const CtxId &id, uint64_t baseSymType) const noexcept;
   };
 
   class Symbol {
+    friend class Context;
+
     uint64_t internalId;
     SymbolHistoryType symhisType;
+    //! Set by Context::retireSymbol
+    std::atomic<bool> retired;
   protected:
     uint64_t type;
+    //! Set by named symbols
+    InternedId name;
   public:
     /*!\brief Initializes a symbol
      * \param type The symbol type (bitmask)
@@ -260,7 +629,12 @@ namespace pfederc {
     /*!\return Returns nullptr, if this symbol doesn't have a name, otherwise
      * an existing pointer to a string is returned.
      */
-    virtual const std::string *getName() const noexcept { return nullptr; }
+    inline const std::string *getName() const noexcept
+    { return name != INTERNED_NONE ? &internedString(name) : nullptr; }
+
+    /*!\return Returns INTERNED_NONE, if this symbol doesn't have a name.
+     */
+    inline InternedId getNameId() const noexcept { return name; }
 
     /*!
      * \param id The modifiers of a Symbol can change depending on the context
@@ -270,14 +644,39 @@ namespace pfederc {
      */
     bool is(const CtxId &id, uint64_t types) const noexcept;
 
+    /*!\return Returns all SymbolTypes of this symbol in id. Use this
+     * instead of several calls to is.
+     * \param id
+     */
+    uint64_t getSymbolType(const CtxId &id) const noexcept;
+
+    /*!\brief Changes the SymbolTypes of this symbol from id on (in program
+     * order)
+     * \param id There must not be another change at id
+     * \param invert If true, types are removed, otherwise added
+     * \param types
+     */
+    void changeType(const CtxId &id, bool invert, uint64_t types) noexcept;
+
     /*!\return Returns true, if getName() exists for both objects and they are
-     * equal, or if either of the two objects return nullptr for getName(),
-     * then the reference of both objects is compared.
+     * equal (compares interned names), or if either of the two objects
+     * return nullptr for getName(), then the reference of both objects is
+     * compared.
      */
     virtual bool operator ==(const Symbol &sym) const noexcept;
 
     inline uint64_t getInternalId() const noexcept
     { return internalId; }
+
+    //! Returns the SymbolTypes without context dependent changes
+    inline uint64_t getBaseSymbolType() const noexcept
+    { return type; }
+
+    /*!\return Returns true, if the symbol was removed from lookups (see
+     * Context::retireSymbol)
+     */
+    inline bool isRetired() const noexcept
+    { return retired.load(std::memory_order_acquire); }
   };
 
   class NullSymbol final : public Symbol {
@@ -288,25 +687,55 @@ namespace pfederc {
 
   class AliasSymbol final : public Symbol {
     Symbol *symtype;
-    std::string name;
   public:
-    AliasSymbol(const std::string &name, Symbol *symtype) noexcept;
+    AliasSymbol(InternedId name, Symbol *symtype) noexcept;
     virtual ~AliasSymbol();
 
     virtual Symbol *getType() noexcept override;
     virtual const Symbol *getType() const noexcept override;
-
-    virtual const std::string *getName() const noexcept override;
     
     virtual bool operator ==(const Symbol &sym) const noexcept override;
   };
 
+  /*!\brief Symbol with template symbols (aliases without type)
+   *
+   * Instances are created on first use and memoized per canonical argument
+   * list, the instance cache can be accessed concurrently.
+   */
   class TemplateSymbol : public Symbol {
     std::list<AliasSymbol*> templSyms;
+    //! Template this symbol is an instance of, nullptr otherwise
+    TemplateSymbol *origin;
+    TemplateArguments arguments;
+
+    mutable std::shared_mutex mtxInstances;
+    std::unordered_map<TemplateArguments, std::unique_ptr<TemplateSymbol>,
+      TemplateArgumentsHash> instances;
+  protected:
+    /*!\brief Creates the instance of this template with the template
+     * symbols bound to args
+     * \param args Canonical arguments, one per template symbol
+     * \return Returns nullptr, if the instance couldn't be created
+     */
+    virtual std::unique_ptr<TemplateSymbol> instantiate(
+        const TemplateArguments &args) noexcept = 0;
+
+    /*!\return Returns the argument bound to sym, if sym is a template symbol
+     * of this template, otherwise sym.
+     */
+    Symbol *substitute(Symbol *sym,
+        const TemplateArguments &args) const noexcept;
+
+    /*!\brief Creates a child context of ctx, in which the template symbols
+     * are aliases of args
+     */
+    Context *createInstanceContext(Context &ctx,
+        const TemplateArguments &args) const noexcept;
   public:
     TemplateSymbol(uint64_t type,
         std::list<AliasSymbol*> &&templSyms,
         uint64_t internalId = 0) noexcept;
+    TemplateSymbol(const TemplateSymbol &) = delete;
     virtual ~TemplateSymbol();
 
     inline std::list<AliasSymbol*> getTemplateSymbols() noexcept {
@@ -317,7 +746,34 @@ namespace pfederc {
       return templSyms;
     }
 
-    virtual Symbol *resolveTemplate(std::list<AliasSymbol*> &&templSyms) noexcept = 0;
+    //! Returns the template of an instance, nullptr for other symbols
+    inline TemplateSymbol *getOrigin() const noexcept { return origin; }
+
+    //! Returns the arguments of an instance
+    inline const TemplateArguments &getTemplateArguments() const noexcept
+    { return arguments; }
+
+    //! Returns the number of instances created so far
+    size_t countInstances() const noexcept;
+
+    /*!\brief Appends the canonical argument of every alias in templSyms
+     * to result
+     */
+    static void canonicalize(const std::list<AliasSymbol*> &templSyms,
+        TemplateArguments &result) noexcept;
+
+    /*!\return Returns the instance with templSyms as arguments (see
+     * resolveTemplate(const TemplateArguments&)).
+     */
+    Symbol *resolveTemplate(std::list<AliasSymbol*> &&templSyms) noexcept;
+
+    /*!\return Returns the memoized instance for args, this if this symbol
+     * isn't a template or args are the template symbols. Returns nullptr,
+     * if the number of arguments doesn't match or the instantiation is
+     * recursive (or nested deeper than TEMPLATE_INSTANTIATION_DEPTH).
+     * \param args Canonical arguments
+     */
+    Symbol *resolveTemplate(const TemplateArguments &args) noexcept;
   };
 
   class LambdaSymbol : public TemplateSymbol {
@@ -345,22 +801,15 @@ namespace pfederc {
   };
 
   class FunctionSymbol final : public LambdaSymbol {
-    std::string name;
   public:
     FunctionSymbol(uint64_t type,
-        const std::string &name,
+        InternedId name,
         std::list<std::unique_ptr<FunctionParamSymbol>> &&params,
         Symbol *returnValue,
         std::list<AliasSymbol*> &&templSyms,
         uint64_t internalId = 0) noexcept;
     FunctionSymbol(uint64_t type,
-        std::string &&name,
-        std::list<std::unique_ptr<FunctionParamSymbol>> &&params,
-        Symbol *returnValue,
-        std::list<AliasSymbol*> &&templSyms,
-        uint64_t internalId = 0) noexcept;
-    FunctionSymbol(uint64_t type,
-        std::string &&name,
+        InternedId name,
         std::list<std::unique_ptr<FunctionParamSymbol>> &&params,
         Symbol *returnValue,
         uint64_t internalId = 0) noexcept;
@@ -369,90 +818,78 @@ namespace pfederc {
     virtual Symbol *getType() noexcept override;
     virtual const Symbol *getType() const noexcept override;
 
-    virtual const std::string *getName() const noexcept override;
+    /*!\return Returns true, if sym is a function with the same name and
+     * the same parameter types (overloads are different symbols).
+     */
+    virtual bool operator ==(const Symbol &sym) const noexcept override;
 
-    virtual Symbol *resolveTemplate(std::list<AliasSymbol*> &&templSyms) noexcept override;
+  protected:
+    virtual std::unique_ptr<TemplateSymbol> instantiate(
+        const TemplateArguments &args) noexcept override;
   };
 
   class ClassSymbol final : public TemplateSymbol {
-    std::unique_ptr<std::string> name;
     Context *objctx;
     Context *ctx;
   public:
     ClassSymbol(uint64_t type,
         Context *ctx,
-        const std::string *name,
-        std::list<AliasSymbol*> &&templSyms,
-        uint64_t internalId = 0) noexcept;
-    ClassSymbol(uint64_t type,
-        Context *ctx,
-        std::string &&name,
+        InternedId name,
         std::list<AliasSymbol*> &&templSyms,
         uint64_t internalId = 0) noexcept;
     ClassSymbol(uint64_t type,
         Context *ctx,
-        std::string &&name,
+        InternedId name,
         uint64_t internalId = 0) noexcept;
     virtual ~ClassSymbol();
 
     virtual Symbol *getType() noexcept override;
     virtual const Symbol *getType() const noexcept override;
 
-    virtual const std::string *getName() const noexcept override;
-
     virtual Context *getContext() noexcept override;
     virtual const Context *getContext() const noexcept override;
 
     virtual Context *getObjectContext() noexcept;
     virtual const Context *getObjectContext() const noexcept;
 
-    virtual Symbol *resolveTemplate(std::list<AliasSymbol*> &&templSyms) noexcept override;
+  protected:
+    virtual std::unique_ptr<TemplateSymbol> instantiate(
+        const TemplateArguments &args) noexcept override;
   };
 
   class TraitSymbol final : public TemplateSymbol {
-    std::string name;
     Context *ctx;
   public:
     TraitSymbol(uint64_t type,
         Context *ctx,
-        const std::string &name,
-        std::list<AliasSymbol*> &&templSyms,
-        uint64_t internalId = 0) noexcept;
-    TraitSymbol(uint64_t type,
-        Context *ctx,
-        std::string &&name,
+        InternedId name,
         std::list<AliasSymbol*> &&templSyms,
         uint64_t internalId = 0) noexcept;
     TraitSymbol(uint64_t type,
         Context *ctx,
-        std::string &&name,
+        InternedId name,
         uint64_t internalId = 0) noexcept;
     virtual ~TraitSymbol();
 
     virtual Symbol *getType() noexcept override;
     virtual const Symbol *getType() const noexcept override;
 
-    virtual const std::string *getName() const noexcept override;
-
     virtual Context *getContext() noexcept override;
     virtual const Context *getContext() const noexcept override;
 
-    virtual Symbol *resolveTemplate(std::list<AliasSymbol*> &&templSyms) noexcept override;
+  protected:
+    virtual std::unique_ptr<TemplateSymbol> instantiate(
+        const TemplateArguments &args) noexcept override;
   };
 
   class EnumSymbol final : public TemplateSymbol {
-    std::string name;
     Context *ctx;
   public:
-    EnumSymbol(uint64_t type, const std::string &name,
-        Context *ctx,
-        std::list<AliasSymbol*> &&templSyms,
-        uint64_t internalId = 0) noexcept;
-    EnumSymbol(uint64_t type, std::string &&name,
+    EnumSymbol(uint64_t type, InternedId name,
         Context *ctx,
         std::list<AliasSymbol*> &&templSyms,
         uint64_t internalId = 0) noexcept;
-    EnumSymbol(uint64_t type, std::string &&name,
+    EnumSymbol(uint64_t type, InternedId name,
         Context *ctx,
         uint64_t internalId = 0) noexcept;
     virtual ~EnumSymbol();
@@ -460,27 +897,23 @@ namespace pfederc {
     virtual Symbol *getType() noexcept override;
     virtual const Symbol *getType() const noexcept override;
 
-    virtual const std::string *getName() const noexcept override;
-
     virtual Context *getContext() noexcept override;
     virtual const Context *getContext() const noexcept override;
 
-    virtual Symbol *resolveTemplate(std::list<AliasSymbol*> &&templSyms) noexcept override;
+  protected:
+    virtual std::unique_ptr<TemplateSymbol> instantiate(
+        const TemplateArguments &args) noexcept override;
   };
 
   class TupleSymbol final : public Symbol {
-    std::unique_ptr<std::string> name;
     Context *ctx;
   public:
     inline TupleSymbol(uint64_t type,
-        const std::string *name, Context *ctx,
+        InternedId name, Context *ctx,
         uint64_t internalId = 0) noexcept
-      : Symbol(type | ST_TUPLE),
-        name(name ? new std::string(*name) : nullptr), ctx{ctx} {}
+      : Symbol(type | ST_TUPLE), ctx{ctx} { this->name = name; }
     virtual ~TupleSymbol();
 
-    virtual const std::string *getName() const noexcept override;
-
     virtual Context *getContext() noexcept override;
     virtual const Context *getContext() const noexcept override;
   };
@@ -500,40 +933,307 @@ namespace pfederc {
   };
 
   class VariableSymbol : public ObjectSymbol {
-    std::string name;
   public:
     VariableSymbol(uint64_t type,
-        const std::string &name, Symbol *objType,
-        uint64_t internalId = 0) noexcept;
-    VariableSymbol(uint64_t type,
-        std::string &&name, Symbol *objType,
+        InternedId name, Symbol *objType,
         uint64_t internalId = 0) noexcept;
     virtual ~VariableSymbol();
-
-    virtual const std::string *getName() const noexcept override;
   };
 
   class FunctionParamSymbol final : public VariableSymbol {
-    std::unique_ptr<std::string> name;
   public:
-    virtual const std::string *getName() const noexcept override;
+    /*!\brief Initializes FunctionParamSymbol
+     * \param type
+     * \param name Parameter name, INTERNED_NONE for unnamed parameters
+     * \param objType Parameter type
+     */
+    FunctionParamSymbol(uint64_t type,
+        InternedId name, Symbol *objType) noexcept;
+    virtual ~FunctionParamSymbol();
   };
 
   class NamespaceSymbol final : public Symbol {
-    std::string name;
     Context *ctx;
   public:
     NamespaceSymbol(uint64_t type,
-        const std::string &name, Context *ctx) noexcept;
+        InternedId name, Context *ctx) noexcept;
     virtual ~NamespaceSymbol();
 
     virtual Context *getContext() noexcept override;
     virtual const Context *getContext() const noexcept override;
+  };
+
+  /*!\brief Adds namespace std with builtin classes and traits
+   * \return Returns the context of namespace std
+   * \param mainContext
+   */
+  Context *addStandardLibrary(Context &mainContext) noexcept;
+
+  /*!\brief Analyzed declaration (module, class, function, ...)
+   */
+  class Semantic {
+    uint64_t type;
+    const Expr *expr;
+    Semantic *parent;
+    Symbol *sym;
+    std::map<std::string, Semantic*> children;
+  public:
+    /*!\brief Initializes Semantic
+     * \param type SymbolType bitmask, return value of getType()
+     * \param expr Declaring expression, return value of getExpression()
+     * \param parent Optional enclosing declaration, return value of
+     * getParent()
+     */
+    Semantic(uint64_t type, const Expr *expr, Semantic *parent) noexcept;
+    Semantic(const Semantic &) = delete;
+    virtual ~Semantic();
+
+    inline uint64_t getType() const noexcept { return type; }
+    inline const Expr *getExpression() const noexcept { return expr; }
+    inline Semantic *getParent() const noexcept { return parent; }
+
+    /*!\brief Sets the declaring expression (the declaration was parsed
+     * again, but didn't change)
+     */
+    inline void setExpression(const Expr *expr) noexcept { this->expr = expr; }
+
+    inline Symbol *getSymbol() const noexcept { return sym; }
+    inline void setSymbol(Symbol *sym) noexcept { this->sym = sym; }
+
+    /*!\return Returns false, if a child with the same name already exists,
+     * otherwise true is returned.
+     * \param name
+     * \param child
+     */
+    virtual bool addChild(const std::string &name, Semantic *child) noexcept;
 
-    const std::string *getName() const noexcept override;
+    /*!\return Returns child with name, nullptr if no such child exists.
+     * \param name
+     */
+    virtual Semantic *getChild(const std::string &name) const noexcept;
+
+    /*!\brief Removes child (if it is a child of this semantic)
+     * \param child
+     */
+    virtual void removeChild(const Semantic *child) noexcept;
+  };
+
+  /*!\brief Semantic, which allows adding children concurrently
+   */
+  class SafeSemantic final : public Semantic {
+    mutable std::mutex mtx;
+  public:
+    SafeSemantic(uint64_t type, const Expr *expr, Semantic *parent) noexcept;
+    virtual ~SafeSemantic();
+
+    virtual bool addChild(const std::string &name, Semantic *child) noexcept override;
+    virtual Semantic *getChild(const std::string &name) const noexcept override;
+    virtual void removeChild(const Semantic *child) noexcept override;
+  };
+
+  struct BuildSemanticParam final {
+    //! Unit name, used if program has no program name
+    std::string name;
+    //! Definitions of the main unit are in the main context, definitions of
+    //! other units are in a module named after the program name
+    bool main;
+    const ProgramExpr *program;
+  };
+
+  enum class SemanticErrorCode {
+    SMT_ERR_REDEFINITION,
+    SMT_ERR_UNKNOWN_TYPE,
+  };
+
+  typedef Error<SemanticErrorCode> SemanticError;
+
+  typedef std::tuple<const Lexer* /* lexer */,
+          std::unique_ptr<SemanticError> /* error */> SemanticErrorEntry;
+
+  /*!\brief Results of analyzing a definition in program or module scope,
+   * kept between builds of a TypeAnalyzer
+   */
+  struct DeclarationRecord final {
+    //! Declared name, INTERNED_NONE for trait implementations
+    InternedId name;
+    //! Guards symbols, semantics and failed while analyzing
+    std::mutex mtx;
+    //! Symbols declared by the definition (and its members)
+    std::vector<Symbol*> symbols;
+    //! Added semantics with the preorder index of their expression in the
+    //! definition (set after the build)
+    std::vector<std::tuple<std::string /* mangle */,
+      size_t /* expr index */>> semantics;
+    //! Errors were reported, the definition is analyzed again next build
+    bool failed;
+  };
+
+  /*!\brief Definition in program or module scope of the current build
+   */
+  struct DeclarationPlan final {
+    //! Mangle prefix of the scope
+    std::string prefix;
+    //! Prefix, fingerprint and number of equal definitions before
+    std::string key;
+    const Expr *expr;
+    //! Hash of the definition's text
+    uint64_t fingerprint;
+    InternedId name;
+    //! Referenced identifiers (ascending, without duplicates)
+    std::vector<InternedId> references;
+    DeclarationRecord *record;
+    //! True, if the results of the previous build are still valid
+    bool reused;
+  };
+
+  /*!\brief Declares and resolves types of all definitions
+   *
+   * Every definition in program, module, class and trait scope is a task of
+   * a work-stealing TaskScheduler. Tasks requiring types, which are not
+   * declared yet (e.g. type aliases, function signatures), are suspended
+   * until a symbol with the required name is declared.
+   */
+  class TypeAnalyzer final {
+    size_t threads;
+    Context mainContext;
+    Context *stdContext;
+    NullSymbol nullSymbol;
+    SafeSemantic root;
+
+    std::map<std::string, std::unique_ptr<Semantic>> semantics;
+    std::mutex mtxSemantics;
+
+    std::vector<SemanticErrorEntry> errors;
+    std::mutex mtxErrors;
+    ErrorLimit *errorLimit;
+
+    //! Records of the last build by DeclarationPlan::key
+    std::unordered_map<std::string, std::unique_ptr<DeclarationRecord>>
+      declarations;
+    //! Mangles of units and modules visited by the current build
+    std::set<std::string> visitedScopes;
+    size_t analyzedDeclarations, reusedDeclarations;
+
+    //! Removes the symbols and semantics of record
+    void retireDeclaration(DeclarationRecord &record) noexcept;
+    /*!\brief Removes the semantics and namespace symbols of units and
+     * modules
+     * \param stale Mangles of the units and modules
+     */
+    void removeScopes(const std::set<std::string> &stale) noexcept;
+    /*!\brief Reuses records of unchanged definitions, which don't depend on
+     * changed definitions. Other records are retired, as well as units and
+     * modules, which don't exist anymore.
+     * \param plans Definitions of the current build
+     * \param scopes Mangles of units and modules of the current build
+     */
+    void planDeclarations(std::vector<DeclarationPlan> &plans,
+        const std::set<std::string> &scopes) noexcept;
+    //! Stores expression indices of the analyzed definitions
+    void finishDeclarations(std::vector<DeclarationPlan> &plans) noexcept;
+  public:
+    /*!\brief Initializes TypeAnalyzer
+     * \param threads Number of workers used by buildSemantics
+     */
+    TypeAnalyzer(size_t threads = 1) noexcept;
+    TypeAnalyzer(const TypeAnalyzer &) = delete;
+    ~TypeAnalyzer();
+
+    inline Context &getContext() noexcept { return mainContext; }
+    inline const Context &getContext() const noexcept { return mainContext; }
+
+    /*!\return Returns context of namespace std, types are looked up in this
+     * context after the main context
+     */
+    inline Context &getStandardContext() noexcept { return *stdContext; }
+
+    /*!\return Returns symbol used for types, which cannot be resolved
+     */
+    inline Symbol &getNullSymbol() noexcept { return nullSymbol; }
+
+    /*!\return Returns parent of all semantics in the main unit
+     */
+    inline Semantic &getRoot() noexcept { return root; }
+
+    /*!\return Returns errors ordered by file and position
+     */
+    inline const auto &getErrors() const noexcept { return errors; }
+
+    /*!\brief Errors are counted by limit, no definitions are spawned after
+     * the limit is reached
+     * \param limit nullptr disables the limit
+     */
+    inline void setErrorLimit(ErrorLimit *limit) noexcept
+    { errorLimit = limit; }
+
+    inline bool isErrorLimitReached() const noexcept
+    { return errorLimit && errorLimit->isReached(); }
+
+    /*!\return Returns true, if no errors occured, otherwise false.
+     * \param params Units to analyze
+     *
+     * Can be called again with all units parsed again. Definitions in
+     * program and module scope are only analyzed again, if their text
+     * (fingerprint) changed, they had errors, or they reference a name,
+     * whose declarations are analyzed again. Expressions of previous builds
+     * can be destroyed before.
+     */
+    bool buildSemantics(std::list<BuildSemanticParam> &&params) noexcept;
+
+    //! Returns the number of definitions analyzed by the last build
+    inline size_t countAnalyzedDeclarations() const noexcept
+    { return analyzedDeclarations; }
+
+    //! Returns the number of definitions reused by the last build
+    inline size_t countReusedDeclarations() const noexcept
+    { return reusedDeclarations; }
+
+    /*!\return Returns true, if the unit or module mangle is visited the
+     * first time in the current build
+     *
+     * Called while definitions are spawned (single-threaded).
+     */
+    bool visitScope(const std::string &mangle) noexcept;
+
+    /*!\return Returns semantic stored with mangle. If mangle already exists,
+     * the existing semantic is returned and inserted is false.
+     * \param mangle
+     * \param semantic
+     * \param inserted
+     *
+     * This function is thread-safe.
+     */
+    Semantic *addSemantic(const std::string &mangle,
+        std::unique_ptr<Semantic> &&semantic, bool &inserted) noexcept;
+
+    /*!\brief Adds error, if the error limit isn't reached
+     * \param lexer
+     * \param err
+     *
+     * This function is thread-safe.
+     */
+    void addError(const Lexer &lexer,
+        std::unique_ptr<SemanticError> &&err) noexcept;
+
+    /*!\brief Calls fn with every semantic ordered by mangle
+     * \param fn
+     */
+    void forEachSemantic(
+        const std::function<void(const std::string&, Semantic*)> &fn) noexcept;
   };
 
-  void addStandardLibrary(Context &mainContext) noexcept;
+  /*!\return Returns structured diagnostic of err (code SMT...)
+   */
+  DiagnosticRecord describeSemanticError(const Lexer &lexer,
+      const SemanticError &err) noexcept;
+
+  /*!\return Returns true if an error occured while analyzing
+   * otherwise false.
+   *
+   * Errors are rendered when log writes them, a buffered log must be
+   * flushed before analyzer is destroyed or built again.
+   */
+  bool logSemanticErrors(Logger &log, const TypeAnalyzer &analyzer) noexcept;
 }
 
 #endif /* PFEDERC_SEMANTICS_SEMANTICS_HPP */
@@ -0,0 +1,105 @@
+#ifndef PFEDERC_SEMANTICS_SEMANTICS_DEPS_HPP
+#define PFEDERC_SEMANTICS_SEMANTICS_DEPS_HPP
+
+#include "pfederc/core.hpp"
+#include "pfederc/interner.hpp"
+#include "pfederc/expr.hpp"
+
+namespace pfederc {
+  /*!\brief Dependencies between the definitions of one scope (program or
+   * module), built from identifier references
+   *
+   * Every definition is a node. A definition depends on every definition of
+   * the scope, whose name is referenced anywhere in it. Local declarations
+   * shadowing a name aren't considered, so dependencies are conservative.
+   *
+   * Mutually recursive definitions form a component. Components are grouped
+   * in levels: a component only depends on components of lower levels, so
+   * the components of a level can be analyzed in parallel.
+   */
+  class DeclarationGraph final {
+    std::vector<const Expr*> defs;
+    std::vector<InternedId> names;
+    //! Dependencies per definition (ascending, without duplicates)
+    std::vector<std::vector<size_t>> deps;
+
+    //! Component per definition
+    std::vector<size_t> components;
+    //! Definitions per component (ascending), dependencies first
+    std::vector<std::vector<size_t>> members;
+    std::vector<bool> recursive;
+    //! Level per component
+    std::vector<size_t> componentLevels;
+    //! Components per level, ordered by their first definition
+    std::vector<std::vector<size_t>> levels;
+
+    void buildDependencies() noexcept;
+    void buildComponents() noexcept;
+    void buildLevels() noexcept;
+  public:
+    /*!\brief Initializes DeclarationGraph
+     * \param defs Definitions of the scope in program order
+     */
+    DeclarationGraph(std::vector<const Expr*> &&defs) noexcept;
+    DeclarationGraph(const DeclarationGraph &) = delete;
+    ~DeclarationGraph();
+
+    inline size_t size() const noexcept { return defs.size(); }
+
+    inline const Expr &getDefinition(size_t def) const noexcept
+    { return *defs[def]; }
+
+    /*!\return Returns the declared name of def, INTERNED_NONE if def doesn't
+     * declare a name (e.g. trait implementations)
+     */
+    inline InternedId getName(size_t def) const noexcept
+    { return names[def]; }
+
+    //! Returns the definitions def depends on (ascending)
+    inline const std::vector<size_t> &getDependencies(size_t def) const noexcept
+    { return deps[def]; }
+
+    inline size_t getComponent(size_t def) const noexcept
+    { return components[def]; }
+
+    /*!\return Returns the number of components. Components are numbered
+     * in topological order (dependencies first).
+     */
+    inline size_t countComponents() const noexcept { return members.size(); }
+
+    //! Returns the definitions of component (ascending)
+    inline const std::vector<size_t> &getMembers(size_t component) const noexcept
+    { return members[component]; }
+
+    /*!\return Returns true, if the definitions of component depend on each
+     * other (or the only definition depends on itself)
+     */
+    inline bool isRecursive(size_t component) const noexcept
+    { return recursive[component]; }
+
+    inline size_t getLevel(size_t component) const noexcept
+    { return componentLevels[component]; }
+
+    //! Returns components per level
+    inline const auto &getLevels() const noexcept { return levels; }
+
+    /*!\brief Marks every definition depending (directly or indirectly) on a
+     * marked definition
+     * \param marked One flag per definition
+     */
+    void markDependents(std::vector<bool> &marked) const noexcept;
+  };
+
+  /*!\return Returns the name declared by the definition expr, INTERNED_NONE
+   * if expr doesn't declare a name
+   */
+  InternedId getDeclaredName(const Expr &expr) noexcept;
+
+  /*!\brief Appends every identifier referenced in expr (and its children)
+   * to result, duplicates included
+   */
+  void collectReferences(const Expr &expr,
+      std::vector<InternedId> &result) noexcept;
+}
+
+#endif /* PFEDERC_SEMANTICS_SEMANTICS_DEPS_HPP */
@@ -26,6 +26,10 @@ namespace pfederc {
   constexpr uint64_t ITID_CL_U32 = 1000006;
   constexpr uint64_t ITID_CL_I64 = 1000007;
   constexpr uint64_t ITID_CL_U64 = 1000008;
+  constexpr uint64_t ITID_CL_F32 = 1000009;
+  constexpr uint64_t ITID_CL_F64 = 1000010;
+  constexpr uint64_t ITID_CL_BOOL = 1000011;
+  constexpr uint64_t ITID_CL_CHAR = 1000012;
 
   constexpr uint64_t ITID_TR_BASE = 100000000;
 
@@ -2,151 +2,508 @@
 using namespace pfederc;
 
 // CtxId
+CtxId::~CtxId() {
+  delete storage.load();
+}
+
+SymbolStorage &CtxId::getStorage() noexcept {
+  SymbolStorage *result = storage.load(std::memory_order_acquire);
+  if (result)
+    return *result;
+
+  // concurrent allocations: the first one is used
+  SymbolStorage *created = new SymbolStorage();
+  if (storage.compare_exchange_strong(result, created,
+        std::memory_order_acq_rel, std::memory_order_acquire))
+    return *created;
+
+  delete created;
+  return *result;
+}
+
 const Context *CtxId::commonParent(const CtxId &ctxid) const noexcept {
-  Context *result = ctx;
-  for (; !ctxid.ctx->isParent(*result); result = ctx->getParent());
-  
-  return result;
+  return ctx->getCommonParent(*ctxid.ctx);
+}
+
+/*!\return Returns false, if the program order key of ctxid ends with
+ * parent (ctxid is parent), otherwise true
+ * \param ctxid Is parent or in parent
+ * \param parent
+ * \param id Is set to the key element following parent
+ */
+static bool _orderAfter(const CtxId &ctxid, const Context &parent,
+    uint32_t &id) noexcept {
+  const Context &ctx = ctxid.getContext();
+  if (&ctx != &parent) {
+    id = ctx.getAncestor(parent.getDepth() + 1)->getIdentifier();
+    return true;
+  }
+
+  id = ctxid.getIdentifier();
+  return !ctxid.isContext();
 }
 
 bool CtxId::operator < (const CtxId &ctxid) const noexcept {
-  if (ctx == ctxid.ctx) {
+  if (ctx == ctxid.ctx && !flagContext && !ctxid.flagContext)
     return id < ctxid.id;
+
+  // keys are equal up to the common parent
+  const Context *parent = commonParent(ctxid);
+  if (!parent)
+    return false;
+
+  uint32_t lhs, rhs;
+  if (!_orderAfter(ctxid, *parent, rhs))
+    return false;
+
+  // enclosing contexts are before their content
+  return !_orderAfter(*this, *parent, lhs) || lhs < rhs;
+}
+
+std::unique_ptr<Symbol> CtxId::addSymbol(std::unique_ptr<Symbol> &&sym) noexcept {
+  SymbolStorage &storage = getStorage();
+  const InternedId name = sym->getNameId();
+  if (name != INTERNED_NONE) {
+    std::unique_ptr<Symbol> result = storage.symbols.insert(name,
+        std::move(sym));
+    if (!result) {
+      ctx->invalidate(name);
+      instrumentation::count(Counter::SYMBOLS);
+    }
+
+    return result;
   }
 
-  const auto *cmnParent = commonParent(ctxid);
-  const auto *ctx0 = cmnParent->getChildContextIdWithChild(getContext());
-  const auto *ctx1 = cmnParent->getChildContextIdWithChild(ctxid.getContext());
-  return ctx0->getIdentifier() < ctx1->getIdentifier();
+  auto &unnamedSymbols = storage.unnamedSymbols;
+  std::lock_guard<std::mutex> guard(storage.mtxUnnamedSymbols);
+  auto it = std::find_if(unnamedSymbols.begin(), unnamedSymbols.end(),
+      [&sym] (std::unique_ptr<Symbol> &e) {
+        return *e == *sym;
+      });
+
+  // Element, that is about the same already exists in the list
+  if (it != unnamedSymbols.end())
+    return std::move(sym);
+
+  unnamedSymbols.push_back(std::move(sym));
+  instrumentation::count(Counter::SYMBOLS);
+
+  return nullptr;
+}
+
+// BasicSymbolRange
+template<class T>
+void BasicSymbolRange<T>::iterator::skip() noexcept {
+  while (node && (node->sym->isRetired()
+        || (fromtop && node->sym->is(*ctxid, ST_HIDDEN))))
+    node = node->next.load(std::memory_order_acquire);
 }
 
-std::list<Symbol*> CtxId::getSymbols(const std::string &name, bool fromtop) noexcept {
-  std::lock_guard<std::recursive_mutex> guard(mtxSymbols);
+template class pfederc::BasicSymbolRange<Symbol>;
+template class pfederc::BasicSymbolRange<const Symbol>;
 
-  std::list<Symbol*> result{};
+// SymbolTable
+SymbolTable::SymbolTable() noexcept {
+  for (Shard &shard : shards)
+    shard.size = 0;
+}
 
-  auto it = symbols.find(name);
-  if (it == symbols.end())
-    return result;
+SymbolTable::~SymbolTable() {
+  for (Shard &shard : shards) {
+    for (auto &slot : shard.slots) {
+      if (!slot)
+        continue;
 
-  auto &lst = it->second;
-  for (auto &e : lst) {
-    if (!e->is(*this, ST_HIDDEN) || !fromtop)
-      result.push_back(e.get());
+      SymbolNode *node = slot->head.load();
+      while (node) {
+        SymbolNode *next = node->next.load();
+        delete node;
+        node = next;
+      }
+    }
   }
+}
 
-  return result;
+//! Interned ids are consecutive, shards are used round-robin
+inline static size_t _shardIndex(InternedId name) noexcept {
+  return name % SYMBOL_TABLE_SHARDS;
 }
 
-std::list<const Symbol*> CtxId::getSymbols(const std::string &name, bool fromtop) const noexcept {
-  std::lock_guard<std::recursive_mutex> guard(mtxSymbols);
+//! Fibonacci hashing, spreads consecutive ids
+inline static size_t _slotIndex(InternedId name) noexcept {
+  return static_cast<size_t>(
+      (static_cast<uint64_t>(name / SYMBOL_TABLE_SHARDS)
+        * 0x9e3779b97f4a7c15ull) >> 32);
+}
 
-  std::list<const Symbol*> result{};
+const SymbolTable::Slot *SymbolTable::findSlot(const Shard &shard,
+    InternedId name) noexcept {
+  const size_t mask = shard.slots.size() - 1;
+  size_t i = _slotIndex(name) & mask;
+  for (size_t probes = 0; probes < shard.slots.size(); ++probes) {
+    const Slot *slot = shard.slots[i].get();
+    if (!slot)
+      return nullptr;
 
-  auto it = symbols.find(name);
-  if (it == symbols.end())
-    return result;
+    if (slot->name == name)
+      return slot;
 
-  const auto &lst = it->second;
-  for (auto &e : lst) {
-    if (!e->is(*this, ST_HIDDEN) || !fromtop)
-      result.push_back(e.get());
+    i = (i + 1) & mask;
   }
 
-  return result;
+  return nullptr;
 }
 
-std::unique_ptr<Symbol> CtxId::addSymbol(std::unique_ptr<Symbol> &&sym) noexcept {
-  std::lock_guard<std::recursive_mutex> guard(mtxSymbols);
+void SymbolTable::grow(Shard &shard) noexcept {
+  std::vector<std::unique_ptr<Slot>> slots(
+      std::max<size_t>(shard.slots.size() * 2, 8));
+  const size_t mask = slots.size() - 1;
+  for (auto &slot : shard.slots) {
+    if (!slot)
+      continue;
 
-  std::list<std::unique_ptr<Symbol>> &lst = sym->getName() ?
-    symbols[*sym->getName()] : unnamedSymbols;
+    size_t i = _slotIndex(slot->name) & mask;
+    while (slots[i])
+      i = (i + 1) & mask;
 
-  auto it = std::find_if(lst.begin(), lst.end(),
-      [&sym] (std::unique_ptr<Symbol> &e) {
-        return *e == *sym;
-      });
+    slots[i] = std::move(slot);
+  }
 
-  // Element, that is about the same already exists in the list
-  if (it != lst.end())
-    return std::move(sym);
+  shard.slots = std::move(slots);
+}
+
+const SymbolNode *SymbolTable::find(InternedId name) const noexcept {
+  if (name == INTERNED_NONE)
+    return nullptr;
+
+  const Shard &shard = shards[_shardIndex(name)];
+
+  std::shared_lock<std::shared_mutex> guard(shard.mtx);
+  if (shard.slots.empty())
+    return nullptr;
+
+  const Slot *slot = findSlot(shard, name);
+  return slot ? slot->head.load(std::memory_order_acquire) : nullptr;
+}
+
+std::unique_ptr<Symbol> SymbolTable::insert(InternedId name,
+    std::unique_ptr<Symbol> &&sym) noexcept {
+  Shard &shard = shards[_shardIndex(name)];
+
+  std::unique_lock<std::shared_mutex> guard(shard.mtx);
+  Slot *slot = shard.slots.empty() ? nullptr :
+    const_cast<Slot*>(findSlot(shard, name));
+  if (slot) {
+    // Element, that is about the same already exists in the list
+    for (const SymbolNode *node = slot->head.load(); node;
+        node = node->next.load()) {
+      if (!node->sym->isRetired() && *node->sym == *sym)
+        return std::move(sym);
+    }
+  } else {
+    // load factor <= 0.5
+    if (2 * (shard.size + 1) > shard.slots.size())
+      grow(shard);
+
+    const size_t mask = shard.slots.size() - 1;
+    size_t i = _slotIndex(name) & mask;
+    while (shard.slots[i])
+      i = (i + 1) & mask;
+
+    shard.slots[i] = std::make_unique<Slot>();
+    slot = shard.slots[i].get();
+    slot->name = name;
+    slot->head = nullptr;
+    slot->tail = nullptr;
+    ++shard.size;
+  }
 
-  lst.push_back(std::move(sym));
+  SymbolNode *node = new SymbolNode{std::move(sym), {nullptr}};
+  // publish node, readers don't hold the lock while iterating
+  if (slot->tail)
+    slot->tail->next.store(node, std::memory_order_release);
+  else
+    slot->head.store(node, std::memory_order_release);
+
+  slot->tail = node;
 
   return nullptr;
 }
 
+// ContextTree
+ContextTree::ContextTree() noexcept
+  : concurrent{true}, mtx(), contexts(), ctxids() {
+  for (auto &version : nameVersions)
+    version = 0;
+}
+
+ContextTree::~ContextTree() {
+}
+
 // Context
-bool Context::isParent(const Context &ctx) const noexcept {
-  const Context *currentctx = getParent();
-  while (currentctx) {
-    if (*currentctx == ctx)
-      return true;
-  }
+Context::Context() noexcept
+  : CtxId(this, 0, true), parent{nullptr}, tree{nullptr},
+    depth{0}, lastId{0}, jump{this}, resolved{nullptr},
+    ownTree(std::make_unique<ContextTree>()) {
+  tree = ownTree.get();
+}
 
-  return false;
+Context::Context(Context *parent, uint32_t id, CreateKey) noexcept
+  : CtxId(this, id, true), parent{parent}, tree{parent->tree},
+    depth{parent->depth + 1}, lastId{0}, jump{parent}, resolved{nullptr},
+    ownTree() {
+  // equal jump lengths are merged, jumps have lengths 2^k - 1
+  Context *const parentJump = parent->jump;
+  if (parent->depth - parentJump->depth
+      == parentJump->depth - parentJump->jump->depth)
+    jump = parentJump->jump;
 }
 
-const CtxId *Context::getChildContextIdWithChild(const Context &child) const noexcept {
-  for (auto &currentChild : children) {
-    if (!currentChild->isContext())
-      continue;
+Context::~Context() {
+  delete resolved.load();
+  // contexts of the tree are destroyed before this
+  ownTree.reset();
+}
+
+std::atomic<uint32_t> &Context::getNameVersion(InternedId name) noexcept {
+  return tree->nameVersions[name % RESOLVE_VERSION_STRIPES];
+}
+
+void Context::invalidate(InternedId name) noexcept {
+  getNameVersion(name).fetch_add(1, std::memory_order_acq_rel);
+}
+
+void Context::retireSymbol(Symbol &sym) noexcept {
+  sym.retired.store(true, std::memory_order_release);
+  if (sym.getNameId() != INTERNED_NONE)
+    invalidate(sym.getNameId());
+}
+
+void Context::setConcurrent(bool concurrent) noexcept {
+  tree->concurrent = concurrent;
+}
+
+Context::ResolveCache &Context::getResolveCache() noexcept {
+  ResolveCache *result = resolved.load(std::memory_order_acquire);
+  if (result)
+    return *result;
+
+  ResolveCache *created = new ResolveCache();
+  if (resolved.compare_exchange_strong(result, created,
+        std::memory_order_acq_rel, std::memory_order_acquire))
+    return *created;
+
+  delete created;
+  return *result;
+}
+
+const Context *Context::getAncestor(uint32_t depth) const noexcept {
+  assert(depth <= this->depth);
+  const Context *result = this;
+  while (result->depth > depth)
+    result = result->jump->depth >= depth ? result->jump : result->parent;
 
-    if (dynamic_cast<Context*>(currentChild.get())->isParent(child))
-      return currentChild.get();
+  return result;
+}
+
+const CtxId *Context::getChildContextIdWithChild(const Context &child) const noexcept {
+  if (child.depth <= depth)
+    return nullptr;
+
+  const Context *result = child.getAncestor(depth + 1);
+  return result->parent == this ? result : nullptr;
+}
+
+const Context *Context::getCommonParent(const Context &ctx) const noexcept {
+  if (tree != ctx.tree)
+    return nullptr;
+
+  const Context *lhs = depth > ctx.depth ? getAncestor(ctx.depth) : this;
+  const Context *rhs = ctx.depth > depth ? ctx.getAncestor(depth) : &ctx;
+  // jumps of equal depths have equal lengths, different jump targets are
+  // below the common parent
+  while (lhs != rhs) {
+    if (lhs->jump != rhs->jump) {
+      lhs = lhs->jump;
+      rhs = rhs->jump;
+    } else {
+      lhs = lhs->parent;
+      rhs = rhs->parent;
+    }
   }
 
-  return nullptr;
+  return lhs;
 }
 
 CtxId *Context::createCtxId() noexcept {
-  auto result = std::make_unique<CtxId>(this, createId());
-  auto resultPtr = result.get();
-  children.push_back(std::move(result));
-  return resultPtr;
+  std::unique_lock<std::mutex> guard(tree->mtx, std::defer_lock);
+  if (tree->concurrent)
+    guard.lock();
+
+  return &tree->ctxids.emplace_back(this, createId());
 }
 
 Context *Context::createContext() noexcept {
-  auto result = std::unique_ptr<Context>(new Context(this, createId()));
-  auto resultPtr = result.get();
-  children.push_back(std::move(result));
-  return resultPtr;
+  std::unique_lock<std::mutex> guard(tree->mtx, std::defer_lock);
+  if (tree->concurrent)
+    guard.lock();
+
+  return &tree->contexts.emplace_back(this, createId(), CreateKey());
+}
+
+Context::CachedResolution Context::lookup(InternedId name,
+    uint32_t version) noexcept {
+  for (Context *ctx = this; ctx; ctx = ctx->getParent()) {
+    // contexts with retired symbols only don't declare name
+    const SymbolNode *first = ctx->findSymbols(name);
+    while (first && first->sym->isRetired())
+      first = first->next.load(std::memory_order_acquire);
+
+    if (first)
+      return CachedResolution{ctx, first, version};
+  }
+
+  return CachedResolution{nullptr, nullptr, version};
+}
+
+inline static Resolution _toResolution(const CtxId *ctxid,
+    Context *ctx, const SymbolNode *first) noexcept {
+  return Resolution{ctx, SymbolRange(ctx ? ctx : ctxid, first, false)};
+}
+
+Resolution Context::resolve(InternedId name) noexcept {
+  // read before lookup, symbols added during lookup invalidate the entry
+  const uint32_t version = getNameVersion(name).load(std::memory_order_acquire);
+  ResolveCache &cache = getResolveCache();
+  {
+    std::shared_lock<std::shared_mutex> guard(cache.mtx);
+    auto it = cache.entries.find(name);
+    if (it != cache.entries.end() && it->second.version == version)
+      return _toResolution(this, it->second.ctx, it->second.first);
+  }
+
+  const CachedResolution entry = lookup(name, version);
+  {
+    std::unique_lock<std::shared_mutex> guard(cache.mtx);
+    cache.entries[name] = entry;
+  }
+
+  return _toResolution(this, entry.ctx, entry.first);
+}
+
+void Context::resolveAll(const std::vector<InternedId> &names,
+    std::vector<Resolution> &result) noexcept {
+  std::vector<uint32_t> versions;
+  versions.reserve(names.size());
+  for (InternedId name : names)
+    versions.push_back(getNameVersion(name).load(std::memory_order_acquire));
+
+  ResolveCache &cache = getResolveCache();
+  std::vector<CachedResolution> entries;
+  entries.reserve(names.size());
+  std::vector<size_t> missed;
+  {
+    std::shared_lock<std::shared_mutex> guard(cache.mtx);
+    for (size_t i = 0; i < names.size(); ++i) {
+      auto it = cache.entries.find(names[i]);
+      if (it != cache.entries.end() && it->second.version == versions[i]) {
+        entries.push_back(it->second);
+        continue;
+      }
+
+      entries.push_back(CachedResolution{nullptr, nullptr, versions[i]});
+      missed.push_back(i);
+    }
+  }
+
+  if (!missed.empty()) {
+    for (size_t i : missed)
+      entries[i] = lookup(names[i], versions[i]);
+
+    std::unique_lock<std::shared_mutex> guard(cache.mtx);
+    for (size_t i : missed)
+      cache.entries[names[i]] = entries[i];
+  }
+
+  result.clear();
+  result.reserve(names.size());
+  for (const CachedResolution &entry : entries)
+    result.push_back(_toResolution(this, entry.ctx, entry.first));
+}
+
+// SymbolHistory
+template<class T>
+SymbolHistory<T>::~SymbolHistory() {
 }
 
 // SymbolHistoryType
-uint64_t SymbolHistoryType::computeType(const CtxId &id, const uint64_t baseSymType) const noexcept {
-  uint64_t result = baseSymType;
-  for (const auto &ctxid : getChangesContextIds()) {
-    if (*ctxid > id)
-      break;
-
-    const auto &typeChange = getChanges().at(ctxid);
-    if (typeChange.invert)
-      result &= ~typeChange.changeType;
-    else
-      result |= typeChange.changeType;
+SymbolHistoryType::~SymbolHistoryType() {
+}
+
+void SymbolHistoryType::changed(size_t index) noexcept {
+  // masks from index on are recomputed
+  prefixes.resize(index);
+  TypeMask mask = index == 0 ? TypeMask{~0ull, 0}
+    : prefixes.back();
+  for (size_t i = index; i < getChanges().size(); ++i) {
+    const CtxTypeChange &typeChange = std::get<1>(getChanges()[i]);
+    if (typeChange.invert) {
+      mask.keep &= ~typeChange.changeType;
+      mask.set &= ~typeChange.changeType;
+    } else {
+      mask.set |= typeChange.changeType;
+    }
+
+    prefixes.push_back(mask);
   }
+}
 
-  return result;
+uint64_t SymbolHistoryType::computeType(const CtxId &id, const uint64_t baseSymType) const noexcept {
+  if (prefixes.empty())
+    return baseSymType;
+
+  const size_t count = countChanges(id);
+  if (count == 0)
+    return baseSymType;
+
+  const TypeMask &mask = prefixes[count - 1];
+  return (baseSymType & mask.keep) | mask.set;
 }
 
 // Symbol
 Symbol::Symbol(uint64_t type, uint64_t internalId) noexcept
-  : type{type}, internalId{internalId}, symhisType() {
+  : internalId{internalId}, symhisType(), retired{false}, type{type},
+    name{INTERNED_NONE} {
 }
 
 Symbol::~Symbol() {
 }
 
 bool Symbol::is(const CtxId &id, uint64_t types) const noexcept {
-  return (symhisType.computeType(id, this->type) & types) == types;
+  return (getSymbolType(id) & types) == types;
+}
+
+uint64_t Symbol::getSymbolType(const CtxId &id) const noexcept {
+  return symhisType.computeType(id, this->type);
+}
+
+void Symbol::changeType(const CtxId &id, bool invert, uint64_t types) noexcept {
+  symhisType.addChange(id, CtxTypeChange{invert, types});
+}
+
+Symbol *Symbol::getType() noexcept {
+  return this;
+}
+
+const Symbol *Symbol::getType() const noexcept {
+  return this;
 }
 
 bool Symbol::operator ==(const Symbol &sym) const noexcept {
-  if (!getName() || !sym.getName())
+  if (name == INTERNED_NONE || sym.name == INTERNED_NONE)
       return this == &sym;
 
-  return *getName() == *sym.getName();
+  return name == sym.name;
 }
 
 Context *Symbol::getContext() noexcept {
@@ -166,8 +523,9 @@ NullSymbol::~NullSymbol() {
 }
 
 // AliasSymbol
-AliasSymbol::AliasSymbol(const std::string &name, Symbol *symtype) noexcept
-  : Symbol(ST_ALIAS | ST_NAMED), name(name), symtype{symtype} {
+AliasSymbol::AliasSymbol(InternedId name, Symbol *symtype) noexcept
+  : Symbol(ST_ALIAS | ST_NAMED), symtype{symtype} {
+  this->name = name;
 }
 
 AliasSymbol::~AliasSymbol() {
@@ -181,10 +539,6 @@ const Symbol *AliasSymbol::getType() const noexcept {
   return symtype;
 }
 
-const std::string *AliasSymbol::getName() const noexcept {
-  return &name;
-}
-
 bool AliasSymbol::operator ==(const Symbol &sym) const noexcept {
   return getType() == sym.getType();
 }
@@ -194,12 +548,109 @@ TemplateSymbol::TemplateSymbol(uint64_t type,
     std::list<AliasSymbol*> &&templSyms,
     uint64_t internalId) noexcept
   : Symbol(type | (templSyms.empty() ? 0x00 : ST_TEMPLATE), internalId),
-    templSyms(std::move(templSyms)) {
+    templSyms(std::move(templSyms)), origin{nullptr}, arguments(),
+    mtxInstances(), instances() {
 }
 
 TemplateSymbol::~TemplateSymbol() {
 }
 
+//! Template instantiations in progress on this thread (innermost last)
+static thread_local std::vector<std::tuple<
+  const TemplateSymbol* /* template */,
+  const TemplateArguments* /* args */>> _instantiations;
+
+inline static Symbol *_canonicalArgument(Symbol *sym) noexcept {
+  // aliases without type are template symbols, they are canonical
+  while (sym && (sym->getBaseSymbolType() & ST_ALIAS) && sym->getType())
+    sym = sym->getType();
+
+  return sym;
+}
+
+Symbol *TemplateSymbol::substitute(Symbol *sym,
+    const TemplateArguments &args) const noexcept {
+  auto argit = args.begin();
+  for (const AliasSymbol *templSym : templSyms) {
+    if (templSym == sym)
+      return *argit;
+
+    ++argit;
+  }
+
+  return sym;
+}
+
+Context *TemplateSymbol::createInstanceContext(Context &ctx,
+    const TemplateArguments &args) const noexcept {
+  Context *result = ctx.createContext();
+  auto argit = args.begin();
+  for (const AliasSymbol *templSym : templSyms)
+    result->addSymbol(std::make_unique<AliasSymbol>(
+          templSym->getNameId(), *(argit++)));
+
+  return result;
+}
+
+size_t TemplateSymbol::countInstances() const noexcept {
+  std::shared_lock<std::shared_mutex> lock(mtxInstances);
+  return instances.size();
+}
+
+void TemplateSymbol::canonicalize(const std::list<AliasSymbol*> &templSyms,
+    TemplateArguments &result) noexcept {
+  for (AliasSymbol *templSym : templSyms)
+    result.push_back(_canonicalArgument(templSym));
+}
+
+Symbol *TemplateSymbol::resolveTemplate(
+    std::list<AliasSymbol*> &&templSyms) noexcept {
+  TemplateArguments args;
+  canonicalize(templSyms, args);
+  return resolveTemplate(args);
+}
+
+Symbol *TemplateSymbol::resolveTemplate(
+    const TemplateArguments &args) noexcept {
+  if (args.size() != templSyms.size()
+      || std::find(args.begin(), args.end(), nullptr) != args.end())
+    return nullptr;
+
+  if (std::equal(args.begin(), args.end(), templSyms.begin()))
+    return this;
+
+  {
+    std::shared_lock<std::shared_mutex> lock(mtxInstances);
+    auto it = instances.find(args);
+    if (it != instances.end())
+      return it->second.get();
+  }
+
+  if (_instantiations.size() >= TEMPLATE_INSTANTIATION_DEPTH)
+    return nullptr;
+
+  for (const auto &instantiation : _instantiations) {
+    if (std::get<0>(instantiation) == this
+        && *std::get<1>(instantiation) == args)
+      return nullptr;
+  }
+
+  // instantiated without lock, so instantiate can resolve other templates
+  _instantiations.emplace_back(this, &args);
+  std::unique_ptr<TemplateSymbol> instance = instantiate(args);
+  _instantiations.pop_back();
+  if (!instance)
+    return nullptr;
+
+  instance->origin = this;
+  instance->arguments = args;
+
+  // if another thread was faster, its instance is used (the instance
+  // created here is discarded)
+  std::unique_lock<std::shared_mutex> lock(mtxInstances);
+  return instances.emplace(args, std::move(instance)).first->second.get();
+}
+
 // LambdaSymbol
 LambdaSymbol::LambdaSymbol(uint64_t type,
         std::list<std::unique_ptr<FunctionParamSymbol>> &&params,
@@ -223,35 +674,24 @@ const Symbol *LambdaSymbol::getType() const noexcept {
 
 // FunctionSymbol
 FunctionSymbol::FunctionSymbol(uint64_t type,
-    const std::string &name,
+    InternedId name,
     std::list<std::unique_ptr<FunctionParamSymbol>> &&params,
     Symbol *returnValue,
     std::list<AliasSymbol*> &&templSyms,
     uint64_t internalId) noexcept 
   : LambdaSymbol(type | ST_FUNCTION | ST_NAMED, std::move(params), returnValue,
-                 std::move(templSyms), internalId),
-    name(name) {
+                 std::move(templSyms), internalId) {
+  this->name = name;
 }
 
 FunctionSymbol::FunctionSymbol(uint64_t type,
-    std::string &&name,
+    InternedId name,
     std::list<std::unique_ptr<FunctionParamSymbol>> &&params,
     Symbol *returnValue,
-    std::list<AliasSymbol*> &&templSyms,
     uint64_t internalId) noexcept
   : LambdaSymbol(type | ST_FUNCTION | ST_NAMED, std::move(params), returnValue,
-                 std::move(templSyms), internalId),
-    name(std::move(name)) {
-}
-
-FunctionSymbol::FunctionSymbol(uint64_t type,
-    std::string &&name,
-    std::list<std::unique_ptr<FunctionParamSymbol>> &&params,
-    Symbol *returnValue,
-    uint64_t internalId) noexcept
-  : LambdaSymbol(type | ST_FUNCTION | ST_NAMED, std::move(params), returnValue,
-                 std::list<AliasSymbol*>(), internalId),
-    name(std::move(name)) {
+                 std::list<AliasSymbol*>(), internalId) {
+  this->name = name;
 }
 
 FunctionSymbol::~FunctionSymbol() {
@@ -265,45 +705,53 @@ const Symbol *FunctionSymbol::getType() const noexcept {
   return this;
 }
 
-const std::string *FunctionSymbol::getName() const noexcept {
-  return &name;
+bool FunctionSymbol::operator ==(const Symbol &sym) const noexcept {
+  if (!Symbol::operator ==(sym))
+    return false;
+
+  const FunctionSymbol *fnsym = dynamic_cast<const FunctionSymbol*>(&sym);
+  if (!fnsym || fnsym->getParameters().size() != getParameters().size())
+    return false;
+
+  return std::equal(getParameters().begin(), getParameters().end(),
+      fnsym->getParameters().begin(),
+      [](const std::unique_ptr<FunctionParamSymbol> &param0,
+         const std::unique_ptr<FunctionParamSymbol> &param1) {
+        return param0->getType() == param1->getType();
+      });
 }
 
-Symbol *FunctionSymbol::resolveTemplate(std::list<AliasSymbol*> &&templSyms) noexcept {
-  // TODO
-  return nullptr;
+std::unique_ptr<TemplateSymbol> FunctionSymbol::instantiate(
+    const TemplateArguments &args) noexcept {
+  std::list<std::unique_ptr<FunctionParamSymbol>> params;
+  for (const auto &param : getParameters())
+    params.push_back(std::make_unique<FunctionParamSymbol>(
+          param->getBaseSymbolType() & ST_MUTABLE, param->getNameId(),
+          substitute(param->getType(), args)));
+
+  return std::make_unique<FunctionSymbol>(type & ~ST_TEMPLATE, name,
+      std::move(params), substitute(LambdaSymbol::getType(), args),
+      getInternalId());
 }
 
 // ClassSymbol
 ClassSymbol::ClassSymbol(uint64_t type,
     Context *ctx,
-    const std::string *name,
+    InternedId name,
     std::list<AliasSymbol*> &&templSyms,
     uint64_t internalId) noexcept
   : TemplateSymbol(type | ST_CLASS, std::move(templSyms), internalId),
-    ctx{ctx},
-    name(name ? std::make_unique<std::string>(*name) : nullptr) {
-  if (this->getName())
+    objctx{nullptr}, ctx{ctx} {
+  this->name = name;
+  if (name != INTERNED_NONE)
     this->type |= ST_NAMED;
 }
 
 ClassSymbol::ClassSymbol(uint64_t type,
     Context *ctx,
-    std::string &&name,
-    std::list<AliasSymbol*> &&templSyms,
+    InternedId name,
     uint64_t internalId) noexcept
-  : TemplateSymbol(type | ST_CLASS | ST_NAMED, std::move(templSyms), internalId),
-    ctx{ctx},
-    name(std::make_unique<std::string>(std::move(name))) {
-}
-
-ClassSymbol::ClassSymbol(uint64_t type,
-    Context *ctx,
-    std::string &&name,
-    uint64_t internalId) noexcept
-  : TemplateSymbol(type | ST_CLASS | ST_NAMED, std::list<AliasSymbol*>(), internalId),
-    ctx{ctx},
-    name(std::make_unique<std::string>(std::move(name))) {
+  : ClassSymbol(type, ctx, name, std::list<AliasSymbol*>(), internalId) {
 }
 
 ClassSymbol::~ClassSymbol() {
@@ -317,10 +765,6 @@ const Symbol *ClassSymbol::getType() const noexcept {
   return this;
 }
 
-const std::string *ClassSymbol::getName() const noexcept {
-  return name.get();
-}
-
 Context *ClassSymbol::getContext() noexcept {
   return ctx;
 }
@@ -338,36 +782,30 @@ const Context *ClassSymbol::getObjectContext() const noexcept {
   return objctx;
 }
 
-Symbol *ClassSymbol::resolveTemplate(std::list<AliasSymbol*> &&templSyms) noexcept {
-  // TODO
-  return nullptr;
+std::unique_ptr<TemplateSymbol> ClassSymbol::instantiate(
+    const TemplateArguments &args) noexcept {
+  // members are looked up in the template context (parent)
+  Context *instctx = ctx ? createInstanceContext(*ctx, args) : nullptr;
+  return std::make_unique<ClassSymbol>(type & ~ST_TEMPLATE, instctx, name,
+      getInternalId());
 }
 
 // TraitSymbol
 TraitSymbol::TraitSymbol(uint64_t type,
     Context *ctx,
-    const std::string &name,
-    std::list<AliasSymbol*> &&templSyms,
-    uint64_t internalId) noexcept
-  : TemplateSymbol(type | ST_TRAIT | ST_NAMED, std::move(templSyms), internalId),
-      ctx{ctx}, name(name) {
-}
-
-TraitSymbol::TraitSymbol(uint64_t type,
-    Context *ctx,
-    std::string &&name,
+    InternedId name,
     std::list<AliasSymbol*> &&templSyms,
     uint64_t internalId) noexcept
   : TemplateSymbol(type | ST_TRAIT | ST_NAMED, std::move(templSyms), internalId),
-      ctx{ctx}, name(std::move(name)) {
+      ctx{ctx} {
+  this->name = name;
 }
 
 TraitSymbol::TraitSymbol(uint64_t type,
     Context *ctx,
-    std::string &&name,
+    InternedId name,
     uint64_t internalId) noexcept
-  : TemplateSymbol(type | ST_TRAIT | ST_NAMED, std::list<AliasSymbol*>(), internalId),
-      ctx{ctx}, name(std::move(name)) {
+  : TraitSymbol(type, ctx, name, std::list<AliasSymbol*>(), internalId) {
 }
 
 TraitSymbol::~TraitSymbol() {
@@ -381,10 +819,6 @@ const Symbol *TraitSymbol::getType() const noexcept {
   return this;
 }
 
-const std::string *TraitSymbol::getName() const noexcept {
-  return &name;
-}
-
 Context *TraitSymbol::getContext() noexcept {
   return ctx;
 }
@@ -393,35 +827,29 @@ const Context *TraitSymbol::getContext() const noexcept {
   return ctx;
 }
 
-Symbol *TraitSymbol::resolveTemplate(std::list<AliasSymbol*> &&templSyms) noexcept {
-  // TODO
-  return nullptr;
+std::unique_ptr<TemplateSymbol> TraitSymbol::instantiate(
+    const TemplateArguments &args) noexcept {
+  // members are looked up in the template context (parent)
+  Context *instctx = ctx ? createInstanceContext(*ctx, args) : nullptr;
+  return std::make_unique<TraitSymbol>(type & ~ST_TEMPLATE, instctx, name,
+      getInternalId());
 }
 
 // EnumSymbol
 EnumSymbol::EnumSymbol(uint64_t type,
-    const std::string &name,
+    InternedId name,
     Context *ctx,
     std::list<AliasSymbol*> &&templSyms,
     uint64_t internalId) noexcept
   : TemplateSymbol(type | ST_ENUM | ST_NAMED, std::move(templSyms), internalId),
-    name(name), ctx{ctx} {
+    ctx{ctx} {
+  this->name = name;
 }
 
-EnumSymbol::EnumSymbol(uint64_t type,
-   std::string &&name,
+EnumSymbol::EnumSymbol(uint64_t type, InternedId name,
     Context *ctx,
-    std::list<AliasSymbol*> &&templSyms,
     uint64_t internalId) noexcept
-  : TemplateSymbol(type | ST_ENUM, std::move(templSyms), internalId),
-    name(std::move(name)), ctx{ctx} {
-}
-
-EnumSymbol::EnumSymbol(uint64_t type, std::string &&name,
-    Context *ctx,
-    uint64_t internalId) noexcept
-  : TemplateSymbol(type | ST_ENUM, std::list<AliasSymbol*>(), internalId),
-    name(std::move(name)), ctx{ctx} {
+  : EnumSymbol(type, name, ctx, std::list<AliasSymbol*>(), internalId) {
 }
 
 EnumSymbol::~EnumSymbol() {
@@ -435,13 +863,20 @@ const Symbol *EnumSymbol::getType() const noexcept {
   return this;
 }
 
-const std::string *EnumSymbol::getName() const noexcept {
-  return &name;
+Context *EnumSymbol::getContext() noexcept {
+  return ctx;
 }
 
-Symbol *EnumSymbol::resolveTemplate(std::list<AliasSymbol*> &&templSyms) noexcept {
-  // TODO
-  return nullptr;
+const Context *EnumSymbol::getContext() const noexcept {
+  return ctx;
+}
+
+std::unique_ptr<TemplateSymbol> EnumSymbol::instantiate(
+    const TemplateArguments &args) noexcept {
+  // members are looked up in the template context (parent)
+  Context *instctx = ctx ? createInstanceContext(*ctx, args) : nullptr;
+  return std::make_unique<EnumSymbol>(type & ~ST_TEMPLATE, name, instctx,
+      getInternalId());
 }
 
 // ObjectSymbol
@@ -472,39 +907,34 @@ const Context *ObjectSymbol::getContext() const noexcept {
 
 // VariableSymbol
 VariableSymbol::VariableSymbol(uint64_t type,
-    const std::string &name, Symbol *objType,
+    InternedId name, Symbol *objType,
     uint64_t internalId) noexcept
-  : ObjectSymbol(type | ST_VARIABLE | ST_NAMED, objType, internalId),
-    name(name) {
+  : ObjectSymbol(type | ST_VARIABLE | ST_NAMED, objType, internalId) {
+  this->name = name;
 }
 
-VariableSymbol::VariableSymbol(uint64_t type,
-    std::string &&name, Symbol *objType,
-    uint64_t internalId) noexcept
-  : ObjectSymbol(type | ST_VARIABLE | ST_NAMED, objType, internalId),
-    name(std::move(name)) {
+VariableSymbol::~VariableSymbol() {
 }
 
-VariableSymbol::~VariableSymbol() {
+// FunctionParamSymbol
+FunctionParamSymbol::FunctionParamSymbol(uint64_t type,
+    InternedId name, Symbol *objType) noexcept
+  : VariableSymbol(type, name, objType) {
 }
 
-const std::string *VariableSymbol::getName() const noexcept {
-  return &name;
+FunctionParamSymbol::~FunctionParamSymbol() {
 }
 
 // NamespaceSymbol
 NamespaceSymbol::NamespaceSymbol(uint64_t type,
-    const std::string &name, Context *ctx) noexcept
-  : Symbol(type | ST_MODULE | ST_NAMED), name(name), ctx{ctx} {
+    InternedId name, Context *ctx) noexcept
+  : Symbol(type | ST_MODULE | ST_NAMED), ctx{ctx} {
+  this->name = name;
 }
 
 NamespaceSymbol::~NamespaceSymbol() {
 }
 
-const std::string *NamespaceSymbol::getName() const noexcept {
-  return &name;
-}
-
 Context *NamespaceSymbol::getContext() noexcept {
   return ctx;
 }
@@ -512,3 +942,56 @@ Context *NamespaceSymbol::getContext() noexcept {
 const Context *NamespaceSymbol::getContext() const noexcept {
   return ctx;
 }
+
+// Semantic
+Semantic::Semantic(uint64_t type, const Expr *expr, Semantic *parent) noexcept
+  : type{type}, expr{expr}, parent{parent}, sym{nullptr}, children() {
+}
+
+Semantic::~Semantic() {
+}
+
+bool Semantic::addChild(const std::string &name, Semantic *child) noexcept {
+  return children.emplace(name, child).second;
+}
+
+Semantic *Semantic::getChild(const std::string &name) const noexcept {
+  auto it = children.find(name);
+  if (it == children.end())
+    return nullptr;
+
+  return it->second;
+}
+
+void Semantic::removeChild(const Semantic *child) noexcept {
+  for (auto it = children.begin(); it != children.end(); ++it) {
+    if (it->second == child) {
+      children.erase(it);
+      return;
+    }
+  }
+}
+
+// SafeSemantic
+SafeSemantic::SafeSemantic(uint64_t type, const Expr *expr,
+    Semantic *parent) noexcept
+  : Semantic(type, expr, parent), mtx() {
+}
+
+SafeSemantic::~SafeSemantic() {
+}
+
+bool SafeSemantic::addChild(const std::string &name, Semantic *child) noexcept {
+  std::lock_guard<std::mutex> guard(mtx);
+  return Semantic::addChild(name, child);
+}
+
+Semantic *SafeSemantic::getChild(const std::string &name) const noexcept {
+  std::lock_guard<std::mutex> guard(mtx);
+  return Semantic::getChild(name);
+}
+
+void SafeSemantic::removeChild(const Semantic *child) noexcept {
+  std::lock_guard<std::mutex> guard(mtx);
+  Semantic::removeChild(child);
+}
@@ -0,0 +1,1028 @@
+#include "pfederc/semantics.hpp"
+using namespace pfederc;
+
+//! Definitions in program and module scope of the current build
+typedef std::unordered_map<const Expr*, DeclarationPlan*> _Plans;
+
+//! Declaration scope of a task
+struct _Scope {
+  TypeAnalyzer *analyzer;
+  Context *ctx;
+  Semantic *semantic;
+  std::string prefix; //!< mangle prefix of declarations in scope
+  //! Record of the analyzed definition in program or module scope
+  DeclarationRecord *record = nullptr;
+  //! Set in program and module scope
+  const _Plans *plans = nullptr;
+};
+
+static void _spawnDefinition(TaskScheduler &scheduler, const _Scope &scope,
+    const Expr &expr) noexcept;
+
+/*!\brief Spawns the definitions of a program or module
+ *
+ * Modules are declared first in program order. Other definitions are
+ * spawned by level of their dependency graph, highest level first: tasks
+ * spawned before are run last by their worker, so dependencies are usually
+ * declared before the definitions using them (no suspension needed).
+ */
+template<class T>
+inline static void _spawnDefinitions(TaskScheduler &scheduler,
+    const _Scope &scope, const T &exprs) noexcept {
+  std::vector<const Expr*> defs;
+  for (const auto &expr : exprs) {
+    if (*expr == ExprType::EXPR_MOD)
+      _spawnDefinition(scheduler, scope, *expr);
+    else
+      defs.push_back(expr.get());
+  }
+
+  const DeclarationGraph graph(std::move(defs));
+  const auto &levels = graph.getLevels();
+  for (auto level = levels.rbegin(); level != levels.rend(); ++level) {
+    for (auto component = level->rbegin(); component != level->rend();
+        ++component) {
+      const std::vector<size_t> &members = graph.getMembers(*component);
+      for (auto def = members.rbegin(); def != members.rend(); ++def) {
+        const Expr &expr = graph.getDefinition(*def);
+        if (!scope.plans) {
+          _spawnDefinition(scheduler, scope, expr);
+          continue;
+        }
+
+        // definitions in program and module scope are recorded
+        auto plan = scope.plans->find(&expr);
+        if (plan == scope.plans->end() || plan->second->reused)
+          continue;
+
+        _Scope defscope = scope;
+        defscope.record = plan->second->record;
+        defscope.plans = nullptr;
+        _spawnDefinition(scheduler, defscope, expr);
+      }
+    }
+  }
+}
+
+inline static std::string _toString(const Expr &expr, const Token &tok) noexcept {
+  return tok.toString(expr.getLexer());
+}
+
+/*!\brief Runs task of definition expr in a trace span, if tracing
+ * \param expr
+ * \param task
+ */
+static TaskFunction _traced(const Expr &expr, TaskFunction &&task) noexcept {
+  if (!instrumentation::isTracing())
+    return std::move(task);
+
+  const InternedId nameId = getDeclaredName(expr);
+  std::string name;
+  if (nameId != INTERNED_NONE)
+    name = internedString(nameId);
+  else if (expr == ExprType::EXPR_TRAITIMPL)
+    name = _toString(expr,
+        dynamic_cast<const TraitImplExpr&>(expr).getIdentifier()) + ':';
+
+  return [&expr, name, task](TaskScheduler &scheduler) {
+      ScopedSpan span("semantic", name, expr.getLexer().getFilePath());
+      return task(scheduler);
+    };
+}
+
+//! Identifier tokens are interned by the lexer, no allocation
+inline static InternedId _toId(const Expr &expr, const Token &tok) noexcept {
+  return tok.toInternedId(expr.getLexer());
+}
+
+inline static void _addError(const _Scope &scope, SemanticErrorCode code,
+    const Expr &expr) noexcept {
+  scope.analyzer->addError(expr.getLexer(),
+      std::make_unique<SemanticError>(LVL_ERROR, code, expr.getPosition()));
+  if (scope.record) {
+    std::lock_guard<std::mutex> guard(scope.record->mtx);
+    scope.record->failed = true;
+  }
+}
+
+inline static bool _isTypeSymbol(const Context &ctx, const Symbol &sym) noexcept {
+  return sym.getSymbolType(ctx)
+    & (ST_CLASS | ST_TRAIT | ST_ENUM | ST_ALIAS | ST_MODULE);
+}
+
+//! Looks up type name in ctx (and its parents, if parents is true)
+static Symbol *_lookupType(Context *ctx, InternedId name,
+    bool parents) noexcept {
+  if (!parents) {
+    for (Symbol *sym : ctx->getSymbols(name, false)) {
+      if (_isTypeSymbol(*ctx, *sym))
+        return sym;
+    }
+
+    return nullptr;
+  }
+
+  // contexts not declaring name are skipped by the resolution cache
+  while (ctx) {
+    const Resolution resolution = ctx->resolve(name);
+    if (!resolution.ctx)
+      return nullptr;
+
+    for (Symbol *sym : resolution.symbols) {
+      if (_isTypeSymbol(*resolution.ctx, *sym))
+        return sym;
+    }
+
+    ctx = resolution.ctx->getParent();
+  }
+
+  return nullptr;
+}
+
+//! Resolves type name in scope, afterwards in namespace std
+static bool _resolveName(const _Scope &scope, InternedId name,
+    Symbol *&result, InternedId &missing) noexcept {
+  Symbol *sym = _lookupType(scope.ctx, name, true);
+  if (!sym)
+    sym = _lookupType(&scope.analyzer->getStandardContext(), name, false);
+
+  if (!sym) {
+    missing = name;
+    return false;
+  }
+
+  // aliases without type are templates
+  result = sym->is(*scope.ctx, ST_ALIAS) && sym->getType() ?
+    sym->getType() : sym;
+  return true;
+}
+
+/*!\return Returns true, if type could be resolved (result is set),
+ * otherwise false (missing is set to the missing name).
+ *
+ * Only identifiers, module paths and templates are resolved, other type
+ * expressions are resolved to the null symbol.
+ */
+static bool _resolveType(const _Scope &scope, const Expr &type,
+    Symbol *&result, InternedId &missing) noexcept {
+  TypeAnalyzer &analyzer = *scope.analyzer;
+  if (isTokenExpr(type, TokenType::TOK_ID))
+    return _resolveName(scope,
+        _toId(type, dynamic_cast<const TokenExpr&>(type).getToken()),
+        result, missing);
+
+  if (isBiOpExpr(type, TokenType::TOK_OP_MEM)) {
+    const BiOpExpr &biop = dynamic_cast<const BiOpExpr&>(type);
+    Symbol *lhs = nullptr;
+    if (!_resolveType(scope, biop.getLeft(), lhs, missing))
+      return false;
+
+    if (!lhs->getContext() || !isTokenExpr(biop.getRight(), TokenType::TOK_ID)) {
+      result = &analyzer.getNullSymbol();
+      return true;
+    }
+
+    const InternedId name = _toId(type,
+        dynamic_cast<const TokenExpr&>(biop.getRight()).getToken());
+    result = _lookupType(lhs->getContext(), name, false);
+    if (!result) {
+      missing = name;
+      return false;
+    }
+
+    return true;
+  }
+
+  if (isBiOpExpr(type, TokenType::TOK_OP_TEMPL_BRACKET_OPEN))
+    return _resolveType(scope,
+        dynamic_cast<const BiOpExpr&>(type).getLeft(), result, missing);
+
+  result = &analyzer.getNullSymbol();
+  return true;
+}
+
+/*!\return Returns false, if the task has to be suspended, otherwise true
+ * (types are resolved or errors were reported).
+ * \param scheduler
+ * \param scope
+ * \param types Optional type expressions
+ * \param result Resolved types, null symbol for missing type expressions
+ */
+static bool _resolveTypes(TaskScheduler &scheduler, const _Scope &scope,
+    const std::vector<const Expr*> &types,
+    std::vector<Symbol*> &result) noexcept {
+  result.clear();
+  for (const Expr *type : types) {
+    Symbol *sym = nullptr;
+    InternedId missing = INTERNED_NONE;
+    if (!type) {
+      result.push_back(&scope.analyzer->getNullSymbol());
+      continue;
+    }
+
+    if (_resolveType(scope, *type, sym, missing)) {
+      result.push_back(sym);
+      continue;
+    }
+
+    if (!scheduler.isStalled()) {
+      scheduler.suspend(internedString(missing));
+      return false;
+    }
+
+    _addError(scope, SemanticErrorCode::SMT_ERR_UNKNOWN_TYPE, *type);
+    result.push_back(&scope.analyzer->getNullSymbol());
+  }
+
+  return true;
+}
+
+//! Returns true, if expr0 is positioned before expr1
+inline static bool _isBefore(const Expr &expr0, const Expr &expr1) noexcept {
+  if (&expr0.getLexer() != &expr1.getLexer())
+    return expr0.getLexer().getFilePath() < expr1.getLexer().getFilePath();
+
+  return expr0.getPosition().startIndex < expr1.getPosition().startIndex;
+}
+
+/*!\return Returns the semantic stored with mangle, nullptr if another
+ * definition with the same mangle exists (an error is reported).
+ */
+static Semantic *_addSemantic(const _Scope &scope, const std::string &name,
+    const std::string &mangle, std::unique_ptr<Semantic> &&semantic) noexcept {
+  const Expr &expr = *semantic->getExpression();
+  bool inserted = false;
+  Semantic *result = scope.analyzer->addSemantic(mangle,
+      std::move(semantic), inserted);
+  if (!inserted) {
+    // the later definition is reported, independent of scheduling
+    const Expr &existing = *result->getExpression();
+    _addError(scope, SemanticErrorCode::SMT_ERR_REDEFINITION,
+        _isBefore(existing, expr) ? expr : existing);
+    return nullptr;
+  }
+
+  if (scope.record) {
+    std::lock_guard<std::mutex> guard(scope.record->mtx);
+    scope.record->semantics.emplace_back(mangle, SIZE_MAX);
+  }
+
+  scope.semantic->addChild(name, result);
+  return result;
+}
+
+//! Adds sym to the scope context and resumes tasks waiting for name
+static void _declare(TaskScheduler &scheduler, const _Scope &scope,
+    std::unique_ptr<Symbol> &&sym, Semantic *semantic) noexcept {
+  const InternedId name = sym->getNameId();
+  Symbol *symPtr = sym.get();
+  if (scope.ctx->addSymbol(std::move(sym)))
+    symPtr = nullptr; // overloads and redefinitions are discarded
+
+  if (symPtr && scope.record) {
+    std::lock_guard<std::mutex> guard(scope.record->mtx);
+    scope.record->symbols.push_back(symPtr);
+  }
+
+  if (semantic)
+    semantic->setSymbol(symPtr);
+
+  scheduler.notify(internedString(name));
+}
+
+/*!\brief Declares template parameters as aliases without type
+ */
+static std::list<AliasSymbol*> _declareTemplates(Context &ctx,
+    const TemplateDecls &templs) noexcept {
+  std::list<AliasSymbol*> result;
+  for (const auto &templ : templs) {
+    auto alias = std::make_unique<AliasSymbol>(
+        _toId(*templ->id, templ->id->getToken()), nullptr);
+    AliasSymbol *aliasPtr = alias.get();
+    if (!ctx.addSymbol(std::move(alias)))
+      result.push_back(aliasPtr);
+  }
+
+  return result;
+}
+
+static void _spawnModule(TaskScheduler &scheduler, const _Scope &scope,
+    const ModExpr &expr) noexcept {
+  const InternedId nameId = _toId(expr, expr.getIdentifier());
+  const std::string &name = internedString(nameId);
+  const std::string mangle = scope.prefix + name;
+
+  // modules can be continued, the context of the first definition is used
+  Context *modctx = scope.ctx->createContext();
+  auto nmsp = std::make_unique<NamespaceSymbol>(0, nameId, modctx);
+  auto semantic = std::make_unique<SafeSemantic>(ST_MODULE, &expr,
+      scope.semantic);
+
+  bool inserted = false;
+  Semantic *modsemantic = scope.analyzer->addSemantic(mangle,
+      std::move(semantic), inserted);
+  if (!inserted && !(modsemantic->getType() & ST_MODULE)) {
+    _addError(scope, SemanticErrorCode::SMT_ERR_REDEFINITION, expr);
+    return;
+  }
+
+  // module of a previous build
+  if (scope.analyzer->visitScope(mangle) && !inserted)
+    modsemantic->setExpression(&expr);
+
+  if (inserted) {
+    scope.semantic->addChild(name, modsemantic);
+    Symbol *nmspPtr = nmsp.get();
+    if (scope.ctx->addSymbol(std::move(nmsp)))
+      modsemantic->setSymbol(nullptr);
+    else
+      modsemantic->setSymbol(nmspPtr);
+
+    scheduler.notify(name);
+  }
+
+  Context *ctx = modsemantic->getSymbol() ?
+    modsemantic->getSymbol()->getContext() : modctx;
+  _spawnDefinitions(scheduler,
+      _Scope{scope.analyzer, ctx, modsemantic, mangle + '.', nullptr,
+        scope.plans},
+      expr.getExpressions());
+}
+
+static void _spawnClass(TaskScheduler &scheduler, const _Scope &scope,
+    const ClassExpr &expr) noexcept {
+  const InternedId nameId = _toId(expr, expr.getIdentifier());
+  const std::string &name = internedString(nameId);
+  const std::string mangle = scope.prefix + name;
+
+  Context *clctx = scope.ctx->createContext();
+  auto templs = _declareTemplates(*clctx, expr.getTemplates());
+  auto cl = std::make_unique<ClassSymbol>(0, clctx, nameId,
+      std::move(templs));
+
+  Semantic *semantic = _addSemantic(scope, name, mangle,
+      std::make_unique<SafeSemantic>(ST_CLASS, &expr, scope.semantic));
+  _declare(scheduler, scope, std::move(cl), semantic);
+  if (!semantic)
+    return;
+
+  const _Scope clscope{scope.analyzer, clctx, semantic, mangle + '.',
+    scope.record};
+  _spawnDefinitions(scheduler, clscope, expr.getConstructorAttributes());
+  _spawnDefinitions(scheduler, clscope, expr.getAttributes());
+  _spawnDefinitions(scheduler, clscope, expr.getFunctions());
+}
+
+static void _spawnTrait(TaskScheduler &scheduler, const _Scope &scope,
+    const TraitExpr &expr) noexcept {
+  const InternedId nameId = _toId(expr, expr.getIdentifier());
+  const std::string &name = internedString(nameId);
+  const std::string mangle = scope.prefix + name;
+
+  Context *trctx = scope.ctx->createContext();
+  auto templs = _declareTemplates(*trctx, expr.getTemplates());
+  auto tr = std::make_unique<TraitSymbol>(0, trctx, nameId,
+      std::move(templs));
+
+  Semantic *semantic = _addSemantic(scope, name, mangle,
+      std::make_unique<SafeSemantic>(ST_TRAIT, &expr, scope.semantic));
+  _declare(scheduler, scope, std::move(tr), semantic);
+  if (!semantic)
+    return;
+
+  const _Scope trscope{scope.analyzer, trctx, semantic, mangle + '.',
+    scope.record};
+  // inherited traits are checked only
+  std::vector<const Expr*> inherited;
+  for (const auto &impltrait : expr.getInheritedTraits())
+    inherited.push_back(impltrait.get());
+
+  scheduler.spawn([trscope, inherited](TaskScheduler &scheduler) {
+      std::vector<Symbol*> syms;
+      return _resolveTypes(scheduler, trscope, inherited, syms) ?
+        TaskStatus::DONE : TaskStatus::SUSPENDED;
+    });
+
+  _spawnDefinitions(scheduler, trscope, expr.getFunctions());
+}
+
+static void _spawnTraitImpl(TaskScheduler &scheduler, const _Scope &scope,
+    const TraitImplExpr &expr) noexcept {
+  Context *implctx = scope.ctx->createContext();
+  _declareTemplates(*implctx, expr.getTemplates());
+  const _Scope implscope{scope.analyzer, implctx, scope.semantic, "",
+    scope.record};
+
+  scheduler.spawn(_traced(expr,
+        [scope, implscope, &expr](TaskScheduler &scheduler) {
+      const InternedId clname = _toId(expr, expr.getIdentifier());
+      Symbol *cl = nullptr;
+      InternedId missing = INTERNED_NONE;
+      if (!_resolveName(implscope, clname, cl, missing)) {
+        if (!scheduler.isStalled()) {
+          scheduler.suspend(internedString(missing));
+          return TaskStatus::SUSPENDED;
+        }
+
+        _addError(scope, SemanticErrorCode::SMT_ERR_UNKNOWN_TYPE, expr);
+      }
+
+      std::vector<Symbol*> syms;
+      if (!_resolveTypes(scheduler, implscope,
+            {&expr.getImplementedTrait()}, syms))
+        return TaskStatus::SUSPENDED;
+
+      const std::string name = internedString(clname) + ':'
+        + expr.getImplementedTrait().toString();
+      const std::string mangle = scope.prefix + name;
+      Semantic *semantic = _addSemantic(scope, name, mangle,
+          std::make_unique<SafeSemantic>(ST_CLASS | ST_TRAIT, &expr,
+            scope.semantic));
+      if (!semantic)
+        return TaskStatus::DONE;
+
+      _spawnDefinitions(scheduler,
+          _Scope{implscope.analyzer, implscope.ctx, semantic, mangle + '.',
+            implscope.record},
+          expr.getFunctions());
+      return TaskStatus::DONE;
+    }));
+}
+
+static void _spawnEnum(TaskScheduler &scheduler, const _Scope &scope,
+    const EnumExpr &expr) noexcept {
+  const InternedId nameId = _toId(expr, expr.getIdentifier());
+  const std::string &name = internedString(nameId);
+  const std::string mangle = scope.prefix + name;
+
+  Context *enctx = scope.ctx->createContext();
+  auto templs = _declareTemplates(*enctx, expr.getTemplates());
+  auto en = std::make_unique<EnumSymbol>(0, nameId, enctx,
+      std::move(templs));
+
+  Semantic *semantic = _addSemantic(scope, name, mangle,
+      std::make_unique<Semantic>(ST_ENUM, &expr, scope.semantic));
+  _declare(scheduler, scope, std::move(en), semantic);
+}
+
+static void _spawnFunction(TaskScheduler &scheduler, const _Scope &scope,
+    const FuncExpr &expr) noexcept {
+  Context *fnctx = scope.ctx->createContext();
+  auto templs = _declareTemplates(*fnctx, expr.getTemplates());
+  const _Scope fnscope{scope.analyzer, fnctx, scope.semantic, scope.prefix,
+    scope.record};
+
+  // template aliases are moved into the task (shared, the task can be
+  // copied)
+  auto sharedTempls = std::make_shared<std::list<AliasSymbol*>>(
+      std::move(templs));
+  scheduler.spawn(_traced(expr,
+        [scope, fnscope, sharedTempls, &expr](TaskScheduler &scheduler) {
+      std::vector<const Expr*> types;
+      for (const auto &param : expr.getParameters())
+        types.push_back(std::get<2>(*param).get());
+      types.push_back(expr.getReturn());
+
+      std::vector<Symbol*> syms;
+      if (!_resolveTypes(scheduler, fnscope, types, syms))
+        return TaskStatus::SUSPENDED;
+
+      const InternedId name = _toId(expr, expr.getIdentifier());
+      std::string mangle = scope.prefix + internedString(name) + '(';
+      std::list<std::unique_ptr<FunctionParamSymbol>> params;
+      for (size_t i = 0; i < expr.getParameters().size(); ++i) {
+        const FuncParameter &param = *expr.getParameters()[i];
+        if (i != 0)
+          mangle += ',';
+
+        mangle += types[i] ? types[i]->toString() : std::string();
+
+        const Token *tokId = std::get<0>(param);
+        params.push_back(std::make_unique<FunctionParamSymbol>(
+              std::get<1>(param) ? static_cast<uint64_t>(ST_MUTABLE) : 0,
+              tokId ? _toId(expr, *tokId) : INTERNED_NONE, syms[i]));
+      }
+      mangle += ')';
+
+      auto fn = std::make_unique<FunctionSymbol>(0, name,
+          std::move(params), syms.back(),
+          std::list<AliasSymbol*>(*sharedTempls));
+      Semantic *semantic = _addSemantic(scope, mangle.substr(
+            scope.prefix.length()), mangle,
+          std::make_unique<Semantic>(ST_FUNCTION, &expr, scope.semantic));
+      _declare(scheduler, scope, std::move(fn), semantic);
+      return TaskStatus::DONE;
+    }));
+}
+
+/*!\brief Spawns task for variable declaration expr (x := ..., x : T = ...,
+ * x : T)
+ */
+static void _spawnVariable(TaskScheduler &scheduler, const _Scope &scope,
+    const BiOpExpr &expr) noexcept {
+  const Expr *decl = &expr;
+  if (expr.getOperatorType() == TokenType::TOK_OP_ASG
+      || expr.getOperatorType() == TokenType::TOK_OP_ASG_DCL)
+    decl = &expr.getLeft();
+
+  const Expr *type = nullptr;
+  const Expr *id = decl;
+  if (isBiOpExpr(*decl, TokenType::TOK_OP_DCL)) {
+    id = &dynamic_cast<const BiOpExpr*>(decl)->getLeft();
+    type = &dynamic_cast<const BiOpExpr*>(decl)->getRight();
+  } else if (expr.getOperatorType() != TokenType::TOK_OP_ASG_DCL) {
+    return; // no declaration
+  }
+
+  if (!isTokenExpr(*id, TokenType::TOK_ID))
+    return;
+
+  scheduler.spawn(_traced(expr,
+        [scope, &expr, id, type](TaskScheduler &scheduler) {
+      std::vector<Symbol*> syms;
+      if (!_resolveTypes(scheduler, scope, {type}, syms))
+        return TaskStatus::SUSPENDED;
+
+      const InternedId nameId = _toId(*id,
+          dynamic_cast<const TokenExpr*>(id)->getToken());
+      const std::string &name = internedString(nameId);
+      Semantic *semantic = _addSemantic(scope, name, scope.prefix + name,
+          std::make_unique<Semantic>(ST_VARIABLE, &expr, scope.semantic));
+      _declare(scheduler, scope,
+          std::make_unique<VariableSymbol>(0, nameId, syms.front()), semantic);
+      return TaskStatus::DONE;
+    }));
+}
+
+static void _spawnDefinition(TaskScheduler &scheduler, const _Scope &scope,
+    const Expr &expr) noexcept {
+  if (scope.analyzer->isErrorLimitReached())
+    return;
+
+  switch (expr.getType()) {
+  case ExprType::EXPR_MOD:
+    // module scopes are declared before tasks run (modules are only in
+    // program and module scope)
+    _spawnModule(scheduler, scope, dynamic_cast<const ModExpr&>(expr));
+    break;
+  case ExprType::EXPR_CLASS:
+    scheduler.spawn(_traced(expr, [scope, &expr](TaskScheduler &scheduler) {
+        _spawnClass(scheduler, scope, dynamic_cast<const ClassExpr&>(expr));
+        return TaskStatus::DONE;
+      }));
+    break;
+  case ExprType::EXPR_TRAIT:
+    scheduler.spawn(_traced(expr, [scope, &expr](TaskScheduler &scheduler) {
+        _spawnTrait(scheduler, scope, dynamic_cast<const TraitExpr&>(expr));
+        return TaskStatus::DONE;
+      }));
+    break;
+  case ExprType::EXPR_TRAITIMPL:
+    _spawnTraitImpl(scheduler, scope, dynamic_cast<const TraitImplExpr&>(expr));
+    break;
+  case ExprType::EXPR_ENUM:
+    scheduler.spawn(_traced(expr, [scope, &expr](TaskScheduler &scheduler) {
+        _spawnEnum(scheduler, scope, dynamic_cast<const EnumExpr&>(expr));
+        return TaskStatus::DONE;
+      }));
+    break;
+  case ExprType::EXPR_FUNC:
+    _spawnFunction(scheduler, scope, dynamic_cast<const FuncExpr&>(expr));
+    break;
+  case ExprType::EXPR_BIOP:
+    _spawnVariable(scheduler, scope, dynamic_cast<const BiOpExpr&>(expr));
+    break;
+  default:
+    // statements and use expressions don't declare anything
+    break;
+  }
+}
+
+//! Appends expr and its children in preorder to result
+static void _preorder(const Expr &expr,
+    std::vector<const Expr*> &result) noexcept {
+  result.push_back(&expr);
+  expr.forEachChild([&result](const Expr &child) {
+      _preorder(child, result);
+    });
+}
+
+//! Returns true, if expr is analyzed by _spawnDefinition
+inline static bool _isDefinition(const Expr &expr) noexcept {
+  switch (expr.getType()) {
+  case ExprType::EXPR_CLASS:
+  case ExprType::EXPR_TRAIT:
+  case ExprType::EXPR_TRAITIMPL:
+  case ExprType::EXPR_ENUM:
+  case ExprType::EXPR_FUNC:
+  case ExprType::EXPR_BIOP:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/*!\brief Creates plans for the definitions in exprs (program or module
+ * scope) and its modules
+ * \param prefix Mangle prefix of the scope
+ * \param exprs
+ * \param plans
+ * \param scopes Mangles of modules are added
+ * \param counts Number of plans per fingerprint in a scope
+ */
+static void _collectPlans(const std::string &prefix, const Exprs &exprs,
+    std::vector<DeclarationPlan> &plans, std::set<std::string> &scopes,
+    std::unordered_map<std::string, size_t> &counts) noexcept {
+  for (const auto &expr : exprs) {
+    if (*expr == ExprType::EXPR_MOD) {
+      const ModExpr &mod = dynamic_cast<const ModExpr&>(*expr);
+      const std::string mangle = prefix
+        + internedString(_toId(mod, mod.getIdentifier()));
+      scopes.insert(mangle);
+      _collectPlans(mangle + '.', mod.getExpressions(), plans, scopes, counts);
+      continue;
+    }
+
+    if (!_isDefinition(*expr))
+      continue;
+
+    const uint64_t fingerprint = std::hash<std::string>{}(expr->toString());
+    std::string key = prefix + '#' + std::to_string(fingerprint);
+    key += '#' + std::to_string(counts[key]++);
+
+    std::vector<InternedId> refs;
+    collectReferences(*expr, refs);
+    std::sort(refs.begin(), refs.end());
+    refs.erase(std::unique(refs.begin(), refs.end()), refs.end());
+
+    plans.push_back(DeclarationPlan{prefix, std::move(key), expr.get(),
+        fingerprint, getDeclaredName(*expr), std::move(refs), nullptr, false});
+  }
+}
+
+//! Returns the name of a unit, which isn't the main unit
+inline static std::string _unitName(const BuildSemanticParam &param) noexcept {
+  const ProgramExpr &program = *param.program;
+  return program.getProgramName() ?
+    _toString(program, *program.getProgramName()) : param.name;
+}
+
+// TypeAnalyzer
+TypeAnalyzer::TypeAnalyzer(size_t threads) noexcept
+  : threads{std::max<size_t>(threads, 1)}, mainContext(),
+    stdContext{addStandardLibrary(mainContext)},
+    nullSymbol(), root(ST_MODULE, nullptr, nullptr),
+    errorLimit{nullptr}, analyzedDeclarations{0}, reusedDeclarations{0} {
+}
+
+TypeAnalyzer::~TypeAnalyzer() {
+}
+
+void TypeAnalyzer::retireDeclaration(DeclarationRecord &record) noexcept {
+  for (Symbol *sym : record.symbols)
+    mainContext.retireSymbol(*sym);
+
+  // parents are removed after their children
+  for (const auto &entry : record.semantics) {
+    auto it = semantics.find(std::get<0>(entry));
+    if (it != semantics.end() && it->second->getParent())
+      it->second->getParent()->removeChild(it->second.get());
+  }
+
+  for (const auto &entry : record.semantics)
+    semantics.erase(std::get<0>(entry));
+
+  record.symbols.clear();
+  record.semantics.clear();
+  record.failed = false;
+}
+
+void TypeAnalyzer::removeScopes(const std::set<std::string> &stale) noexcept {
+  // nested modules first
+  std::vector<const std::string*> mangles;
+  for (const std::string &mangle : stale)
+    mangles.push_back(&mangle);
+
+  std::sort(mangles.begin(), mangles.end(),
+      [](const std::string *mangle0, const std::string *mangle1) {
+        return mangle0->length() > mangle1->length();
+      });
+
+  for (const std::string *mangle : mangles) {
+    auto it = semantics.find(*mangle);
+    Semantic &semantic = *it->second;
+    if (semantic.getSymbol())
+      mainContext.retireSymbol(*semantic.getSymbol());
+
+    if (semantic.getParent())
+      semantic.getParent()->removeChild(&semantic);
+
+    semantics.erase(it);
+  }
+}
+
+void TypeAnalyzer::planDeclarations(std::vector<DeclarationPlan> &plans,
+    const std::set<std::string> &scopes) noexcept {
+  // names, whose declarations are analyzed again
+  std::unordered_set<InternedId> dirty;
+  std::vector<InternedId> queue;
+  auto markDirty = [&dirty, &queue](InternedId name) {
+      if (name != INTERNED_NONE && dirty.insert(name).second)
+        queue.push_back(name);
+    };
+
+  // units and modules, which were removed or have no context, and modules
+  // in them (mangles of parents are smaller)
+  std::set<std::string> stale;
+  for (const auto &entry : semantics) {
+    const std::string &mangle = entry.first;
+    if (!(entry.second->getType() & ST_MODULE))
+      continue;
+
+    bool isStale = !scopes.count(mangle) || !entry.second->getSymbol();
+    for (size_t i = mangle.find('.'); !isStale && i != std::string::npos;
+        i = mangle.find('.', i + 1))
+      isStale = stale.count(mangle.substr(0, i));
+
+    if (isStale) {
+      stale.insert(mangle);
+      markDirty(intern(mangle.substr(mangle.rfind('.') + 1)));
+    }
+  }
+
+  // removed definitions
+  std::unordered_set<std::string> keys;
+  for (const DeclarationPlan &plan : plans)
+    keys.insert(plan.key);
+
+  for (auto it = declarations.begin(); it != declarations.end();) {
+    if (keys.count(it->first)) {
+      ++it;
+      continue;
+    }
+
+    markDirty(it->second->name);
+    retireDeclaration(*it->second);
+    it = declarations.erase(it);
+  }
+
+  // definitions using or declaring a name
+  std::unordered_map<InternedId, std::vector<size_t>> users;
+  for (size_t i = 0; i < plans.size(); ++i) {
+    DeclarationPlan &plan = plans[i];
+    auto it = declarations.find(plan.key);
+    plan.record = it != declarations.end() ? it->second.get() : nullptr;
+    plan.reused = plan.record && !plan.record->failed
+      && !stale.count(plan.prefix.substr(0, plan.prefix.length() - 1));
+    if (plan.reused) {
+      for (const auto &entry : plan.record->semantics)
+        plan.reused = plan.reused && std::get<1>(entry) != SIZE_MAX;
+    }
+
+    if (!plan.reused) {
+      markDirty(plan.name);
+      continue;
+    }
+
+    users[plan.name].push_back(i);
+    for (InternedId ref : plan.references)
+      users[ref].push_back(i);
+  }
+
+  while (!queue.empty()) {
+    const InternedId name = queue.back();
+    queue.pop_back();
+    auto it = users.find(name);
+    if (it == users.end())
+      continue;
+
+    for (size_t i : it->second) {
+      if (plans[i].reused) {
+        plans[i].reused = false;
+        markDirty(plans[i].name);
+      }
+    }
+  }
+
+  analyzedDeclarations = reusedDeclarations = 0;
+  std::vector<const Expr*> exprs;
+  for (DeclarationPlan &plan : plans) {
+    if (plan.reused) {
+      // same text, same expression indices
+      exprs.clear();
+      _preorder(*plan.expr, exprs);
+      for (const auto &entry : plan.record->semantics)
+        semantics.at(std::get<0>(entry))->setExpression(
+            exprs[std::get<1>(entry)]);
+
+      ++reusedDeclarations;
+      continue;
+    }
+
+    if (plan.record)
+      retireDeclaration(*plan.record);
+    else
+      plan.record = declarations.emplace(plan.key,
+          std::make_unique<DeclarationRecord>()).first->second.get();
+
+    plan.record->name = plan.name;
+    plan.record->failed = false;
+    ++analyzedDeclarations;
+  }
+
+  removeScopes(stale);
+}
+
+void TypeAnalyzer::finishDeclarations(
+    std::vector<DeclarationPlan> &plans) noexcept {
+  std::vector<const Expr*> exprs;
+  std::unordered_map<const Expr*, size_t> indices;
+  for (DeclarationPlan &plan : plans) {
+    if (plan.reused || plan.record->semantics.empty())
+      continue;
+
+    exprs.clear();
+    indices.clear();
+    _preorder(*plan.expr, exprs);
+    for (size_t i = 0; i < exprs.size(); ++i)
+      indices.emplace(exprs[i], i);
+
+    for (auto &entry : plan.record->semantics) {
+      // not found: analyzed again next build
+      auto it = indices.find(semantics.at(std::get<0>(entry))->getExpression());
+      std::get<1>(entry) = it != indices.end() ? it->second : SIZE_MAX;
+    }
+  }
+}
+
+bool TypeAnalyzer::visitScope(const std::string &mangle) noexcept {
+  return visitedScopes.insert(mangle).second;
+}
+
+bool TypeAnalyzer::buildSemantics(std::list<BuildSemanticParam> &&params) noexcept {
+  ScopedPhase phase(Phase::SEMANTIC);
+  ScopedSpan span("semantic", "buildSemantics");
+  // errors are reported again, definitions with errors are analyzed again
+  errors.clear();
+  visitedScopes.clear();
+
+  std::vector<DeclarationPlan> plans;
+  std::set<std::string> scopes;
+  std::unordered_map<std::string, size_t> counts;
+  for (const BuildSemanticParam &param : params) {
+    std::string prefix;
+    if (!param.main) {
+      prefix = _unitName(param);
+      scopes.insert(prefix);
+      prefix += '.';
+    }
+
+    _collectPlans(prefix, param.program->getDefinitions(), plans, scopes,
+        counts);
+  }
+
+  planDeclarations(plans, scopes);
+  _Plans planIndex;
+  for (DeclarationPlan &plan : plans)
+    planIndex.emplace(plan.expr, &plan);
+
+  TaskScheduler scheduler(threads);
+  // declarations are spawned by this thread only
+  mainContext.setConcurrent(false);
+  for (const BuildSemanticParam &param : params) {
+    const ProgramExpr &program = *param.program;
+    if (param.main) {
+      _spawnDefinitions(scheduler,
+          _Scope{this, &mainContext, &root, "", nullptr, &planIndex},
+          program.getDefinitions());
+      continue;
+    }
+
+    // other units are modules named after the program
+    const std::string name = _unitName(param);
+    auto semantic = std::make_unique<SafeSemantic>(ST_MODULE, &program, &root);
+    Semantic *semanticPtr = semantic.get();
+    bool inserted = false;
+    Semantic *existing = addSemantic(name, std::move(semantic), inserted);
+    if (!visitScope(name) || (!inserted
+          && (!(existing->getType() & ST_MODULE) || !existing->getSymbol()))) {
+      addError(program.getLexer(), std::make_unique<SemanticError>(LVL_ERROR,
+            SemanticErrorCode::SMT_ERR_REDEFINITION, program.getPosition()));
+      continue;
+    }
+
+    Context *unitctx;
+    if (inserted) {
+      unitctx = mainContext.createContext();
+      root.addChild(name, semanticPtr);
+      auto nmsp = std::make_unique<NamespaceSymbol>(0, intern(name), unitctx);
+      semanticPtr->setSymbol(nmsp.get());
+      if (mainContext.addSymbol(std::move(nmsp)))
+        semanticPtr->setSymbol(nullptr);
+    } else {
+      // unit of a previous build
+      semanticPtr = existing;
+      semanticPtr->setExpression(&program);
+      unitctx = semanticPtr->getSymbol()->getContext();
+    }
+
+    _spawnDefinitions(scheduler,
+        _Scope{this, unitctx, semanticPtr, name + '.', nullptr, &planIndex},
+        program.getDefinitions());
+  }
+
+  mainContext.setConcurrent(threads > 1);
+  scheduler.run();
+  mainContext.setConcurrent(true);
+  finishDeclarations(plans);
+
+  // deterministic order, independent of scheduling
+  std::stable_sort(errors.begin(), errors.end(),
+      [](const SemanticErrorEntry &entry0, const SemanticErrorEntry &entry1) {
+        const Lexer &lexer0 = *std::get<0>(entry0);
+        const Lexer &lexer1 = *std::get<0>(entry1);
+        if (&lexer0 != &lexer1)
+          return lexer0.getFilePath() < lexer1.getFilePath();
+
+        const Position &pos0 = std::get<1>(entry0)->getPosition();
+        const Position &pos1 = std::get<1>(entry1)->getPosition();
+        if (pos0.startIndex != pos1.startIndex)
+          return pos0.startIndex < pos1.startIndex;
+
+        return std::get<1>(entry0)->getErrorCode()
+          < std::get<1>(entry1)->getErrorCode();
+      });
+
+  return errors.empty();
+}
+
+Semantic *TypeAnalyzer::addSemantic(const std::string &mangle,
+    std::unique_ptr<Semantic> &&semantic, bool &inserted) noexcept {
+  std::lock_guard<std::mutex> guard(mtxSemantics);
+  auto it = semantics.find(mangle);
+  if (it != semantics.end()) {
+    inserted = false;
+    return it->second.get();
+  }
+
+  inserted = true;
+  Semantic *result = semantic.get();
+  semantics.emplace(mangle, std::move(semantic));
+  return result;
+}
+
+void TypeAnalyzer::addError(const Lexer &lexer,
+    std::unique_ptr<SemanticError> &&err) noexcept {
+  if (errorLimit && !errorLimit->add())
+    return;
+
+  std::lock_guard<std::mutex> guard(mtxErrors);
+  errors.emplace_back(&lexer, std::move(err));
+}
+
+void TypeAnalyzer::forEachSemantic(
+    const std::function<void(const std::string&, Semantic*)> &fn) noexcept {
+  std::lock_guard<std::mutex> guard(mtxSemantics);
+  for (auto &entry : semantics)
+    fn(entry.first, entry.second.get());
+}
+
+inline static const char *_semanticErrorText(SemanticErrorCode code) noexcept {
+  switch (code) {
+  case SemanticErrorCode::SMT_ERR_REDEFINITION:
+    return "Redefinition";
+  case SemanticErrorCode::SMT_ERR_UNKNOWN_TYPE:
+    return "Unknown type";
+  default:
+    return "Unknown error";
+  }
+}
+
+inline static LogMessage _logSemanticError(const Lexer &lexer,
+    const SemanticError &err) noexcept {
+  return LogMessage(err.getLogLevel(), logCreateErrorMessage(lexer,
+        err.getPosition(), _semanticErrorText(err.getErrorCode())));
+}
+
+DiagnosticRecord pfederc::describeSemanticError(const Lexer &lexer,
+    const SemanticError &err) noexcept {
+  return createDiagnosticRecord(lexer, err.getLogLevel(),
+      formatDiagnosticCode("SMT", static_cast<size_t>(err.getErrorCode())),
+      err.getPosition(), _semanticErrorText(err.getErrorCode()));
+}
+
+bool pfederc::logSemanticErrors(Logger &log, const TypeAnalyzer &analyzer) noexcept {
+  bool result = false;
+  for (const auto &entry : analyzer.getErrors()) {
+    const Lexer &lexer = *std::get<0>(entry);
+    const SemanticError &err = *std::get<1>(entry);
+    if (err.getLogLevel() == LVL_ERROR)
+      result = true;
+    log.report(lexer.getFilePath(), err.getPosition().startIndex,
+        err.getLogLevel(),
+        [&lexer, &err]() { return _logSemanticError(lexer, err); },
+        [&lexer, &err]() { return describeSemanticError(lexer, err); });
+  }
+
+  return result;
+}
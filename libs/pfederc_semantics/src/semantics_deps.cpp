@@ -0,0 +1,203 @@
+#include "pfederc/semantics_deps.hpp"
+using namespace pfederc;
+
+InternedId pfederc::getDeclaredName(const Expr &expr) noexcept {
+  const Lexer &lexer = expr.getLexer();
+  switch (expr.getType()) {
+  case ExprType::EXPR_MOD:
+    return dynamic_cast<const ModExpr&>(expr).getIdentifier()
+      .toInternedId(lexer);
+  case ExprType::EXPR_CLASS:
+    return dynamic_cast<const ClassExpr&>(expr).getIdentifier()
+      .toInternedId(lexer);
+  case ExprType::EXPR_TRAIT:
+    return dynamic_cast<const TraitExpr&>(expr).getIdentifier()
+      .toInternedId(lexer);
+  case ExprType::EXPR_ENUM:
+    return dynamic_cast<const EnumExpr&>(expr).getIdentifier()
+      .toInternedId(lexer);
+  case ExprType::EXPR_FUNC:
+    return dynamic_cast<const FuncExpr&>(expr).getIdentifier()
+      .toInternedId(lexer);
+  case ExprType::EXPR_BIOP: {
+    // x := ..., x : T = ..., x : T
+    const BiOpExpr &biop = dynamic_cast<const BiOpExpr&>(expr);
+    const Expr *decl = &biop;
+    if (biop.getOperatorType() == TokenType::TOK_OP_ASG
+        || biop.getOperatorType() == TokenType::TOK_OP_ASG_DCL)
+      decl = &biop.getLeft();
+
+    const Expr *id = decl;
+    if (isBiOpExpr(*decl, TokenType::TOK_OP_DCL))
+      id = &dynamic_cast<const BiOpExpr*>(decl)->getLeft();
+    else if (biop.getOperatorType() != TokenType::TOK_OP_ASG_DCL)
+      return INTERNED_NONE;
+
+    if (!isTokenExpr(*id, TokenType::TOK_ID))
+      return INTERNED_NONE;
+
+    return dynamic_cast<const TokenExpr*>(id)->getToken().toInternedId(lexer);
+  }
+  default:
+    // trait implementations, statements and use expressions
+    return INTERNED_NONE;
+  }
+}
+
+void pfederc::collectReferences(const Expr &expr,
+    std::vector<InternedId> &result) noexcept {
+  if (isTokenExpr(expr, TokenType::TOK_ID)) {
+    result.push_back(dynamic_cast<const TokenExpr&>(expr).getToken()
+        .toInternedId(expr.getLexer()));
+    return;
+  }
+
+  // the implemented class isn't a child expression
+  if (expr.getType() == ExprType::EXPR_TRAITIMPL)
+    result.push_back(dynamic_cast<const TraitImplExpr&>(expr).getIdentifier()
+        .toInternedId(expr.getLexer()));
+
+  expr.forEachChild([&result](const Expr &child) {
+      collectReferences(child, result);
+    });
+}
+
+// DeclarationGraph
+DeclarationGraph::DeclarationGraph(std::vector<const Expr*> &&defs) noexcept
+  : defs(std::move(defs)), names(), deps(), components(), members(),
+    recursive(), componentLevels(), levels() {
+  buildDependencies();
+  buildComponents();
+  buildLevels();
+}
+
+DeclarationGraph::~DeclarationGraph() {
+}
+
+void DeclarationGraph::buildDependencies() noexcept {
+  // overloads declare the same name
+  std::unordered_map<InternedId, std::vector<size_t>> declarations;
+  for (size_t def = 0; def < defs.size(); ++def) {
+    names.push_back(getDeclaredName(*defs[def]));
+    if (names.back() != INTERNED_NONE)
+      declarations[names.back()].push_back(def);
+  }
+
+  std::vector<InternedId> refs;
+  for (const Expr *expr : defs) {
+    refs.clear();
+    collectReferences(*expr, refs);
+
+    std::vector<size_t> result;
+    for (InternedId ref : refs) {
+      auto it = declarations.find(ref);
+      if (it != declarations.end())
+        result.insert(result.end(), it->second.begin(), it->second.end());
+    }
+
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    deps.push_back(std::move(result));
+  }
+}
+
+void DeclarationGraph::buildComponents() noexcept {
+  // Tarjan's algorithm without recursion: a component is completed after
+  // all components it depends on
+  constexpr size_t UNVISITED = SIZE_MAX;
+  std::vector<size_t> index(defs.size(), UNVISITED), lowlink(defs.size());
+  std::vector<bool> onStack(defs.size(), false);
+  std::vector<size_t> stack;
+  std::vector<std::tuple<size_t /* def */, size_t /* next dependency */>> calls;
+  size_t nextIndex = 0;
+
+  components.assign(defs.size(), 0);
+  for (size_t root = 0; root < defs.size(); ++root) {
+    if (index[root] != UNVISITED)
+      continue;
+
+    calls.emplace_back(root, 0);
+    while (!calls.empty()) {
+      const size_t def = std::get<0>(calls.back());
+      size_t &next = std::get<1>(calls.back());
+      if (next == 0 && index[def] == UNVISITED) {
+        index[def] = lowlink[def] = nextIndex++;
+        stack.push_back(def);
+        onStack[def] = true;
+      }
+
+      if (next < deps[def].size()) {
+        const size_t dep = deps[def][next++];
+        if (index[dep] == UNVISITED)
+          calls.emplace_back(dep, 0);
+        else if (onStack[dep])
+          lowlink[def] = std::min(lowlink[def], index[dep]);
+        continue;
+      }
+
+      calls.pop_back();
+      if (!calls.empty()) {
+        const size_t caller = std::get<0>(calls.back());
+        lowlink[caller] = std::min(lowlink[caller], lowlink[def]);
+      }
+
+      if (lowlink[def] != index[def])
+        continue;
+
+      std::vector<size_t> component;
+      size_t member;
+      do {
+        member = stack.back();
+        stack.pop_back();
+        onStack[member] = false;
+        components[member] = members.size();
+        component.push_back(member);
+      } while (member != def);
+
+      std::sort(component.begin(), component.end());
+      recursive.push_back(component.size() > 1
+          || std::binary_search(deps[def].begin(), deps[def].end(), def));
+      members.push_back(std::move(component));
+    }
+  }
+}
+
+void DeclarationGraph::buildLevels() noexcept {
+  for (size_t component = 0; component < members.size(); ++component) {
+    size_t level = 0;
+    for (size_t def : members[component]) {
+      for (size_t dep : deps[def]) {
+        if (components[dep] != component)
+          level = std::max(level, componentLevels[components[dep]] + 1);
+      }
+    }
+
+    componentLevels.push_back(level);
+    if (levels.size() <= level)
+      levels.resize(level + 1);
+    levels[level].push_back(component);
+  }
+
+  for (std::vector<size_t> &level : levels) {
+    std::sort(level.begin(), level.end(), [this](size_t c0, size_t c1) {
+        return members[c0].front() < members[c1].front();
+      });
+  }
+}
+
+void DeclarationGraph::markDependents(std::vector<bool> &marked) const noexcept {
+  // components depend only on components with lower numbers
+  for (size_t component = 0; component < members.size(); ++component) {
+    bool affected = false;
+    for (size_t def : members[component]) {
+      affected = affected || marked[def];
+      for (size_t dep : deps[def])
+        affected = affected || marked[dep];
+    }
+
+    if (affected) {
+      for (size_t def : members[component])
+        marked[def] = true;
+    }
+  }
+}
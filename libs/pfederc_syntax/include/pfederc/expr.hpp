@@ -65,6 +65,11 @@ namespace pfederc {
   class ArrayEmptyExpr;
   class Capabilities;
 
+  /*!\brief Function replacing an expression. Must not return nullptr.
+   */
+  typedef std::function<std::unique_ptr<Expr>(std::unique_ptr<Expr> &&)> ExprRewriter;
+  typedef std::function<void(const Expr &)> ExprVisitor;
+
   class Capable {
   protected:
     std::unique_ptr<Capabilities> caps;
@@ -73,6 +78,11 @@ namespace pfederc {
         : caps(std::move(caps)) {}
     inline ~Capable() {}
 
+    /*!\return Returns true, if capabilities were declared, otherwise false
+     * (getCapabilities() must not be called then).
+     */
+    inline bool hasCapabilities() const noexcept { return !!caps; }
+
     inline const Capabilities &getCapabilities() const noexcept { return *caps; }
     inline Capabilities &getCapabilities() noexcept { return *caps; }
   };
@@ -103,6 +113,22 @@ namespace pfederc {
     { return this->type == type; }
 
     virtual std::string toString() const noexcept = 0;
+
+    /*!\brief Calls visitor with every direct child expression (capabilities
+     * excluded) in the order of their position in Feder code.
+     * \param visitor
+     */
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept;
+
+    /*!\brief Replaces every direct child expression (capabilities excluded)
+     * with the return value of rewriter.
+     *
+     * Children which are stored with a fixed type (e.g. BodyExpr of a FuncExpr)
+     * aren't replaced, instead rewriteChildren is called on them.
+     *
+     * \param rewriter
+     */
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept;
   };
   
   enum class EnsuranceType {
@@ -181,6 +207,9 @@ namespace pfederc {
     inline const auto &getDefinitions() const noexcept { return defs; }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   class TokenExpr : public Expr {
@@ -236,6 +265,9 @@ namespace pfederc {
     { return std::move(exprs); }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   class ProgNameExpr final : public Expr {
@@ -311,6 +343,9 @@ namespace pfederc {
     { return autoDetectReturnType; }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   class FuncTypeExpr final : public Expr {
@@ -334,6 +369,9 @@ namespace pfederc {
     inline const Expr *getReturn() const noexcept { return returnExpr.get(); }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   class LambdaExpr final : public Expr {
@@ -358,6 +396,9 @@ namespace pfederc {
     { return *body; }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
 
@@ -392,6 +433,9 @@ namespace pfederc {
     { return functions; }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   class ClassExpr final : public Expr, public Capable {
@@ -433,6 +477,9 @@ namespace pfederc {
     { return functions; }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   class TraitImplExpr final : public Expr, public Capable {
@@ -466,6 +513,9 @@ namespace pfederc {
     { return functions; }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   typedef std::tuple<const Token*, std::vector<std::unique_ptr<Expr>>> EnumConstructor;
@@ -495,6 +545,9 @@ namespace pfederc {
     { return constructors; }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   class TypeExpr final : public Expr, public Capable {
@@ -517,6 +570,9 @@ namespace pfederc {
     inline const Expr &getExpresion() const noexcept { return *expr; }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   class ModExpr final : public Expr {
@@ -538,6 +594,9 @@ namespace pfederc {
     inline const auto &getExpressions() const noexcept { return exprs; }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   class SafeExpr final : public Expr {
@@ -559,6 +618,9 @@ namespace pfederc {
     inline const Expr &getExpression() const noexcept { return *expr; }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   typedef std::tuple<std::unique_ptr<Expr> /* cond */,
@@ -591,6 +653,9 @@ namespace pfederc {
     inline const BodyExpr *getElse() const noexcept { return elseExpr.get(); }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   class LoopExpr final : public Expr {
@@ -634,6 +699,9 @@ namespace pfederc {
     { return itExpr.get(); }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   typedef std::tuple<const Token * /* constructor */,
@@ -670,6 +738,9 @@ namespace pfederc {
     { return anyCase.get(); }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   class BiOpExpr final : public Expr {
@@ -703,6 +774,9 @@ namespace pfederc {
     inline const Expr &getLeft() const noexcept { return *lhs; }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   /*!\return Returns true, if the expr is binary operator with the
@@ -737,6 +811,9 @@ namespace pfederc {
     { return std::move(expr); }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   inline bool isUnOpExpr(const Expr &expr, TokenType type) noexcept {
@@ -744,6 +821,16 @@ namespace pfederc {
       dynamic_cast<const UnOpExpr&>(expr).getOperatorType() == type;
   }
 
+  /*!\return Returns the number of expressions in the tree expr (including
+   * expr itself).
+   */
+  size_t countExprNodes(const Expr &expr) noexcept;
+
+  /*!\return Returns true, if the tree expr has more than depth levels
+   * (expr itself is the first level), otherwise false.
+   */
+  bool isExprDeeperThan(const Expr &expr, size_t depth) noexcept;
+
   /*!\brief The type used to jump to different code position
    */
   enum class ReturnControlType {
@@ -779,6 +866,9 @@ namespace pfederc {
     inline ReturnControlType getReturnType() const noexcept { return rct; }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   class ArrayCpyExpr final : public Expr {
@@ -800,6 +890,9 @@ namespace pfederc {
     inline const Expr &getLength() const noexcept { return *lengthExpr; }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   class ArrayLitExpr final : public Expr {
@@ -820,6 +913,9 @@ namespace pfederc {
     inline const auto &getValues() const noexcept { return exprs; }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   class ArrayEmptyExpr final : public Expr {
@@ -840,6 +936,9 @@ namespace pfederc {
     inline const Expr &getType() const noexcept { return *typeExpr; }
 
     virtual std::string toString() const noexcept;
+
+    virtual void forEachChild(const ExprVisitor &visitor) const noexcept override;
+    virtual void rewriteChildren(const ExprRewriter &rewriter) noexcept override;
   };
 
   class ErrorExpr final : public Expr {
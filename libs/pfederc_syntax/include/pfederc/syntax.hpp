@@ -55,8 +55,16 @@ namespace pfederc {
     STX_ERR_INVALID_CAPS_ENSURE,
     STX_ERR_INVALID_CAPS_DIRECTIVE,
     STX_ERR_INVALID_CAPS_FOLLOWUP,
+
+    STX_ERR_NESTING_DEPTH,
   };
 
+  /*!\brief Maximal depth of nested expressions (brackets, bodies, unary
+   * operators and right operands), deeper input is rejected instead of
+   * exhausting the stack. Operator chains don't nest.
+   */
+  constexpr size_t PARSER_MAX_DEPTH = 1024;
+
   typedef Error<SyntaxErrorCode> SyntaxError;
 
   typedef std::tuple<const Token * /*progName*/,
@@ -68,6 +76,7 @@ namespace pfederc {
     Lexer &lexer;
     std::vector<std::unique_ptr<SyntaxError>> errors;
     std::map<Expr*, std::string> descriptions;
+    size_t depth; //!< depth of nested expressions
 
     std::unique_ptr<ErrorExpr> generateError(
       std::unique_ptr<SyntaxError> &&syntaxError) noexcept;
@@ -108,6 +117,12 @@ namespace pfederc {
     /*!\brief Calls next token as long as current one is EOL
      */
     void skipEol() noexcept;
+    /*!\brief Generates an error and skips till next newline, if
+     * PARSER_MAX_DEPTH is reached
+     * \param nesting Additional nesting of the current expression
+     * \return Returns true if the nesting is too deep, otherwise false.
+     */
+    bool isNestingTooDeep(size_t nesting = 0) noexcept;
 
     std::unique_ptr<Expr> parseCapabilities() noexcept;
     void parseCapabilityEnsure(std::vector<std::unique_ptr<Expr>> &required,
@@ -162,7 +177,7 @@ namespace pfederc {
     TemplateDecls parseTemplateDecl() noexcept;
   public:
     inline Parser(Lexer &lexer) noexcept
-      : lexer{lexer}, errors(), descriptions() {}
+      : lexer{lexer}, errors(), descriptions(), depth{0} {}
     Parser(const Parser &) = delete;
     ~Parser();
 
@@ -179,8 +194,16 @@ namespace pfederc {
   extern const std::map<TokenType /* opening bracket */,
     SyntaxErrorCode> STX_ERR_BRACKETS;
 
+  /*!\return Returns structured diagnostic of err (code STX...)
+   */
+  DiagnosticRecord describeParserError(const Parser &parser,
+      const SyntaxError &err) noexcept;
+
   /*!\return Returns true if an error occured while parsing
    * otherwise false.
+   *
+   * Errors are rendered when log writes them, a buffered log must be
+   * flushed before parser is destroyed.
    */
   bool logParserErrors(Logger &log, const Parser &parser) noexcept;
 }
@@ -5,63 +5,294 @@
 #include "pfederc/errors.hpp"
 #include "pfederc/lexer.hpp"
 #include "pfederc/expr.hpp"
+#include "pfederc/scheduler.hpp"
 
 namespace pfederc {
+  /*!\brief Rewrite rules of the optimizer
+   */
+  enum class OptimizerRule {
+    STRING_MERGE,   //!< str str => str
+    NUMBER_FOLD,    //!< num `op` num => num
+    NUMBER_COMPARE, //!< num `cmp` num => bool
+    INLINE,         //!< Inlined function call
+    CONSTANT_CALL,  //!< Evaluated call of #Constant function
+  };
+
+  constexpr size_t OPTIMIZER_RULE_COUNT =
+    static_cast<size_t>(OptimizerRule::CONSTANT_CALL) + 1;
+
+  /*!\return Returns name of rule
+   */
+  const char *optimizerRuleToString(OptimizerRule rule) noexcept;
+
+  /*!\brief Measurements of a single optimizer pass
+   */
+  struct OptimizerPassStats {
+    std::string name;
+    size_t nodesBefore; //!< countExprNodes before pass
+    size_t nodesAfter;  //!< countExprNodes after pass
+    size_t iterations;
+    size_t rewrites;
+    std::chrono::nanoseconds duration;
+  };
+
+  /*!\brief Statistics of optimizer passes and rewrite rules
+   */
+  class OptimizerStats final {
+    std::array<size_t, OPTIMIZER_RULE_COUNT> rules;
+    size_t iterations;
+    std::vector<OptimizerPassStats> passes;
+  public:
+    OptimizerStats() noexcept;
+    OptimizerStats(const OptimizerStats &) = default;
+    ~OptimizerStats();
+
+    inline void addRewrite(OptimizerRule rule, size_t count = 1) noexcept {
+      rules[static_cast<size_t>(rule)] += count;
+      instrumentation::count(Counter::REWRITES, count);
+    }
+
+    /*!\return Returns number of applied rewrites of rule
+     */
+    inline size_t getRewrites(OptimizerRule rule) const noexcept
+    { return rules[static_cast<size_t>(rule)]; }
+
+    /*!\return Returns number of applied rewrites of all rules
+     */
+    size_t getRewrites() const noexcept;
+
+    //! Expression optimized again after it changed
+    inline void addIteration() noexcept { iterations++; }
+    inline size_t getIterations() const noexcept { return iterations; }
+
+    inline void addPass(OptimizerPassStats &&pass) noexcept
+    { passes.push_back(std::move(pass)); }
+    inline const auto &getPasses() const noexcept { return passes; }
+
+    /*!\brief Adds rewrites, iterations and passes of stats
+     * \param stats
+     */
+    void merge(const OptimizerStats &stats) noexcept;
+
+    void printText(std::ostream &out) const noexcept;
+    void printJson(std::ostream &out) const noexcept;
+  };
+
+  typedef std::function<std::unique_ptr<Expr>(std::unique_ptr<Expr> &&,
+      OptimizerStats &)> OptimizerPassFunction;
+
+  /*!\brief Runs pass on expr and appends its measurements to stats
+   * \param name Pass name
+   * \param pass
+   * \param expr
+   * \param stats
+   */
+  std::unique_ptr<Expr> runOptimizerPass(const std::string &name,
+      const OptimizerPassFunction &pass, std::unique_ptr<Expr> &&expr,
+      OptimizerStats &stats) noexcept;
+
   std::tuple<std::unique_ptr<Expr>, bool /* changed */> optimize(
-      std::unique_ptr<Expr> &&expr, size_t &reducedexpressions) noexcept;
+      std::unique_ptr<Expr> &&expr, OptimizerStats &stats) noexcept;
 
   std::tuple<std::unique_ptr<Expr>, bool /* changed */> optimizeProgramExpr(
-      ProgramExpr *expr, size_t &reducedexpressions) noexcept;
+      ProgramExpr *expr, OptimizerStats &stats) noexcept;
 
   std::tuple<std::unique_ptr<Expr>, bool /* changed */> optimizeFuncExpr(
-      FuncExpr *expr, size_t &reducedexpressions) noexcept;
+      FuncExpr *expr, OptimizerStats &stats) noexcept;
 
   std::tuple<std::unique_ptr<Expr>, bool /* changed */> optimizeLambdaExpr(
-      LambdaExpr *expr, size_t &reducedexpressions) noexcept;
+      LambdaExpr *expr, OptimizerStats &stats) noexcept;
 
   std::tuple<std::unique_ptr<Expr>, bool /* changed */> optimizeClassExpr(
-      ClassExpr *expr, size_t &reducedexpressions) noexcept;
+      ClassExpr *expr, OptimizerStats &stats) noexcept;
 
   std::tuple<std::unique_ptr<Expr>, bool /* changed */> optimizeTraitImplExpr(
-      TraitImplExpr *expr, size_t &reducedexpressions) noexcept;
+      TraitImplExpr *expr, OptimizerStats &stats) noexcept;
 
   std::tuple<std::unique_ptr<Expr>, bool /* changed */> optimizeModExpr(
-      ModExpr *expr, size_t &reducedexpressions) noexcept;
+      ModExpr *expr, OptimizerStats &stats) noexcept;
 
   std::tuple<std::unique_ptr<Expr>, bool /* changed */> optimizeSafeExpr(
-      SafeExpr *expr, size_t &reducedexpressions) noexcept;
+      SafeExpr *expr, OptimizerStats &stats) noexcept;
 
   std::tuple<std::unique_ptr<Expr>, bool /* changed */> optimizeIfExpr(
-      IfExpr *expr, size_t &reducedexpressions) noexcept;
+      IfExpr *expr, OptimizerStats &stats) noexcept;
 
   std::tuple<std::unique_ptr<Expr>, bool /* changed */> optimizeLoopExpr(
-      LoopExpr *expr, size_t &reducedexpressions) noexcept;
+      LoopExpr *expr, OptimizerStats &stats) noexcept;
 
   std::tuple<std::unique_ptr<Expr>, bool /* changed */> optimizeMatchExpr(
-      MatchExpr *expr, size_t &reducedexpressions) noexcept;
+      MatchExpr *expr, OptimizerStats &stats) noexcept;
 
   std::tuple<std::unique_ptr<Expr>, bool /* changed */> optimizeBiOpExpr(
-      BiOpExpr *expr, size_t &reducedexpressions) noexcept;
+      BiOpExpr *expr, OptimizerStats &stats) noexcept;
 
   std::tuple<std::unique_ptr<Expr>, bool /* changed */> optimizeUnOpExpr(
-      UnOpExpr *expr, size_t &reducedexpressions) noexcept;
+      UnOpExpr *expr, OptimizerStats &stats) noexcept;
 
   std::tuple<std::unique_ptr<Expr>, bool /* changed */> optimizeBodyExpr(
-      BodyExpr *expr, size_t &reducedexpressions) noexcept;
+      BodyExpr *expr, OptimizerStats &stats) noexcept;
 
   std::tuple<std::unique_ptr<Expr>, bool /* changed */> optimizeArrayCpyExpr(
-      ArrayCpyExpr *expr, size_t &reducedexpressions) noexcept;
+      ArrayCpyExpr *expr, OptimizerStats &stats) noexcept;
 
   std::tuple<std::unique_ptr<Expr>, bool /* changed */> optimizeArrayLitExpr(
-      ArrayLitExpr *expr, size_t &reducedexpressions) noexcept;
+      ArrayLitExpr *expr, OptimizerStats &stats) noexcept;
 
   std::tuple<std::unique_ptr<Expr>, bool /* changed */> optimizeArrayEmptyExpr(
-      ArrayEmptyExpr *expr, size_t &reducedexpressions) noexcept;
+      ArrayEmptyExpr *expr, OptimizerStats &stats) noexcept;
 
   /*\brief Call optmize as long as _2 is true
    */
   std::unique_ptr<Expr> optimizeAll(std::unique_ptr<Expr> &&expr,
+      OptimizerStats &stats) noexcept;
+
+  /*!\brief Call optimizeAll with the workers of scheduler
+   *
+   * See runLocalPassParallel. The result and stats equal optimizeAll.
+   */
+  std::unique_ptr<Expr> optimizeAll(std::unique_ptr<Expr> &&expr,
+      OptimizerStats &stats, TaskScheduler &scheduler) noexcept;
+
+  /*!\brief Call optimizeAll
+   * \param expr
+   * \param reducedexpressions Incremented by number of rewrites
+   */
+  std::unique_ptr<Expr> optimizeAll(std::unique_ptr<Expr> &&expr,
+      size_t &reducedexpressions) noexcept;
+
+  /*!\brief Runs local pass on definitions in parallel
+   *
+   * Functions, classes, traits and trait implementations in program and
+   * module scope are independent tasks for local passes (passes, which
+   * only rewrite below definitions). The tasks are run by the workers of
+   * scheduler, the remaining expressions are rewritten afterwards.
+   * Statistics of the tasks are merged in definition order, so stats and
+   * the resulting tree don't depend on scheduling.
+   *
+   * \param pass Local pass
+   * \param expr Program or module
+   * \param stats
+   * \param scheduler Idle scheduler, which is reused by every call (its
+   * threads are kept)
+   */
+  std::unique_ptr<Expr> runLocalPassParallel(const OptimizerPassFunction &pass,
+      std::unique_ptr<Expr> &&expr, OptimizerStats &stats,
+      TaskScheduler &scheduler) noexcept;
+
+  /*!\brief Functions and modules defined in a program or module
+   */
+  struct FunctionScope {
+    //! Enclosing program or module (nullptr for the outermost scope)
+    const FunctionScope *parent;
+    //! Functions, which are neither overloaded nor hidden by parameters or
+    //! variables
+    std::map<std::string, const FuncExpr*> functions;
+    //! Modules, which are neither defined twice nor hidden
+    std::map<std::string, const FunctionScope*> modules;
+    //! Names of functions, types, modules and variables defined directly in
+    //! the program or module
+    std::set<std::string> names;
+  };
+
+  struct FunctionTable {
+    //! Scopes of the program (or module) and all modules within
+    std::map<const Expr* /* program or module */, FunctionScope> scopes;
+    //! Scope, which defines the function
+    std::map<const FuncExpr*, const FunctionScope*> definitions;
+  };
+
+  /*!\brief Inserts names of parameters, variables and match variables
+   * declared in expr (including nested expressions).
+   * \param expr
+   * \param names
+   */
+  void collectDeclarations(const Expr &expr,
+      std::set<std::string> &names) noexcept;
+
+  /*!\return Returns functions defined in expr and its modules.
+   * \param expr Program or module
+   */
+  FunctionTable collectFunctions(const Expr &expr) noexcept;
+
+  /*!\return Returns the called function, if expr is a call 'f(...)' of a
+   * function in scope or a call 'm.f(...)' of a function in module m of
+   * scope, otherwise nullptr.
+   * \param scope Program or module of the call
+   * \param expr
+   * \param args Arguments of the call are appended
+   */
+  const FuncExpr *resolveCall(const FunctionScope &scope, const Expr &expr,
+      std::vector<const Expr*> &args) noexcept;
+
+  /*!\brief Settings of inlineFunctions
+   */
+  struct InlineConfiguration {
+    //! Functions with more nodes (countExprNodes) in their return expression
+    //! aren't inlined, unless they have the capability #Inline
+    size_t maxInlineSize;
+    //! Maximum number of passes over the tree (inlined calls within inlined
+    //! function bodies)
+    size_t maxIterations;
+  };
+
+  constexpr InlineConfiguration createDefaultInlineConfiguration() noexcept {
+    return InlineConfiguration{8, 4};
+  }
+
+  typedef std::tuple<const FuncExpr * /* callee */,
+      Position /* call */> InlineRecord;
+
+  /*!\brief Substitutes calls to small or #Inline functions with the
+   * function's return expression.
+   *
+   * Only module-level functions, which consist of a single return expression
+   * (tokens, unary and binary operators) and which are neither templates nor
+   * recursive, are inlined.  Arguments which aren't tokens must be used
+   * exactly once by the function, in declaration order and before any call.
+   * Calls aren't inlined, if the caller or a module between the caller and
+   * the function declares a name, which the function refers to.
+   *
+   * \param expr Program or module
+   * \param cfg
+   * \param inlined Every inlined call is appended
+   * \param reducedexpressions Incremented with every inlined call
+   */
+  std::unique_ptr<Expr> inlineFunctions(std::unique_ptr<Expr> &&expr,
+      const InlineConfiguration &cfg, std::vector<InlineRecord> &inlined,
       size_t &reducedexpressions) noexcept;
+
+  /*!\brief Settings of evaluateConstantFunctions
+   */
+  struct ConstantConfiguration {
+    //! Maximum number of evaluated expressions per call
+    size_t maxSteps;
+    //! Maximum call depth
+    size_t maxDepth;
+    //! Maximum length of arrays
+    size_t maxArrayLength;
+  };
+
+  constexpr ConstantConfiguration createDefaultConstantConfiguration() noexcept {
+    return ConstantConfiguration{1 << 20, 64, 1 << 16};
+  }
+
+  /*!\brief Replaces calls to #Constant functions with constant arguments by
+   * the function's result. Calls are resolved with resolveCall.
+   *
+   * The function bodies are interpreted. Supported are booleans, numbers,
+   * arrays, variables, assignments, if, loops and calls to other #Constant
+   * functions. Arguments and results are converted to the declared
+   * parameter and return types, if that doesn't change their values. Calls,
+   * which can't be evaluated, exceed the limits of cfg or don't match the
+   * declared types, are left unchanged.
+   *
+   * \param expr Program or module
+   * \param cfg
+   * \param reducedexpressions Incremented with every evaluated call
+   */
+  std::unique_ptr<Expr> evaluateConstantFunctions(std::unique_ptr<Expr> &&expr,
+      const ConstantConfiguration &cfg, size_t &reducedexpressions) noexcept;
 }
 
 #endif /* PFEDERC_SYNTAX_SYNTAX_OPTIMIZER */
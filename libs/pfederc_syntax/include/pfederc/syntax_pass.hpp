@@ -0,0 +1,165 @@
+#ifndef PFEDERC_SYNTAX_SYNTAX_PASS
+#define PFEDERC_SYNTAX_SYNTAX_PASS
+
+#include "pfederc/core.hpp"
+#include "pfederc/expr.hpp"
+#include "pfederc/syntax_optimizer.hpp"
+
+namespace pfederc {
+  class OptimizerPass;
+  class OptimizerPipeline;
+  class PassManager;
+
+  /*!\brief Rewrite pass over the syntax tree
+   */
+  class OptimizerPass {
+  public:
+    OptimizerPass() noexcept;
+    OptimizerPass(const OptimizerPass &) = delete;
+    virtual ~OptimizerPass();
+
+    /*!\return Returns name used by pipelines
+     */
+    virtual const char *getName() const noexcept = 0;
+
+    /*!\return Returns true, if the pass only rewrites below definitions
+     * (functions, classes, ...) and doesn't replace definitions. Such passes
+     * are run on definitions independently (runLocalPassParallel).
+     */
+    virtual bool isLocal() const noexcept = 0;
+
+    /*!\return Returns rewritten expr
+     * \param expr Program, module or function
+     * \param stats
+     */
+    virtual std::unique_ptr<Expr> run(std::unique_ptr<Expr> &&expr,
+        OptimizerStats &stats) const noexcept = 0;
+  };
+
+  /*!\brief Constant folding (optimizeAll)
+   */
+  class FoldPass final : public OptimizerPass {
+  public:
+    FoldPass() noexcept;
+    virtual ~FoldPass();
+
+    virtual const char *getName() const noexcept override;
+    virtual bool isLocal() const noexcept override;
+    virtual std::unique_ptr<Expr> run(std::unique_ptr<Expr> &&expr,
+        OptimizerStats &stats) const noexcept override;
+  };
+
+  /*!\brief Function inlining (inlineFunctions)
+   */
+  class InlinePass final : public OptimizerPass {
+    InlineConfiguration cfg;
+  public:
+    InlinePass(const InlineConfiguration &cfg) noexcept;
+    virtual ~InlinePass();
+
+    virtual const char *getName() const noexcept override;
+    virtual bool isLocal() const noexcept override;
+    virtual std::unique_ptr<Expr> run(std::unique_ptr<Expr> &&expr,
+        OptimizerStats &stats) const noexcept override;
+  };
+
+  /*!\brief Compile-time evaluation of #Constant functions
+   * (evaluateConstantFunctions)
+   */
+  class ConstantPass final : public OptimizerPass {
+    ConstantConfiguration cfg;
+  public:
+    ConstantPass(const ConstantConfiguration &cfg) noexcept;
+    virtual ~ConstantPass();
+
+    virtual const char *getName() const noexcept override;
+    virtual bool isLocal() const noexcept override;
+    virtual std::unique_ptr<Expr> run(std::unique_ptr<Expr> &&expr,
+        OptimizerStats &stats) const noexcept override;
+  };
+
+  /*!\brief Maximal depth of optimized trees. The passes recurse over the
+   * tree, operator chains (parsed without limit) may be deeper.
+   */
+  constexpr size_t OPTIMIZER_MAX_DEPTH = 2048;
+
+  /*!\brief Ordered list of passes
+   */
+  class OptimizerPipeline final {
+    std::vector<std::unique_ptr<OptimizerPass>> passes;
+    size_t threads;
+    //! Workers of local passes, kept for all runs (nullptr for one thread)
+    std::unique_ptr<TaskScheduler> scheduler;
+  public:
+    /*!\brief Initializes OptimizerPipeline
+     * \param threads Local passes are run with up to threads threads
+     * (runLocalPassParallel). The threads are created once and reused by
+     * every run.
+     */
+    OptimizerPipeline(size_t threads = 1) noexcept;
+    OptimizerPipeline(const OptimizerPipeline &) = delete;
+    OptimizerPipeline(OptimizerPipeline &&) = default;
+    ~OptimizerPipeline();
+
+    inline void addPass(std::unique_ptr<OptimizerPass> &&pass) noexcept
+    { passes.push_back(std::move(pass)); }
+    inline const auto &getPasses() const noexcept { return passes; }
+
+    inline size_t getThreads() const noexcept { return threads; }
+
+    /*!\return Returns expr rewritten by all passes in order. Every pass is
+     * measured with runOptimizerPass. Trees deeper than OPTIMIZER_MAX_DEPTH
+     * are returned unchanged.
+     * \param expr
+     * \param stats
+     */
+    std::unique_ptr<Expr> run(std::unique_ptr<Expr> &&expr,
+        OptimizerStats &stats) const noexcept;
+  };
+
+  typedef std::function<std::unique_ptr<OptimizerPass>()> OptimizerPassFactory;
+
+  /*!\brief Registry of passes and named pipelines
+   *
+   * Initially the passes 'fold', 'inline', 'constant' and the pipelines
+   * 'O0' (no passes), 'O1' (fold) and 'O2' (constant, inline, fold) are
+   * registered.
+   */
+  class PassManager final {
+    std::map<std::string, OptimizerPassFactory> passes;
+    std::map<std::string, std::vector<std::string>> pipelines;
+  public:
+    PassManager() noexcept;
+    PassManager(const PassManager &) = delete;
+    ~PassManager();
+
+    /*!\brief Registers (or replaces) pass name
+     * \param name
+     * \param factory
+     */
+    void registerPass(const std::string &name,
+        OptimizerPassFactory &&factory) noexcept;
+
+    /*!\brief Registers (or replaces) pipeline name
+     * \param name
+     * \param passes Names of registered passes
+     */
+    void registerPipeline(const std::string &name,
+        std::vector<std::string> &&passes) noexcept;
+
+    inline const auto &getPassFactories() const noexcept { return passes; }
+    inline const auto &getPipelines() const noexcept { return pipelines; }
+
+    /*!\return Returns true, if pipeline could be created, otherwise false
+     * (unknown is set to the unknown name).
+     * \param pipeline Passes are appended
+     * \param spec Either a registered pipeline or a comma separated list of
+     * registered passes
+     * \param unknown
+     */
+    bool createPipeline(OptimizerPipeline &pipeline, const std::string &spec,
+        std::string &unknown) const noexcept;
+  };
+}
+
+#endif /* PFEDERC_SYNTAX_SYNTAX_PASS */
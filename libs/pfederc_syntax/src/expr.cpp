@@ -38,6 +38,82 @@ static void _setTemplateParents(TemplateDecls &templs, Expr *parent) noexcept {
   }
 }
 
+template<class T>
+inline static void _visit(const std::unique_ptr<T> &expr,
+    const ExprVisitor &visitor) noexcept {
+  if (!!expr)
+    visitor(*expr);
+}
+
+template<class T>
+static void _visitAll(const T &exprs, const ExprVisitor &visitor) noexcept {
+  for (const auto &expr : exprs)
+    visitor(*expr);
+}
+
+static void _visitParameters(const std::vector<std::unique_ptr<FuncParameter>> &params,
+    const ExprVisitor &visitor) noexcept {
+  for (const auto &param : params) {
+    visitor(*std::get<2>(*param));
+    _visit(std::get<3>(*param), visitor);
+    _visit(std::get<4>(*param), visitor);
+  }
+}
+
+static void _visitTemplates(const TemplateDecls &templs,
+    const ExprVisitor &visitor) noexcept {
+  for (const auto &templ : templs) {
+    visitor(*templ->id);
+    _visit(templ->expr, visitor);
+  }
+}
+
+inline static void _rewrite(std::unique_ptr<Expr> &expr, Expr *parent,
+    const ExprRewriter &rewriter) noexcept {
+  if (!expr)
+    return;
+
+  expr = rewriter(std::move(expr));
+  assert(!!expr);
+  expr->setParent(parent);
+}
+
+template<class T>
+static void _rewriteAll(T &exprs, Expr *parent,
+    const ExprRewriter &rewriter) noexcept {
+  for (auto &expr : exprs)
+    _rewrite(expr, parent, rewriter);
+}
+
+//! Children with fixed types aren't replaced, but their children are
+template<class T>
+inline static void _rewriteTyped(std::unique_ptr<T> &expr,
+    const ExprRewriter &rewriter) noexcept {
+  if (!!expr)
+    expr->rewriteChildren(rewriter);
+}
+
+template<class T>
+static void _rewriteTypedAll(T &exprs, const ExprRewriter &rewriter) noexcept {
+  for (auto &expr : exprs)
+    expr->rewriteChildren(rewriter);
+}
+
+static void _rewriteParameters(std::vector<std::unique_ptr<FuncParameter>> &params,
+    Expr *parent, const ExprRewriter &rewriter) noexcept {
+  for (auto &param : params) {
+    _rewrite(std::get<2>(*param), parent, rewriter);
+    _rewrite(std::get<3>(*param), parent, rewriter);
+    _rewrite(std::get<4>(*param), parent, rewriter);
+  }
+}
+
+static void _rewriteTemplates(TemplateDecls &templs, Expr *parent,
+    const ExprRewriter &rewriter) noexcept {
+  for (auto &templ : templs)
+    _rewrite(templ->expr, parent, rewriter);
+}
+
 static std::string _templateToString(const TemplateDecls &tmpls) {
   std::string result;
   result += '{';
@@ -89,12 +165,51 @@ static std::string _capsToString(const Capabilities &caps) noexcept {
 // Expr
 Expr::Expr(const Lexer &lexer, ExprType type, const Position &pos) noexcept
     : parent{nullptr}, lexer{lexer}, type{type}, pos(pos) {
-
+  instrumentation::count(Counter::EXPRESSIONS);
 }
 
 Expr::~Expr() {
 }
 
+void Expr::forEachChild(const ExprVisitor &) const noexcept {
+}
+
+void Expr::rewriteChildren(const ExprRewriter &) noexcept {
+}
+
+// Trees are traversed without recursion, operator chains are deep
+
+size_t pfederc::countExprNodes(const Expr &expr) noexcept {
+  size_t result = 0;
+  std::vector<const Expr*> stack{&expr};
+  while (!stack.empty()) {
+    const Expr *next = stack.back();
+    stack.pop_back();
+    ++result;
+    next->forEachChild([&stack](const Expr &child) {
+        stack.push_back(&child);
+      });
+  }
+
+  return result;
+}
+
+bool pfederc::isExprDeeperThan(const Expr &expr, size_t depth) noexcept {
+  std::vector<std::tuple<const Expr*, size_t>> stack{{&expr, 1}};
+  while (!stack.empty()) {
+    const auto next = stack.back();
+    stack.pop_back();
+    if (std::get<1>(next) > depth)
+      return true;
+
+    std::get<0>(next)->forEachChild([&stack, &next](const Expr &child) {
+        stack.emplace_back(&child, std::get<1>(next) + 1);
+      });
+  }
+
+  return false;
+}
+
 // Capabilities
 Capabilities::Capabilities(bool isunused, bool isinline, bool isconstant,
     std::vector<std::unique_ptr<Expr>> &&required,
@@ -136,6 +251,16 @@ std::string ProgramExpr::toString() const noexcept {
   return result;
 }
 
+void ProgramExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  _visitAll(imports, visitor);
+  _visitAll(defs, visitor);
+}
+
+void ProgramExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewriteAll(imports, this, rewriter);
+  _rewriteAll(defs, this, rewriter);
+}
+
 // TokenExpr
 TokenExpr::TokenExpr(const Lexer &lexer, Token *tok) noexcept
     : Expr(lexer, ExprType::EXPR_TOK, tok->getPosition()), tok{tok} {
@@ -175,6 +300,14 @@ std::string UseExpr::toString() const noexcept {
   return result;
 }
 
+void UseExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  _visitAll(exprs, visitor);
+}
+
+void UseExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewriteAll(exprs, this, rewriter);
+}
+
 // ProgNameExpr
 ProgNameExpr::ProgNameExpr(const Lexer &lexer, const Token *tok) noexcept
     : Expr(lexer, ExprType::EXPR_PROGNAME, tok->getPosition()), tok{tok} {
@@ -269,6 +402,20 @@ std::string FuncExpr::toString() const noexcept {
   return result;
 }
 
+void FuncExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  _visitTemplates(templs, visitor);
+  _visitParameters(params, visitor);
+  _visit(returnExpr, visitor);
+  _visit(body, visitor);
+}
+
+void FuncExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewriteTemplates(templs, this, rewriter);
+  _rewriteParameters(params, this, rewriter);
+  _rewrite(returnExpr, this, rewriter);
+  _rewriteTyped(body, rewriter);
+}
+
 // FuncTypeExpr
 FuncTypeExpr::FuncTypeExpr(const Lexer &lexer, const Position &pos,
     std::vector<std::unique_ptr<FuncParameter>>  &&params,
@@ -288,6 +435,16 @@ std::string FuncTypeExpr::toString() const noexcept {
   return "";
 }
 
+void FuncTypeExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  _visitParameters(params, visitor);
+  _visit(returnExpr, visitor);
+}
+
+void FuncTypeExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewriteParameters(params, this, rewriter);
+  _rewrite(returnExpr, this, rewriter);
+}
+
 // LambdaExpr
 LambdaExpr::LambdaExpr(const Lexer &lexer, const Position &pos,
     Exprs &&params,
@@ -322,6 +479,16 @@ std::string LambdaExpr::toString() const noexcept {
   return result;
 }
 
+void LambdaExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  _visitAll(params, visitor);
+  _visit(body, visitor);
+}
+
+void LambdaExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewriteAll(params, this, rewriter);
+  _rewriteTyped(body, rewriter);
+}
+
 // TraitExpr
 TraitExpr::TraitExpr(const Lexer &lexer, const Position &pos,
     std::unique_ptr<Capabilities> &&caps,
@@ -379,6 +546,18 @@ std::string TraitExpr::toString() const noexcept {
   return result;
 }
 
+void TraitExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  _visitTemplates(templs, visitor);
+  _visitAll(impltraits, visitor);
+  _visitAll(functions, visitor);
+}
+
+void TraitExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewriteTemplates(templs, this, rewriter);
+  _rewriteAll(impltraits, this, rewriter);
+  _rewriteTypedAll(functions, rewriter);
+}
+
 // ClassExpr
 ClassExpr::ClassExpr(const Lexer &lexer, const Position &pos,
     std::unique_ptr<Capabilities> &&caps,
@@ -445,6 +624,20 @@ std::string ClassExpr::toString() const noexcept {
   return result;
 }
 
+void ClassExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  _visitTemplates(templs, visitor);
+  _visitAll(constructAttributes, visitor);
+  _visitAll(attributes, visitor);
+  _visitAll(functions, visitor);
+}
+
+void ClassExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewriteTemplates(templs, this, rewriter);
+  _rewriteTypedAll(constructAttributes, rewriter);
+  _rewriteTypedAll(attributes, rewriter);
+  _rewriteTypedAll(functions, rewriter);
+}
+
 // TraitImplExpr
 TraitImplExpr::TraitImplExpr(const Lexer &lexer, const Position &pos,
     std::unique_ptr<Capabilities> &&caps,
@@ -492,6 +685,18 @@ std::string TraitImplExpr::toString() const noexcept {
   return result;
 }
 
+void TraitImplExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  _visitTemplates(templs, visitor);
+  visitor(*implTrait);
+  _visitAll(functions, visitor);
+}
+
+void TraitImplExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewriteTemplates(templs, this, rewriter);
+  _rewrite(implTrait, this, rewriter);
+  _rewriteTypedAll(functions, rewriter);
+}
+
 // EnumExpr
 EnumExpr::EnumExpr(const Lexer &lexer, const Position &pos,
     const Token *tokId,
@@ -546,6 +751,18 @@ std::string EnumExpr::toString() const noexcept {
   return result;
 }
 
+void EnumExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  _visitTemplates(templs, visitor);
+  for (const auto &constructor : constructors)
+    _visitAll(std::get<1>(constructor), visitor);
+}
+
+void EnumExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewriteTemplates(templs, this, rewriter);
+  for (auto &constructor : constructors)
+    _rewriteAll(std::get<1>(constructor), this, rewriter);
+}
+
 // TypeExpr
 TypeExpr::TypeExpr(const Lexer &lexer, const Position &pos,
     std::unique_ptr<Capabilities> &&caps,
@@ -569,6 +786,14 @@ std::string TypeExpr::toString() const noexcept {
   return result;
 }
 
+void TypeExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  visitor(*expr);
+}
+
+void TypeExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewrite(expr, this, rewriter);
+}
+
 // ModExpr
 ModExpr::ModExpr(const Lexer &lexer, const Position &pos,
     const Token *tokId, Exprs &&exprs) noexcept
@@ -591,6 +816,14 @@ std::string ModExpr::toString() const noexcept {
   return result;
 }
 
+void ModExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  _visitAll(exprs, visitor);
+}
+
+void ModExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewriteAll(exprs, this, rewriter);
+}
+
 // SafeExpr
 SafeExpr::SafeExpr(const Lexer &lexer, const Position &pos,
     std::unique_ptr<Expr> &&expr) noexcept
@@ -607,6 +840,14 @@ std::string SafeExpr::toString() const noexcept {
   return "safe " + getExpression().toString();
 }
 
+void SafeExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  visitor(*expr);
+}
+
+void SafeExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewrite(expr, this, rewriter);
+}
+
 // IfExpr
 IfExpr::IfExpr(const Lexer &lexer, const Position &pos,
     std::vector<IfCase> &&ifCases,
@@ -658,6 +899,24 @@ std::string IfExpr::toString() const noexcept {
   return result;
 }
 
+void IfExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  for (const auto &ifcase : ifCases) {
+    visitor(*std::get<0>(ifcase));
+    visitor(*std::get<1>(ifcase));
+  }
+
+  _visit(elseExpr, visitor);
+}
+
+void IfExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  for (auto &ifcase : ifCases) {
+    _rewrite(std::get<0>(ifcase), this, rewriter);
+    _rewriteTyped(std::get<1>(ifcase), rewriter);
+  }
+
+  _rewriteTyped(elseExpr, rewriter);
+}
+
 // LoopExpr
 LoopExpr::LoopExpr(const Lexer &lexer, ExprType type, const Position &pos,
     std::unique_ptr<Expr> &&initExpr,
@@ -718,6 +977,20 @@ std::string LoopExpr::toString() const noexcept {
   return result;
 }
 
+void LoopExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  _visit(initExpr, visitor);
+  visitor(*condExpr);
+  _visit(itExpr, visitor);
+  visitor(*bodyExpr);
+}
+
+void LoopExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewrite(initExpr, this, rewriter);
+  _rewrite(condExpr, this, rewriter);
+  _rewrite(itExpr, this, rewriter);
+  _rewriteTyped(bodyExpr, rewriter);
+}
+
 // MatchExpr
 MatchExpr::MatchExpr(const Lexer &lexer, const Position &pos,
     std::unique_ptr<Expr> &&expr,
@@ -776,6 +1049,130 @@ std::string MatchExpr::toString() const noexcept {
   return result;
 }
 
+void MatchExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  visitor(*expr);
+  for (const auto &matchcase : cases)
+    visitor(*std::get<2>(matchcase));
+
+  _visit(anyCase, visitor);
+}
+
+void MatchExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewrite(expr, this, rewriter);
+  for (auto &matchcase : cases)
+    _rewriteTyped(std::get<2>(matchcase), rewriter);
+
+  _rewriteTyped(anyCase, rewriter);
+}
+
+
+// Operator chains (a + b + c, f()()) nest their first operands. The
+// first operands are destroyed and printed iteratively, so the depth of
+// the chains isn't limited by the stack.
+
+//! \return Returns the first operand of operators, otherwise nullptr
+static const Expr *_firstOperand(const Expr &expr) noexcept {
+  switch (expr.getType()) {
+  case ExprType::EXPR_BIOP:
+    return &dynamic_cast<const BiOpExpr&>(expr).getLeft();
+  case ExprType::EXPR_UNOP:
+    return &dynamic_cast<const UnOpExpr&>(expr).getExpression();
+  default:
+    return nullptr;
+  }
+}
+
+static void _destroyOperands(std::unique_ptr<Expr> &&operand) noexcept {
+  while (operand) {
+    std::unique_ptr<Expr> next;
+    switch (operand->getType()) {
+    case ExprType::EXPR_BIOP:
+      next = dynamic_cast<BiOpExpr&>(*operand).getLeftPtr();
+      break;
+    case ExprType::EXPR_UNOP:
+      next = dynamic_cast<UnOpExpr&>(*operand).getExpressionPtr();
+      break;
+    default:
+      break;
+    }
+
+    operand = std::move(next);
+  }
+}
+
+//! \return Returns the string printed before the first operand
+static std::string _operatorPrefix(const Expr &expr) noexcept {
+  if (expr.getType() == ExprType::EXPR_UNOP) {
+    const UnOpExpr &unop = dynamic_cast<const UnOpExpr&>(expr);
+    if (unop.getOperatorType() == TokenType::TOK_OP_BRACKET_OPEN)
+      return "(";
+
+    return '(' + unop.getOperatorToken().toString(unop.getLexer()) + ' ';
+  }
+
+  const BiOpExpr &biop = dynamic_cast<const BiOpExpr&>(expr);
+  switch (biop.getOperatorType()) {
+  case TokenType::TOK_OP_BRACKET_OPEN:
+    return "(";
+  case TokenType::TOK_OP_ARR_BRACKET_OPEN:
+    return "[";
+  case TokenType::TOK_OP_TEMPL_BRACKET_OPEN:
+    return "{";
+  case TokenType::TOK_OP_NONE:
+    return "( ";
+  default:
+    return '(' + biop.getOperatorToken().toString(biop.getLexer()) + ' ';
+  }
+}
+
+//! \return Returns the string printed after the first operand
+static std::string _operatorSuffix(const Expr &expr) noexcept {
+  if (expr.getType() == ExprType::EXPR_UNOP)
+    return ")";
+
+  const BiOpExpr &biop = dynamic_cast<const BiOpExpr&>(expr);
+  char close;
+  switch (biop.getOperatorType()) {
+  case TokenType::TOK_OP_BRACKET_OPEN:
+    close = ')';
+    break;
+  case TokenType::TOK_OP_ARR_BRACKET_OPEN:
+    close = ']';
+    break;
+  case TokenType::TOK_OP_TEMPL_BRACKET_OPEN:
+    close = '}';
+    break;
+  default:
+    return ' ' + biop.getRight().toString() + ')';
+  }
+
+  std::string args;
+  const Expr * expr = &biop.getRight();
+  while (isBiOpExpr(*expr, TokenType::TOK_OP_COMMA)) {
+    const BiOpExpr * biopexpr = dynamic_cast<const BiOpExpr*>(expr);
+    args = ' ' + biopexpr->getRight().toString() + args;
+    expr = &biopexpr->getLeft();
+  }
+
+  return ' ' + expr->toString() + args + close;
+}
+
+static std::string _operatorString(const Expr &expr) noexcept {
+  std::vector<const Expr*> chain;
+  const Expr *operand = &expr;
+  for (; _firstOperand(*operand); operand = _firstOperand(*operand))
+    chain.push_back(operand);
+
+  std::string result;
+  for (const Expr *op : chain)
+    result += _operatorPrefix(*op);
+
+  result += operand->toString();
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+    result += _operatorSuffix(**it);
+
+  return result;
+}
 
 // BiOpExpr
 BiOpExpr::BiOpExpr(const Lexer &lexer, const Position &pos,
@@ -794,63 +1191,21 @@ BiOpExpr::BiOpExpr(const Lexer &lexer, const Position &pos,
 }
 
 BiOpExpr::~BiOpExpr() {
+  _destroyOperands(std::move(lhs));
 }
 
 std::string BiOpExpr::toString() const noexcept {
-  switch (getOperatorType()) {
-  case TokenType::TOK_OP_BRACKET_OPEN:
-  case TokenType::TOK_OP_ARR_BRACKET_OPEN:
-  case TokenType::TOK_OP_TEMPL_BRACKET_OPEN: {
-    std::string result;
-    switch (getOperatorType()) {
-      case TokenType::TOK_OP_BRACKET_OPEN:
-        result += '(';
-        break;
-      case TokenType::TOK_OP_ARR_BRACKET_OPEN:
-        result += '[';
-        break;
-      case TokenType::TOK_OP_TEMPL_BRACKET_OPEN:
-        result += '{';
-        break;
-      default:
-        fatal("expr.cpp", __LINE__, "Unexpected branch reached");
-        break;
-    }
-    result += getLeft().toString();
-    result += ' ';
-    std::string args;
-    const Expr * expr = &getRight();
-    while (isBiOpExpr(*expr, TokenType::TOK_OP_COMMA)) {
-      const BiOpExpr * biopexpr = dynamic_cast<const BiOpExpr*>(expr);
-      args = ' ' + biopexpr->getRight().toString() + args;
-      expr = &biopexpr->getLeft();
-    }
+  return _operatorString(*this);
+}
 
-    args = expr->toString() + args;
-    result += args;
-    switch (getOperatorType()) {
-      case TokenType::TOK_OP_BRACKET_OPEN:
-        result += ')';
-        break;
-      case TokenType::TOK_OP_ARR_BRACKET_OPEN:
-        result += ']';
-        break;
-      case TokenType::TOK_OP_TEMPL_BRACKET_OPEN:
-        result += '}';
-        break;
-      default:
-        fatal("expr.cpp", __LINE__, "Unexpected branch reached");
-        break;
-    }
+void BiOpExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  visitor(*lhs);
+  visitor(*rhs);
+}
 
-    return result;
-  }
-  case TokenType::TOK_OP_NONE:
-    return "( " + getLeft().toString() + ' ' + getRight().toString() + ')';
-  default:
-    return '(' + getOperatorToken().toString(getLexer()) + ' ' +
-      getLeft().toString() + ' ' + getRight().toString() + ')';
-  }
+void BiOpExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewrite(lhs, this, rewriter);
+  _rewrite(rhs, this, rewriter);
 }
 
 // UnOpExpr
@@ -865,15 +1220,19 @@ UnOpExpr::UnOpExpr(const Lexer &lexer, const Position &pos,
 }
 
 UnOpExpr::~UnOpExpr() {
+  _destroyOperands(std::move(expr));
 }
 
 std::string UnOpExpr::toString() const noexcept {
-  if (getOperatorType() == TokenType::TOK_OP_BRACKET_OPEN) {
-    return '(' + getExpression().toString() + ')';
-  }
+  return _operatorString(*this);
+}
+
+void UnOpExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  visitor(*expr);
+}
 
-  return '(' + getOperatorToken().toString(getLexer()) +
-    ' ' + getExpression().toString() + ')';
+void UnOpExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewrite(expr, this, rewriter);
 }
 
 // BodyExpr
@@ -922,6 +1281,16 @@ std::string BodyExpr::toString() const noexcept {
   return result;
 }
 
+void BodyExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  _visitAll(exprs, visitor);
+  _visit(retExpr, visitor);
+}
+
+void BodyExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewriteAll(exprs, this, rewriter);
+  _rewrite(retExpr, this, rewriter);
+}
+
 // ArrayCpyExpr
 ArrayCpyExpr::ArrayCpyExpr(const Lexer &lexer, const Position &pos,
      std::unique_ptr<Expr> &&valueExpr,
@@ -942,6 +1311,16 @@ std::string ArrayCpyExpr::toString() const noexcept {
   return '[' + valueExpr->toString() + "; " + lengthExpr->toString() + ']';
 }
 
+void ArrayCpyExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  visitor(*valueExpr);
+  visitor(*lengthExpr);
+}
+
+void ArrayCpyExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewrite(valueExpr, this, rewriter);
+  _rewrite(lengthExpr, this, rewriter);
+}
+
 // ArrayLitExpr
 ArrayLitExpr::ArrayLitExpr(const Lexer &lexer, const Position &pos,
      std::list<std::unique_ptr<Expr>> &&exprs) noexcept
@@ -969,6 +1348,14 @@ std::string ArrayLitExpr::toString() const noexcept {
   return result;
 }
 
+void ArrayLitExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  _visitAll(exprs, visitor);
+}
+
+void ArrayLitExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewriteAll(exprs, this, rewriter);
+}
+
 // ArrayEmptyExpr
 ArrayEmptyExpr::ArrayEmptyExpr(const Lexer &lexer, const Position &pos,
      std::unique_ptr<Expr> &&typeExpr) noexcept
@@ -986,6 +1373,14 @@ std::string ArrayEmptyExpr::toString() const noexcept {
   return '[' + typeExpr->toString() + ']';
 }
 
+void ArrayEmptyExpr::forEachChild(const ExprVisitor &visitor) const noexcept {
+  visitor(*typeExpr);
+}
+
+void ArrayEmptyExpr::rewriteChildren(const ExprRewriter &rewriter) noexcept {
+  _rewrite(typeExpr, this, rewriter);
+}
+
 // ErrorExpr
 std::string ErrorExpr::toString() const noexcept {
   // TODO
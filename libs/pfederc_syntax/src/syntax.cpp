@@ -36,6 +36,17 @@ void Parser::skipEol() noexcept {
     lexer.next();
 }
 
+bool Parser::isNestingTooDeep(size_t nesting) noexcept {
+  if (depth + nesting < PARSER_MAX_DEPTH)
+    return false;
+
+  generateError(std::make_unique<SyntaxError>(LVL_ERROR,
+    SyntaxErrorCode::STX_ERR_NESTING_DEPTH,
+    lexer.getCurrentToken()->getPosition()));
+  skipToEol();
+  return true;
+}
+
 std::unique_ptr<Expr> Parser::parseUnary() noexcept {
   const Token *tok = lexer.getCurrentToken();
   if (*tok == TokenType::TOK_OP_BRACKET_OPEN)
@@ -208,14 +219,21 @@ std::unique_ptr<Expr> Parser::parseSafe() noexcept {
 }
 
 std::unique_ptr<Expr> Parser::parseExpression(Precedence prec) noexcept {
+  if (isNestingTooDeep())
+    return nullptr;
+
+  ++depth;
   auto primary = parsePrimary();
   if (!primary) {
+    --depth;
     lexer.next();
     /*generateError(std::make_unique<SyntaxError>(LVL_ERROR,
       SyntaxErrorCode::STX_ERR_EXPECTED_EXPR, lexer.getCurrentToken()->getPosition()));*/
     return nullptr; // error forwarding
   }
   
-  return parseBinary(std::move(primary), prec);
+  auto expr = parseBinary(std::move(primary), prec);
+  --depth;
+  return expr;
 }
 
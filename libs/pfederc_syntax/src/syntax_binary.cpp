@@ -93,7 +93,16 @@ std::unique_ptr<Expr> Parser::parseBinary(std::unique_ptr<Expr> lhs,
       lookahead = lexer.getCurrentToken();
       Precedence innerPrec{0};
       while (_binary_inner_continue_condition(*lookahead, prec, innerPrec)) {
+        // right operands nest, operator chains don't
+        if (isNestingTooDeep())
+          return nullptr;
+
+        ++depth;
         rhs = parseBinary(std::move(rhs), innerPrec);
+        --depth;
+        if (!rhs)
+          return nullptr;
+
         lookahead = lexer.getCurrentToken();
       }
     }
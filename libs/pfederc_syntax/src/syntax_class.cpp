@@ -50,7 +50,7 @@ void Parser::parseClassConstructor(bool &err,
   lexer.next();
 
   std::unique_ptr<Expr> expr(parseExpression());
-  while (isBiOpExpr(*expr, TokenType::TOK_OP_COMMA)) {
+  while (expr && isBiOpExpr(*expr, TokenType::TOK_OP_COMMA)) {
     BiOpExpr &biopexpr = dynamic_cast<BiOpExpr&>(*expr);
     if (!isBiOpExpr(biopexpr.getRight(), TokenType::TOK_OP_DCL)) {
       generateError(std::make_unique<SyntaxError>(LVL_ERROR,
@@ -67,7 +67,9 @@ void Parser::parseClassConstructor(bool &err,
     expr = biopexpr.getLeftPtr();
   }
 
-  if (!isBiOpExpr(*expr, TokenType::TOK_OP_DCL)) {
+  if (!expr) {
+    err = true; // error forwarding
+  } else if (!isBiOpExpr(*expr, TokenType::TOK_OP_DCL)) {
     generateError(std::make_unique<SyntaxError>(LVL_ERROR,
       SyntaxErrorCode::STX_ERR_EXPECTED_VARDECL, expr->getPosition()));
     // soft error
@@ -21,152 +21,128 @@ bool Parser::expect(TokenType type) noexcept {
 std::unique_ptr<ErrorExpr> Parser::generateError(
     std::unique_ptr<SyntaxError> &&syntaxError) noexcept {
   
-  const Position &pos = syntaxError->getPosition();
-  errors.push_back(std::move(syntaxError));
+  const Position pos = syntaxError->getPosition();
+  // the lexer stops, after the limit is reached
+  ErrorLimit *errorLimit = lexer.getErrorLimit();
+  if (!errorLimit || errorLimit->add())
+    errors.push_back(std::move(syntaxError));
 
   return std::make_unique<ErrorExpr>(lexer, pos);
 }
 
-inline static LogMessage _logParserError(const Parser &parser, const SyntaxError &err) noexcept {
-  const Lexer &lexer{parser.getLexer()};
-  Position pos{err.getPosition()};
-  const Level &lvl{err.getLogLevel()};
-  switch (err.getErrorCode()) {
+inline static const char *_syntaxErrorText(SyntaxErrorCode code) noexcept {
+  switch (code) {
   case SyntaxErrorCode::STX_ERR_EXPECTED_PRIMARY_EXPR:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Expected primary expression"));
+    return "Expected primary expression";
   case SyntaxErrorCode::STX_ERR_EXPECTED_CLOSING_BRACKET:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Expected ')'"));
+    return "Expected ')'";
   case SyntaxErrorCode::STX_ERR_EXPECTED_ARR_CLOSING_BRACKET:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Expected ']'"));
+    return "Expected ']'";
   case SyntaxErrorCode::STX_ERR_EXPECTED_TEMPL_CLOSING_BRACKET:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Expected '}'"));
+    return "Expected '}'";
   case SyntaxErrorCode::STX_ERR_EXPECTED_FUNCTION_ID:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Expected identifier"));
+    return "Expected identifier";
   case SyntaxErrorCode::STX_ERR_EXPECTED_PARAMETERS:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Expected function parameters"));
+    return "Expected function parameters";
   case SyntaxErrorCode::STX_ERR_INVALID_VARDECL_ID:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Expected variable identifier"));
+    return "Expected variable identifier";
   case SyntaxErrorCode::STX_ERR_EXPECTED_VARDECL:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Expected variable declaration"));
+    return "Expected variable declaration";
   case SyntaxErrorCode::STX_ERR_INVALID_VARDECL:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Invalid variable declaration"));
+    return "Invalid variable declaration";
   case SyntaxErrorCode::STX_ERR_EXPECTED_ID:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Expected identifier"));
+    return "Expected identifier";
   case SyntaxErrorCode::STX_ERR_EXPECTED_GUARD:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Expected guard"));
+    return "Expected guard";
   case SyntaxErrorCode::STX_ERR_EXPECTED_FN_DCL_DEF:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Expected either function declaration or definition"));
+    return "Expected either function declaration or definition";
   case SyntaxErrorCode::STX_ERR_EXPECTED_STMT:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Expected ';'"));
+    return "Expected ';'";
   case SyntaxErrorCode::STX_ERR_FUNC_VAR_NO_TEMPL:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Function type mustn't have a template."));
+    return "Function type mustn't have a template.";
   case SyntaxErrorCode::STX_ERR_FUNC_VAR_NO_CAPS:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Function type mustn't have capabilities."));
+    return "Function type mustn't have capabilities.";
   case SyntaxErrorCode::STX_ERR_EXPECTED_EOL:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Expected end-of-line"));
+    return "Expected end-of-line";
   case SyntaxErrorCode::STX_ERR_EXPECTED_EOF:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Expected end-of-file"));
+    return "Expected end-of-file";
   case SyntaxErrorCode::STX_ERR_EXPECTED_EOF_EOL:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Expected end-of-file or end-of-line"));
+    return "Expected end-of-file or end-of-line";
   case SyntaxErrorCode::STX_ERR_INVALID_EXPR:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-      "Invalid expression"));
+    return "Invalid expression";
   case SyntaxErrorCode::STX_ERR_PROGNAME:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Expected program name"));
+    return "Expected program name";
   case SyntaxErrorCode::STX_ERR_CLASS_SCOPE:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Invalid in class scope"));
+    return "Invalid in class scope";
   case SyntaxErrorCode::STX_ERR_TRAIT_SCOPE:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Invalid in trait scope"));
+    return "Invalid in trait scope";
   case SyntaxErrorCode::STX_ERR_TRAIT_SCOPE_FUNC_TEMPL:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Invalid template function in trait scope"));
+    return "Invalid template function in trait scope";
   case SyntaxErrorCode::STX_ERR_TRAIT_SCOPE_FUNC_BODY:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "No function body in trait scope"));
+    return "No function body in trait scope";
   case SyntaxErrorCode::STX_ERR_TRAITCLASS_SCOPE_FUNC_BODY:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Expected function body in class trait scope"));
+    return "Expected function body in class trait scope";
   case SyntaxErrorCode::STX_ERR_TRAITCLASS_IMPL:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Expected single reference to trait type"));
+    return "Expected single reference to trait type";
   case SyntaxErrorCode::STX_ERR_ENUM_SCOPE:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Invalid in enum scope"));
+    return "Invalid in enum scope";
   case SyntaxErrorCode::STX_ERR_ENUM_BODY:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Expected enum body"));
+    return "Expected enum body";
   case SyntaxErrorCode::STX_ERR_CLASS_TRAIT_SCOPE:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Invalid in class trait scope"));
+    return "Invalid in class trait scope";
   case SyntaxErrorCode::STX_ERR_EXPECTED_CONSTRUCTION:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Expected constructor"));
+    return "Expected constructor";
   case SyntaxErrorCode::STX_ERR_INVALID_TYPE_EXPR:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Invalid type expression"));
+    return "Invalid type expression";
   case SyntaxErrorCode::STX_ERR_EXPECTED_FOR:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Expected 'for'"));
+    return "Expected 'for'";
   case SyntaxErrorCode::STX_ERR_EXPECTED_STMT_ELSE:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Expected ';' or 'else'"));
+    return "Expected ';' or 'else'";
   case SyntaxErrorCode::STX_ERR_EXPECTED_EOL_IF:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Expected either end-of-line or 'if'"));
+    return "Expected either end-of-line or 'if'";
   case SyntaxErrorCode::STX_ERR_EXPECTED_EOL_ENSURE:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Expected either end-of-line or 'ensure'"));
+    return "Expected either end-of-line or 'ensure'";
   case SyntaxErrorCode::STX_ERR_EXPECTED_ID_NUM_CHAR_BOOL:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Expected either identifier, number, character or boolean token"));
+    return "Expected either identifier, number, character or boolean token";
   case SyntaxErrorCode::STX_ERR_EXPECTED_ID_ANY:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Expected either identifier or '_'"));
+    return "Expected either identifier or '_'";
   case SyntaxErrorCode::STX_ERR_EXPECTED_OP_IMPL:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Expected '=>'"));
+    return "Expected '=>'";
   case SyntaxErrorCode::STX_ERR_INVALID_CAPS_ENSURE:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Invalid ensurance capability"));
+    return "Invalid ensurance capability";
   case SyntaxErrorCode::STX_ERR_INVALID_CAPS_DIRECTIVE:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Invalid directive capability"));
+    return "Invalid directive capability";
   case SyntaxErrorCode::STX_ERR_INVALID_CAPS_FOLLOWUP:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos,
-          "Invalid expression following capability list"));
+    return "Invalid expression following capability list";
+  case SyntaxErrorCode::STX_ERR_NESTING_DEPTH:
+    return "Expressions are nested too deeply";
   default:
-    return LogMessage(lvl, logCreateErrorMessage(lexer, pos, "Unknown error"));
+    return "Unknown error";
   }
 }
 
+inline static LogMessage _logParserError(const Parser &parser, const SyntaxError &err) noexcept {
+  return LogMessage(err.getLogLevel(), logCreateErrorMessage(parser.getLexer(),
+        err.getPosition(), _syntaxErrorText(err.getErrorCode())));
+}
+
+DiagnosticRecord pfederc::describeParserError(const Parser &parser,
+    const SyntaxError &err) noexcept {
+  return createDiagnosticRecord(parser.getLexer(), err.getLogLevel(),
+      formatDiagnosticCode("STX", static_cast<size_t>(err.getErrorCode())),
+      err.getPosition(), _syntaxErrorText(err.getErrorCode()));
+}
+
 bool pfederc::logParserErrors(Logger &log, const Parser &parser) noexcept {
   bool result = false;
   for (const auto &stxErr : parser.getErrors()) {
-    LogMessage msg = _logParserError(parser, *stxErr);
-    if (msg.getLogLevel() == LVL_ERROR)
+    const SyntaxError &err = *stxErr;
+    if (err.getLogLevel() == LVL_ERROR)
       result = true;
-    msg.log(log);
+    log.report(parser.getLexer().getFilePath(),
+        err.getPosition().startIndex, err.getLogLevel(),
+        [&parser, &err]() { return _logParserError(parser, err); },
+        [&parser, &err]() { return describeParserError(parser, err); });
   }
 
   return result;
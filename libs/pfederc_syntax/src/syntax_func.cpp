@@ -98,7 +98,7 @@ std::vector<std::unique_ptr<FuncParameter>> Parser::parseFuncParameters() noexce
   std::vector<std::unique_ptr<FuncParameter>> parameters;
 
   std::unique_ptr<Expr> expr(parseExpression());
-  while (isBiOpExpr(*expr, TokenType::TOK_OP_COMMA)) {
+  while (expr && isBiOpExpr(*expr, TokenType::TOK_OP_COMMA)) {
     BiOpExpr &biopexpr = dynamic_cast<BiOpExpr&>(*expr);
     auto funcparam = fromExprToFunctionParam(biopexpr.getRightPtr());
     if (!funcparam) {
@@ -111,7 +111,7 @@ std::vector<std::unique_ptr<FuncParameter>> Parser::parseFuncParameters() noexce
     expr = biopexpr.getLeftPtr();
   }
 
-  auto funcparam = fromExprToFunctionParam(std::move(expr));
+  auto funcparam = expr ? fromExprToFunctionParam(std::move(expr)) : nullptr;
   if (!funcparam)
     err = true;
   else
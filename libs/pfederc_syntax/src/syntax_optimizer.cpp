@@ -1,127 +1,127 @@
 #include "pfederc/syntax_optimizer.hpp"
 using namespace pfederc;
 
+//! Optimizes children of expr, expr itself remains unchanged
+static std::tuple<std::unique_ptr<Expr>, bool> _optimizeChildren(Expr *expr,
+    OptimizerStats &stats) noexcept {
+  expr->rewriteChildren([&stats](std::unique_ptr<Expr> &&child) {
+      return optimizeAll(std::move(child), stats);
+    });
+
+  return std::tuple<std::unique_ptr<Expr>, bool>(
+      std::unique_ptr<Expr>(expr), false);
+}
+
 std::unique_ptr<Expr> pfederc::optimizeAll(std::unique_ptr<Expr> &&expr,
-    size_t &reducedexpressions) noexcept {
-  auto tpl = optimize(std::move(expr), reducedexpressions);
+    OptimizerStats &stats) noexcept {
+  auto tpl = optimize(std::move(expr), stats);
   while (std::get<1>(tpl)) {
-    tpl = optimize(std::move(std::move(std::get<0>(tpl))), reducedexpressions);
+    stats.addIteration();
+    tpl = optimize(std::move(std::move(std::get<0>(tpl))), stats);
   }
 
   return std::move(std::get<0>(tpl));
 }
 
+std::unique_ptr<Expr> pfederc::optimizeAll(std::unique_ptr<Expr> &&expr,
+    size_t &reducedexpressions) noexcept {
+  OptimizerStats stats;
+  expr = optimizeAll(std::move(expr), stats);
+  reducedexpressions += stats.getRewrites();
+
+  return std::move(expr);
+}
+
 std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimize(
-    std::unique_ptr<Expr> &&expr, size_t &reducedexpressions) noexcept {
+    std::unique_ptr<Expr> &&expr, OptimizerStats &stats) noexcept {
   Expr *pexpr = expr.release();
   switch (pexpr->getType()) {
   case ExprType::EXPR_PROG:
-    return optimizeProgramExpr(dynamic_cast<ProgramExpr*>(pexpr), reducedexpressions);
+    return optimizeProgramExpr(dynamic_cast<ProgramExpr*>(pexpr), stats);
   case ExprType::EXPR_FUNC:
-    return optimizeFuncExpr(dynamic_cast<FuncExpr*>(pexpr), reducedexpressions);
+    return optimizeFuncExpr(dynamic_cast<FuncExpr*>(pexpr), stats);
   case ExprType::EXPR_LAMBDA:
-    return optimizeLambdaExpr(dynamic_cast<LambdaExpr*>(pexpr), reducedexpressions);
+    return optimizeLambdaExpr(dynamic_cast<LambdaExpr*>(pexpr), stats);
   case ExprType::EXPR_CLASS:
-    return optimizeClassExpr(dynamic_cast<ClassExpr*>(pexpr), reducedexpressions);
+    return optimizeClassExpr(dynamic_cast<ClassExpr*>(pexpr), stats);
   case ExprType::EXPR_TRAITIMPL:
-    return optimizeTraitImplExpr(dynamic_cast<TraitImplExpr*>(pexpr), reducedexpressions);
+    return optimizeTraitImplExpr(dynamic_cast<TraitImplExpr*>(pexpr), stats);
   case ExprType::EXPR_MOD:
-    return optimizeModExpr(dynamic_cast<ModExpr*>(pexpr), reducedexpressions);
+    return optimizeModExpr(dynamic_cast<ModExpr*>(pexpr), stats);
   case ExprType::EXPR_SAFE:
-    return optimizeSafeExpr(dynamic_cast<SafeExpr*>(pexpr), reducedexpressions);
+    return optimizeSafeExpr(dynamic_cast<SafeExpr*>(pexpr), stats);
   case ExprType::EXPR_IF:
-    return optimizeIfExpr(dynamic_cast<IfExpr*>(pexpr), reducedexpressions);
+    return optimizeIfExpr(dynamic_cast<IfExpr*>(pexpr), stats);
   case ExprType::EXPR_LOOP_FOR:
   case ExprType::EXPR_LOOP_DO:
-    return optimizeLoopExpr(dynamic_cast<LoopExpr*>(pexpr), reducedexpressions);
+    return optimizeLoopExpr(dynamic_cast<LoopExpr*>(pexpr), stats);
   case ExprType::EXPR_MATCH:
-    return optimizeMatchExpr(dynamic_cast<MatchExpr*>(pexpr), reducedexpressions);
+    return optimizeMatchExpr(dynamic_cast<MatchExpr*>(pexpr), stats);
   case ExprType::EXPR_BIOP:
-    return optimizeBiOpExpr(dynamic_cast<BiOpExpr*>(pexpr), reducedexpressions);
+    return optimizeBiOpExpr(dynamic_cast<BiOpExpr*>(pexpr), stats);
   case ExprType::EXPR_UNOP:
-    return optimizeUnOpExpr(dynamic_cast<UnOpExpr*>(pexpr), reducedexpressions);
+    return optimizeUnOpExpr(dynamic_cast<UnOpExpr*>(pexpr), stats);
   case ExprType::EXPR_BODY:
-    return optimizeBodyExpr(dynamic_cast<BodyExpr*>(pexpr), reducedexpressions);
+    return optimizeBodyExpr(dynamic_cast<BodyExpr*>(pexpr), stats);
   case ExprType::EXPR_ARRCPY:
-    return optimizeArrayCpyExpr(dynamic_cast<ArrayCpyExpr*>(pexpr), reducedexpressions);
+    return optimizeArrayCpyExpr(dynamic_cast<ArrayCpyExpr*>(pexpr), stats);
   case ExprType::EXPR_ARRLIT:
-    return optimizeArrayLitExpr(dynamic_cast<ArrayLitExpr*>(pexpr), reducedexpressions);
+    return optimizeArrayLitExpr(dynamic_cast<ArrayLitExpr*>(pexpr), stats);
   case ExprType::EXPR_ARREMPTY:
-    return optimizeArrayEmptyExpr(dynamic_cast<ArrayEmptyExpr*>(pexpr), reducedexpressions);
+    return optimizeArrayEmptyExpr(dynamic_cast<ArrayEmptyExpr*>(pexpr), stats);
   default:
-    return std::tuple<std::unique_ptr<Expr>, bool>(
-        std::unique_ptr<Expr>(pexpr), false);
+    return _optimizeChildren(pexpr, stats);
   }
 }
 
 std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeProgramExpr(
-    ProgramExpr *expr, size_t &reducedexpressions) noexcept {
-
-  return std::tuple<std::unique_ptr<Expr>, bool>(
-      std::unique_ptr<Expr>(expr), false);
+    ProgramExpr *expr, OptimizerStats &stats) noexcept {
+  return _optimizeChildren(expr, stats);
 }
 
 std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeFuncExpr(
-    FuncExpr *expr, size_t &reducedexpressions) noexcept {
-
-  return std::tuple<std::unique_ptr<Expr>, bool>(
-      std::unique_ptr<Expr>(expr), false);
+    FuncExpr *expr, OptimizerStats &stats) noexcept {
+  return _optimizeChildren(expr, stats);
 }
 
 std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeLambdaExpr(
-    LambdaExpr *expr, size_t &reducedexpressions) noexcept {
-
-  return std::tuple<std::unique_ptr<Expr>, bool>(
-      std::unique_ptr<Expr>(expr), false);
+    LambdaExpr *expr, OptimizerStats &stats) noexcept {
+  return _optimizeChildren(expr, stats);
 }
 
 std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeClassExpr(
-    ClassExpr *expr, size_t &reducedexpressions) noexcept {
-
-  return std::tuple<std::unique_ptr<Expr>, bool>(
-      std::unique_ptr<Expr>(expr), false);
+    ClassExpr *expr, OptimizerStats &stats) noexcept {
+  return _optimizeChildren(expr, stats);
 }
 
 std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeTraitImplExpr(
-    TraitImplExpr *expr, size_t &reducedexpressions) noexcept {
-
-  return std::tuple<std::unique_ptr<Expr>, bool>(
-      std::unique_ptr<Expr>(expr), false);
+    TraitImplExpr *expr, OptimizerStats &stats) noexcept {
+  return _optimizeChildren(expr, stats);
 }
 
 std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeModExpr(
-    ModExpr *expr, size_t &reducedexpressions) noexcept {
-
-  return std::tuple<std::unique_ptr<Expr>, bool>(
-      std::unique_ptr<Expr>(expr), false);
+    ModExpr *expr, OptimizerStats &stats) noexcept {
+  return _optimizeChildren(expr, stats);
 }
 
 std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeSafeExpr(
-    SafeExpr *expr, size_t &reducedexpressions) noexcept {
-
-  return std::tuple<std::unique_ptr<Expr>, bool>(
-      std::unique_ptr<Expr>(expr), false);
+    SafeExpr *expr, OptimizerStats &stats) noexcept {
+  return _optimizeChildren(expr, stats);
 }
 
 std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeIfExpr(
-    IfExpr *expr, size_t &reducedexpressions) noexcept {
-
-  return std::tuple<std::unique_ptr<Expr>, bool>(
-      std::unique_ptr<Expr>(expr), false);
+    IfExpr *expr, OptimizerStats &stats) noexcept {
+  return _optimizeChildren(expr, stats);
 }
 
 std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeLoopExpr(
-    LoopExpr *expr, size_t &reducedexpressions) noexcept {
-
-  return std::tuple<std::unique_ptr<Expr>, bool>(
-      std::unique_ptr<Expr>(expr), false);
+    LoopExpr *expr, OptimizerStats &stats) noexcept {
+  return _optimizeChildren(expr, stats);
 }
 
 std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeMatchExpr(
-    MatchExpr *expr, size_t &reducedexpressions) noexcept {
-
-  return std::tuple<std::unique_ptr<Expr>, bool>(
-      std::unique_ptr<Expr>(expr), false);
+    MatchExpr *expr, OptimizerStats &stats) noexcept {
+  return _optimizeChildren(expr, stats);
 }
 
 template<class R, class T>
@@ -160,6 +160,59 @@ static R _computeIntegerOperation(TokenType type, T x, T y) noexcept {
 	}
 }
 
+/*!\return Returns false, if lhs / rhs and lhs % rhs are undefined
+ * (division by zero, MIN / -1 overflows), these aren't folded
+ */
+template<class T>
+static bool _isDivisionDefined(const NumberToken &lhs,
+    const NumberToken &rhs) noexcept {
+  const T x = lhs.getNumber<T>(), y = rhs.getNumber<T>();
+  if (y == 0)
+    return false;
+
+  return !std::numeric_limits<T>::is_integer
+    || !std::numeric_limits<T>::is_signed
+    || x != std::numeric_limits<T>::min() || y != static_cast<T>(-1);
+}
+
+/*!\return Returns true, if operation type on the number expressions lhs
+ * and rhs (same number type) can be folded
+ */
+static bool _isFoldable(TokenType type, const Expr &lhs,
+    const Expr &rhs) noexcept {
+  if (type != TokenType::TOK_OP_DIV && type != TokenType::TOK_OP_MOD)
+    return true;
+
+  const NumberToken &lhsTok = dynamic_cast<const NumberToken&>(
+      dynamic_cast<const TokenExpr&>(lhs).getToken());
+  const NumberToken &rhsTok = dynamic_cast<const NumberToken&>(
+      dynamic_cast<const TokenExpr&>(rhs).getToken());
+  switch (lhsTok.getType()) {
+  case TokenType::TOK_INT8:
+    return _isDivisionDefined<int8_t>(lhsTok, rhsTok);
+  case TokenType::TOK_INT16:
+    return _isDivisionDefined<int16_t>(lhsTok, rhsTok);
+  case TokenType::TOK_INT32:
+    return _isDivisionDefined<int32_t>(lhsTok, rhsTok);
+  case TokenType::TOK_INT64:
+    return _isDivisionDefined<int64_t>(lhsTok, rhsTok);
+  case TokenType::TOK_UINT8:
+    return _isDivisionDefined<uint8_t>(lhsTok, rhsTok);
+  case TokenType::TOK_UINT16:
+    return _isDivisionDefined<uint16_t>(lhsTok, rhsTok);
+  case TokenType::TOK_UINT32:
+    return _isDivisionDefined<uint32_t>(lhsTok, rhsTok);
+  case TokenType::TOK_UINT64:
+    return _isDivisionDefined<uint64_t>(lhsTok, rhsTok);
+  case TokenType::TOK_FLT32:
+    return _isDivisionDefined<float>(lhsTok, rhsTok);
+  case TokenType::TOK_FLT64:
+    return _isDivisionDefined<double>(lhsTok, rhsTok);
+  default:
+    return false;
+  }
+}
+
 template<typename R>
 static R _computeNumberBoolOperation(TokenType type, const NumberToken &lhs, const NumberToken &rhs) {
 	switch (type) {
@@ -182,11 +235,10 @@ static R _computeNumberBoolOperation(TokenType type, const NumberToken &lhs, con
 }
 
 std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeBiOpExpr(
-    BiOpExpr *expr, size_t &reducedexpressions) noexcept {
+    BiOpExpr *expr, OptimizerStats &stats) noexcept {
 
-  const size_t oldreducedexpressions{reducedexpressions};
-  std::unique_ptr<Expr> lhs = optimizeAll(expr->getLeftPtr(), reducedexpressions);
-  std::unique_ptr<Expr> rhs = optimizeAll(expr->getRightPtr(), reducedexpressions);
+  std::unique_ptr<Expr> lhs = optimizeAll(expr->getLeftPtr(), stats);
+  std::unique_ptr<Expr> rhs = optimizeAll(expr->getRightPtr(), stats);
 
   // Expression: str str
   // Target: str
@@ -202,9 +254,9 @@ std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeBiOpExpr(
           expr->getPosition(), merged));
     delete expr;
 
-    reducedexpressions++;
+    stats.addRewrite(OptimizerRule::STRING_MERGE);
     return std::tuple<std::unique_ptr<Expr>, bool>(
-        std::move(newexpr), oldreducedexpressions != reducedexpressions);
+        std::move(newexpr), true);
   }
 
 	// num `op` num
@@ -214,7 +266,8 @@ std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeBiOpExpr(
 			&& (expr->getOperatorType() == TokenType::TOK_OP_ADD
 				|| expr->getOperatorType() == TokenType::TOK_OP_SUB
 				|| expr->getOperatorType() == TokenType::TOK_OP_MUL
-				|| expr->getOperatorType() == TokenType::TOK_OP_DIV)) {
+				|| expr->getOperatorType() == TokenType::TOK_OP_DIV)
+			&& _isFoldable(expr->getOperatorType(), *lhs, *rhs)) {
 		NumberToken &lhsTok = dynamic_cast<NumberToken&>(dynamic_cast<TokenExpr&>(*lhs).getToken());
 		NumberToken &rhsTok = dynamic_cast<NumberToken&>(dynamic_cast<TokenExpr&>(*rhs).getToken());
 
@@ -290,7 +343,7 @@ std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeBiOpExpr(
 				expr->getLexer(), std::move(tok));
 		delete expr;
 
-		reducedexpressions++;
+		stats.addRewrite(OptimizerRule::NUMBER_FOLD);
 
 		return std::tuple<std::unique_ptr<Expr>, bool>(std::move(newexpr), true);
 	}
@@ -299,7 +352,8 @@ std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeBiOpExpr(
 	if (lhs->getType() == ExprType::EXPR_TOK && rhs->getType() == ExprType::EXPR_TOK
 			&& isNumberType(dynamic_cast<TokenExpr&>(*lhs).getToken().getType())
 			&& dynamic_cast<TokenExpr&>(*lhs).getToken().getType() == dynamic_cast<TokenExpr&>(*rhs).getToken().getType()
-			&& (expr->getOperatorType() == TokenType::TOK_OP_MOD)) {
+			&& (expr->getOperatorType() == TokenType::TOK_OP_MOD)
+			&& _isFoldable(expr->getOperatorType(), *lhs, *rhs)) {
 		NumberToken &lhsTok = dynamic_cast<NumberToken&>(dynamic_cast<TokenExpr&>(*lhs).getToken());
 		NumberToken &rhsTok = dynamic_cast<NumberToken&>(dynamic_cast<TokenExpr&>(*rhs).getToken());
 
@@ -363,7 +417,7 @@ std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeBiOpExpr(
 				expr->getLexer(), std::move(tok));
 		delete expr;
 
-		reducedexpressions++;
+		stats.addRewrite(OptimizerRule::NUMBER_FOLD);
 
 		return std::tuple<std::unique_ptr<Expr>, bool>(std::move(newexpr), true);
 	}
@@ -450,7 +504,7 @@ std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeBiOpExpr(
 				expr->getLexer(), std::move(tok));
 		delete expr;
 
-		reducedexpressions++;
+		stats.addRewrite(OptimizerRule::NUMBER_COMPARE);
 
 		return std::tuple<std::unique_ptr<Expr>, bool>(std::move(newexpr), true);
 	}
@@ -465,8 +519,8 @@ std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeBiOpExpr(
 }
 
 std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeUnOpExpr(
-    UnOpExpr *expr, size_t &reducedexpressions) noexcept {
-  std::unique_ptr<Expr> newincludedexpr = optimizeAll(expr->getExpressionPtr(), reducedexpressions);
+    UnOpExpr *expr, OptimizerStats &stats) noexcept {
+  std::unique_ptr<Expr> newincludedexpr = optimizeAll(expr->getExpressionPtr(), stats);
   std::unique_ptr<Expr> newexpr = std::make_unique<UnOpExpr>(expr->getLexer(),
       expr->getPosition(), &(expr->getOperatorToken()),
         std::move(newincludedexpr));
@@ -476,29 +530,202 @@ std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeUnOpExpr(
 }
 
 std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeBodyExpr(
-    BodyExpr *expr, size_t &reducedexpressions) noexcept {
-
-  return std::tuple<std::unique_ptr<Expr>, bool>(
-      std::unique_ptr<Expr>(expr), false);
+    BodyExpr *expr, OptimizerStats &stats) noexcept {
+  return _optimizeChildren(expr, stats);
 }
 
 std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeArrayCpyExpr(
-    ArrayCpyExpr *expr, size_t &reducedexpressions) noexcept {
-
-  return std::tuple<std::unique_ptr<Expr>, bool>(
-      std::unique_ptr<Expr>(expr), false);
+    ArrayCpyExpr *expr, OptimizerStats &stats) noexcept {
+  return _optimizeChildren(expr, stats);
 }
 
 std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeArrayLitExpr(
-    ArrayLitExpr *expr, size_t &reducedexpressions) noexcept {
-
-  return std::tuple<std::unique_ptr<Expr>, bool>(
-      std::unique_ptr<Expr>(expr), false);
+    ArrayLitExpr *expr, OptimizerStats &stats) noexcept {
+  return _optimizeChildren(expr, stats);
 }
 
 std::tuple<std::unique_ptr<Expr>, bool /* changed */> pfederc::optimizeArrayEmptyExpr(
-    ArrayEmptyExpr *expr, size_t &reducedexpressions) noexcept {
+    ArrayEmptyExpr *expr, OptimizerStats &stats) noexcept {
+  return _optimizeChildren(expr, stats);
+}
 
-  return std::tuple<std::unique_ptr<Expr>, bool>(
-      std::unique_ptr<Expr>(expr), false);
+//! Returns definitions of program or module expr (otherwise nullptr)
+static const Exprs *_scopeDefinitions(const Expr &expr) noexcept {
+  switch (expr.getType()) {
+  case ExprType::EXPR_PROG:
+    return &dynamic_cast<const ProgramExpr&>(expr).getDefinitions();
+  case ExprType::EXPR_MOD:
+    return &dynamic_cast<const ModExpr&>(expr).getExpressions();
+  default:
+    return nullptr;
+  }
+}
+
+//! Returns the identifier of a function, type or module definition
+static const Token *_definedIdentifier(const Expr &expr) noexcept {
+  switch (expr.getType()) {
+  case ExprType::EXPR_FUNC:
+    return &dynamic_cast<const FuncExpr&>(expr).getIdentifier();
+  case ExprType::EXPR_TRAIT:
+    return &dynamic_cast<const TraitExpr&>(expr).getIdentifier();
+  case ExprType::EXPR_CLASS:
+    return &dynamic_cast<const ClassExpr&>(expr).getIdentifier();
+  case ExprType::EXPR_ENUM:
+    return &dynamic_cast<const EnumExpr&>(expr).getIdentifier();
+  case ExprType::EXPR_TYPE:
+    return &dynamic_cast<const TypeExpr&>(expr).getIdentifier();
+  case ExprType::EXPR_MOD:
+    return &dynamic_cast<const ModExpr&>(expr).getIdentifier();
+  default:
+    return nullptr;
+  }
+}
+
+void pfederc::collectDeclarations(const Expr &expr,
+    std::set<std::string> &names) noexcept {
+  switch (expr.getType()) {
+  case ExprType::EXPR_FUNC:
+    for (const auto &param :
+        dynamic_cast<const FuncExpr&>(expr).getParameters()) {
+      if (std::get<0>(*param))
+        names.insert(std::get<0>(*param)->toString(expr.getLexer()));
+    }
+    break;
+  case ExprType::EXPR_BIOP:
+    if ((isBiOpExpr(expr, TokenType::TOK_OP_ASG_DCL)
+          || isBiOpExpr(expr, TokenType::TOK_OP_DCL))
+        && isTokenExpr(dynamic_cast<const BiOpExpr&>(expr).getLeft(),
+          TokenType::TOK_ID))
+      names.insert(dynamic_cast<const BiOpExpr&>(expr).getLeft().toString());
+    break;
+  case ExprType::EXPR_MATCH:
+    for (const auto &matchcase :
+        dynamic_cast<const MatchExpr&>(expr).getCases()) {
+      for (const Token *var : std::get<1>(matchcase))
+        names.insert(var->toString(expr.getLexer()));
+    }
+    break;
+  default:
+    break;
+  }
+
+  expr.forEachChild([&names](const Expr &child) {
+      collectDeclarations(child, names);
+    });
+}
+
+/*!\brief Collects functions and modules defined in program or module expr
+ * \param table
+ * \param expr
+ * \param parent Scope around expr
+ * \return Returns scope of expr
+ */
+static FunctionScope *_collectFunctions(FunctionTable &table,
+    const Expr &expr, const FunctionScope *parent) noexcept {
+  FunctionScope &scope = table.scopes[&expr];
+  scope.parent = parent;
+
+  // overloaded or hidden functions and modules aren't resolved
+  std::map<std::string, std::vector<const FuncExpr*>> funcs;
+  std::map<std::string, std::vector<const FunctionScope*>> mods;
+  for (const auto &def : *_scopeDefinitions(expr)) {
+    const Token *tokId = _definedIdentifier(*def);
+    if (tokId)
+      scope.names.insert(tokId->toString(def->getLexer()));
+
+    switch (def->getType()) {
+    case ExprType::EXPR_FUNC:
+      funcs[tokId->toString(def->getLexer())].push_back(
+          dynamic_cast<const FuncExpr*>(def.get()));
+      break;
+    case ExprType::EXPR_MOD:
+      mods[tokId->toString(def->getLexer())].push_back(
+          _collectFunctions(table, *def, &scope));
+      break;
+    default:
+      // variables
+      if (!tokId)
+        collectDeclarations(*def, scope.names);
+      break;
+    }
+  }
+
+  std::set<std::string> declarations;
+  collectDeclarations(expr, declarations);
+
+  for (const auto &entry : funcs) {
+    if (entry.second.size() != 1 || declarations.count(entry.first))
+      continue;
+
+    scope.functions.emplace(entry.first, entry.second.front());
+    table.definitions.emplace(entry.second.front(), &scope);
+  }
+
+  for (const auto &entry : mods) {
+    if (entry.second.size() != 1 || declarations.count(entry.first)
+        || funcs.count(entry.first))
+      continue;
+
+    scope.modules.emplace(entry.first, entry.second.front());
+  }
+
+  return &scope;
+}
+
+FunctionTable pfederc::collectFunctions(const Expr &expr) noexcept {
+  FunctionTable result;
+  if (_scopeDefinitions(expr))
+    _collectFunctions(result, expr, nullptr);
+
+  return result;
+}
+
+const FuncExpr *pfederc::resolveCall(const FunctionScope &scope,
+    const Expr &expr, std::vector<const Expr*> &args) noexcept {
+  const Expr *callee;
+  const Expr *arg = nullptr;
+  if (isBiOpExpr(expr, TokenType::TOK_OP_BRACKET_OPEN)) {
+    const BiOpExpr &call = dynamic_cast<const BiOpExpr&>(expr);
+    callee = &call.getLeft();
+    arg = &call.getRight();
+  } else if (isUnOpExpr(expr, TokenType::TOK_OP_BRACKET_OPEN)) {
+    callee = &dynamic_cast<const UnOpExpr&>(expr).getExpression();
+  } else {
+    return nullptr;
+  }
+
+  // m.f(...)
+  const FunctionScope *target = &scope;
+  if (isBiOpExpr(*callee, TokenType::TOK_OP_MEM)) {
+    const BiOpExpr &mem = dynamic_cast<const BiOpExpr&>(*callee);
+    if (!isTokenExpr(mem.getLeft(), TokenType::TOK_ID))
+      return nullptr;
+
+    auto it = scope.modules.find(mem.getLeft().toString());
+    if (it == scope.modules.end())
+      return nullptr;
+
+    target = it->second;
+    callee = &mem.getRight();
+  }
+
+  if (!isTokenExpr(*callee, TokenType::TOK_ID))
+    return nullptr;
+
+  auto it = target->functions.find(callee->toString());
+  if (it == target->functions.end())
+    return nullptr;
+
+  if (arg) {
+    const size_t first = args.size();
+    while (isBiOpExpr(*arg, TokenType::TOK_OP_COMMA)) {
+      const BiOpExpr &comma = dynamic_cast<const BiOpExpr&>(*arg);
+      args.insert(args.begin() + first, &comma.getRight());
+      arg = &comma.getLeft();
+    }
+
+    args.insert(args.begin() + first, arg);
+  }
+
+  return it->second;
 }
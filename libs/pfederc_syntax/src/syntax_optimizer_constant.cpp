@@ -0,0 +1,881 @@
+#include "pfederc/syntax_optimizer.hpp"
+#include <cmath>
+using namespace pfederc;
+
+struct _ConstValue;
+typedef std::vector<_ConstValue> _ConstArray;
+
+struct _ConstValue {
+  //! Number type, TOK_KW_TRUE (boolean) or TOK_OP_ARR_BRACKET_OPEN (array)
+  TokenType type;
+  //! Integers (sign extended) and booleans
+  uint64_t num;
+  double flt;
+  //! Arrays are shared by assignments
+  std::shared_ptr<_ConstArray> arr;
+};
+
+typedef std::map<std::string, _ConstValue> _ConstScope;
+
+struct _ConstState {
+  const ConstantConfiguration &cfg;
+  const FunctionTable &funcs;
+  //! Program or module of the current function
+  const FunctionScope *scope;
+  //! Scopes of the current function, innermost last
+  std::vector<_ConstScope> scopes;
+  size_t steps;
+  size_t depth;
+};
+
+enum class _ConstFlow {
+  FAIL,
+  NEXT,
+  RETURN,
+  BREAK,
+  CONTINUE,
+};
+
+inline static bool _isSignedType(TokenType type) noexcept {
+  switch (type) {
+  case TokenType::TOK_INT8:
+  case TokenType::TOK_INT16:
+  case TokenType::TOK_INT32:
+  case TokenType::TOK_INT64:
+    return true;
+  default:
+    return false;
+  }
+}
+
+inline static size_t _bitWidth(TokenType type) noexcept {
+  switch (type) {
+  case TokenType::TOK_INT8:
+  case TokenType::TOK_UINT8:
+    return 8;
+  case TokenType::TOK_INT16:
+  case TokenType::TOK_UINT16:
+    return 16;
+  case TokenType::TOK_INT32:
+  case TokenType::TOK_UINT32:
+    return 32;
+  default:
+    return 64;
+  }
+}
+
+//! Wraps integer x to the range of type
+static uint64_t _truncate(TokenType type, uint64_t x) noexcept {
+  switch (type) {
+  case TokenType::TOK_INT8:
+    return static_cast<uint64_t>(static_cast<int64_t>(static_cast<int8_t>(x)));
+  case TokenType::TOK_INT16:
+    return static_cast<uint64_t>(static_cast<int64_t>(static_cast<int16_t>(x)));
+  case TokenType::TOK_INT32:
+    return static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(x)));
+  case TokenType::TOK_UINT8:
+    return static_cast<uint8_t>(x);
+  case TokenType::TOK_UINT16:
+    return static_cast<uint16_t>(x);
+  case TokenType::TOK_UINT32:
+    return static_cast<uint32_t>(x);
+  default:
+    return x;
+  }
+}
+
+inline static _ConstValue _makeBool(bool value) noexcept {
+  return _ConstValue{TokenType::TOK_KW_TRUE, value ? 1u : 0u, 0.0, nullptr};
+}
+
+inline static _ConstValue _makeInteger(TokenType type, uint64_t value) noexcept {
+  return _ConstValue{type, _truncate(type, value), 0.0, nullptr};
+}
+
+inline static _ConstValue _makeFloat(TokenType type, double value) noexcept {
+  if (type == TokenType::TOK_FLT32)
+    value = static_cast<float>(value);
+
+  return _ConstValue{type, 0, value, nullptr};
+}
+
+template<class T>
+static bool _computeCompare(TokenType op, T x, T y, bool &result) noexcept {
+  switch (op) {
+  case TokenType::TOK_OP_EQ:
+    result = x == y;
+    return true;
+  case TokenType::TOK_OP_NQ:
+    result = x != y;
+    return true;
+  case TokenType::TOK_OP_LT:
+    result = x < y;
+    return true;
+  case TokenType::TOK_OP_LEQ:
+    result = x <= y;
+    return true;
+  case TokenType::TOK_OP_GT:
+    result = x > y;
+    return true;
+  case TokenType::TOK_OP_GEQ:
+    result = x >= y;
+    return true;
+  default:
+    return false;
+  }
+}
+
+static bool _computeInteger(TokenType op, const _ConstValue &lhs,
+    const _ConstValue &rhs, _ConstValue &result) noexcept {
+  const TokenType type = lhs.type;
+  const bool issigned = _isSignedType(type);
+  const uint64_t x = lhs.num, y = rhs.num;
+
+  bool cmp;
+  if (issigned ? _computeCompare<int64_t>(op, x, y, cmp)
+      : _computeCompare<uint64_t>(op, x, y, cmp)) {
+    result = _makeBool(cmp);
+    return true;
+  }
+
+  switch (op) {
+  case TokenType::TOK_OP_ADD:
+    result = _makeInteger(type, x + y);
+    return true;
+  case TokenType::TOK_OP_SUB:
+    result = _makeInteger(type, x - y);
+    return true;
+  case TokenType::TOK_OP_MUL:
+    result = _makeInteger(type, x * y);
+    return true;
+  case TokenType::TOK_OP_DIV:
+  case TokenType::TOK_OP_MOD:
+    if (y == 0)
+      return false;
+
+    if (issigned) {
+      // INT64_MIN / -1 overflows
+      if (static_cast<int64_t>(y) == -1)
+        result = _makeInteger(type, op == TokenType::TOK_OP_DIV ? 0 - x : 0);
+      else if (op == TokenType::TOK_OP_DIV)
+        result = _makeInteger(type, static_cast<uint64_t>(
+              static_cast<int64_t>(x) / static_cast<int64_t>(y)));
+      else
+        result = _makeInteger(type, static_cast<uint64_t>(
+              static_cast<int64_t>(x) % static_cast<int64_t>(y)));
+    } else {
+      result = _makeInteger(type, op == TokenType::TOK_OP_DIV ? x / y : x % y);
+    }
+    return true;
+  case TokenType::TOK_OP_BAND:
+    result = _makeInteger(type, x & y);
+    return true;
+  case TokenType::TOK_OP_BOR:
+    result = _makeInteger(type, x | y);
+    return true;
+  case TokenType::TOK_OP_BXOR:
+    result = _makeInteger(type, x ^ y);
+    return true;
+  case TokenType::TOK_OP_LSH:
+  case TokenType::TOK_OP_RSH:
+    if (y >= _bitWidth(type))
+      return false;
+
+    if (op == TokenType::TOK_OP_LSH)
+      result = _makeInteger(type, x << y);
+    else if (issigned)
+      result = _makeInteger(type,
+          static_cast<uint64_t>(static_cast<int64_t>(x) >> y));
+    else
+      result = _makeInteger(type, x >> y);
+    return true;
+  default:
+    return false;
+  }
+}
+
+static bool _computeFloat(TokenType op, const _ConstValue &lhs,
+    const _ConstValue &rhs, _ConstValue &result) noexcept {
+  const double x = lhs.flt, y = rhs.flt;
+
+  bool cmp;
+  if (_computeCompare<double>(op, x, y, cmp)) {
+    result = _makeBool(cmp);
+    return true;
+  }
+
+  switch (op) {
+  case TokenType::TOK_OP_ADD:
+    result = _makeFloat(lhs.type, x + y);
+    break;
+  case TokenType::TOK_OP_SUB:
+    result = _makeFloat(lhs.type, x - y);
+    break;
+  case TokenType::TOK_OP_MUL:
+    result = _makeFloat(lhs.type, x * y);
+    break;
+  case TokenType::TOK_OP_DIV:
+    result = _makeFloat(lhs.type, x / y);
+    break;
+  default:
+    return false;
+  }
+
+  // infinity and NaN (e.g. division by zero) have no literals
+  return std::isfinite(result.flt);
+}
+
+static bool _computeBinary(TokenType op, const _ConstValue &lhs,
+    const _ConstValue &rhs, _ConstValue &result) noexcept {
+  if (lhs.type != rhs.type)
+    return false;
+
+  if (isIntegerType(lhs.type))
+    return _computeInteger(op, lhs, rhs, result);
+
+  if (isNumberType(lhs.type))
+    return _computeFloat(op, lhs, rhs, result);
+
+  if (lhs.type != TokenType::TOK_KW_TRUE)
+    return false;
+
+  switch (op) {
+  case TokenType::TOK_OP_EQ:
+    result = _makeBool(lhs.num == rhs.num);
+    return true;
+  case TokenType::TOK_OP_NQ:
+  case TokenType::TOK_OP_BXOR:
+    result = _makeBool(lhs.num != rhs.num);
+    return true;
+  case TokenType::TOK_OP_BAND:
+    result = _makeBool(lhs.num && rhs.num);
+    return true;
+  case TokenType::TOK_OP_BOR:
+    result = _makeBool(lhs.num || rhs.num);
+    return true;
+  default:
+    return false;
+  }
+}
+
+//! Returns operator of compound assignment op, otherwise TOK_OP_ASG
+static TokenType _assignmentOperator(TokenType op) noexcept {
+  switch (op) {
+  case TokenType::TOK_OP_ASG_AND:
+    return TokenType::TOK_OP_BAND;
+  case TokenType::TOK_OP_ASG_XOR:
+    return TokenType::TOK_OP_BXOR;
+  case TokenType::TOK_OP_ASG_OR:
+    return TokenType::TOK_OP_BOR;
+  case TokenType::TOK_OP_ASG_LSH:
+    return TokenType::TOK_OP_LSH;
+  case TokenType::TOK_OP_ASG_RSH:
+    return TokenType::TOK_OP_RSH;
+  case TokenType::TOK_OP_ASG_MOD:
+    return TokenType::TOK_OP_MOD;
+  case TokenType::TOK_OP_ASG_DIV:
+    return TokenType::TOK_OP_DIV;
+  case TokenType::TOK_OP_ASG_MUL:
+    return TokenType::TOK_OP_MUL;
+  case TokenType::TOK_OP_ASG_SUB:
+    return TokenType::TOK_OP_SUB;
+  case TokenType::TOK_OP_ASG_ADD:
+    return TokenType::TOK_OP_ADD;
+  default:
+    return TokenType::TOK_OP_ASG;
+  }
+}
+
+static _ConstValue *_findVariable(_ConstState &state,
+    const std::string &name) noexcept {
+  for (auto it = state.scopes.rbegin(); it != state.scopes.rend(); ++it) {
+    auto var = it->find(name);
+    if (var != it->end())
+      return &var->second;
+  }
+
+  return nullptr;
+}
+
+//! Number types and TOK_KW_TRUE of the built-in type names
+static const std::map<std::string, TokenType> _SCALAR_TYPES{
+  {"i8", TokenType::TOK_INT8}, {"i16", TokenType::TOK_INT16},
+  {"i32", TokenType::TOK_INT32}, {"i64", TokenType::TOK_INT64},
+  {"u8", TokenType::TOK_UINT8}, {"u16", TokenType::TOK_UINT16},
+  {"u32", TokenType::TOK_UINT32}, {"u64", TokenType::TOK_UINT64},
+  {"f32", TokenType::TOK_FLT32}, {"f64", TokenType::TOK_FLT64},
+  {"bool", TokenType::TOK_KW_TRUE},
+};
+
+/*!\return Returns true, if value could be converted to type (number type or
+ * TOK_KW_TRUE) without changing it, otherwise false.
+ */
+static bool _convertScalar(TokenType type, _ConstValue &value) noexcept {
+  if (value.type == type)
+    return true;
+
+  if (isIntegerType(type) && isIntegerType(value.type)) {
+    // sign changes and truncation change the value
+    const bool negative = _isSignedType(value.type)
+      && static_cast<int64_t>(value.num) < 0;
+    const bool large = !_isSignedType(value.type)
+      && value.num > static_cast<uint64_t>(INT64_MAX);
+    if ((negative && !_isSignedType(type))
+        || (large && _isSignedType(type))
+        || _truncate(type, value.num) != value.num)
+      return false;
+
+    value = _makeInteger(type, value.num);
+    return true;
+  }
+
+  if (isNumberType(type) && !isIntegerType(type)
+      && isNumberType(value.type) && !isIntegerType(value.type)) {
+    if (type == TokenType::TOK_FLT32
+        && static_cast<float>(value.flt) != value.flt)
+      return false;
+
+    value = _makeFloat(type, value.flt);
+    return true;
+  }
+
+  return false;
+}
+
+/*!\return Returns true, if value could be converted to the declared type
+ * (parameter or return type), otherwise false. Supported types are the
+ * built-in number types, bool and arrays ([type] and [type; length]) of
+ * elements with exactly that type.
+ * \param type Type expression
+ * \param value
+ * \param exact Don't convert the value (elements of shared arrays)
+ */
+static bool _convert(const Expr &type, _ConstValue &value,
+    bool exact = false) noexcept {
+  if (isTokenExpr(type, TokenType::TOK_ID)) {
+    auto it = _SCALAR_TYPES.find(type.toString());
+    if (it == _SCALAR_TYPES.end())
+      return false;
+
+    return exact ? value.type == it->second
+      : _convertScalar(it->second, value);
+  }
+
+  if (value.type != TokenType::TOK_OP_ARR_BRACKET_OPEN)
+    return false;
+
+  const Expr *elementType;
+  if (type == ExprType::EXPR_ARREMPTY) {
+    elementType = &dynamic_cast<const ArrayEmptyExpr&>(type).getType();
+  } else if (type == ExprType::EXPR_ARRCPY) {
+    const ArrayCpyExpr &arrtype = dynamic_cast<const ArrayCpyExpr&>(type);
+    const Expr &length = arrtype.getLength();
+    if (length.getType() != ExprType::EXPR_TOK
+        || !isIntegerType(dynamic_cast<const TokenExpr&>(length).getToken().getType())
+        || dynamic_cast<const NumberToken&>(
+          dynamic_cast<const TokenExpr&>(length).getToken()).u64()
+          != value.arr->size())
+      return false;
+
+    elementType = &arrtype.getValue();
+  } else {
+    return false;
+  }
+
+  for (_ConstValue &element : *value.arr) {
+    if (!_convert(*elementType, element, true))
+      return false;
+  }
+
+  return true;
+}
+
+static bool _evaluate(_ConstState &state, const Expr &expr,
+    _ConstValue &result) noexcept;
+static _ConstFlow _execute(_ConstState &state, const BodyExpr &body,
+    _ConstValue &result) noexcept;
+
+static bool _call(_ConstState &state, const FuncExpr &func,
+    std::vector<_ConstValue> &&args, _ConstValue &result) noexcept {
+  if (!func.getBody() || !func.getTemplates().empty()
+      || func.getParameters().size() != args.size()
+      || state.depth >= state.cfg.maxDepth)
+    return false;
+
+  // results are converted to the return type
+  if (!func.getReturn() && !func.isAutoReturnType())
+    return false;
+
+  _ConstScope params;
+  for (size_t i = 0; i < args.size(); ++i) {
+    const auto &param = *func.getParameters()[i];
+    if (!std::get<0>(param) || std::get<3>(param) || !std::get<2>(param)
+        || !_convert(*std::get<2>(param), args[i]))
+      return false;
+
+    params[std::get<0>(param)->toString(func.getLexer())] = std::move(args[i]);
+  }
+
+  // functions don't see the caller's variables
+  std::vector<_ConstScope> callerscopes;
+  std::swap(callerscopes, state.scopes);
+  state.scopes.push_back(std::move(params));
+  const FunctionScope *const callerscope = state.scope;
+  state.scope = state.funcs.definitions.at(&func);
+  state.depth++;
+
+  const _ConstFlow flow = _execute(state, *func.getBody(), result);
+
+  state.depth--;
+  state.scope = callerscope;
+  std::swap(callerscopes, state.scopes);
+
+  // result is required
+  return flow == _ConstFlow::RETURN && func.getBody()->getReturn()
+    && (!func.getReturn() || _convert(*func.getReturn(), result));
+}
+
+static bool _evaluateCall(_ConstState &state, const Expr &expr,
+    _ConstValue &result) noexcept {
+  std::vector<const Expr*> argexprs;
+  const FuncExpr *func = resolveCall(*state.scope, expr, argexprs);
+  if (!func || !func->hasCapabilities()
+      || !func->getCapabilities().isConstant())
+    return false;
+
+  std::vector<_ConstValue> args(argexprs.size());
+  for (size_t i = 0; i < argexprs.size(); ++i) {
+    if (!_evaluate(state, *argexprs[i], args[i]))
+      return false;
+  }
+
+  return _call(state, *func, std::move(args), result);
+}
+
+//! Returns storage of lhs of an assignment (variable or array element)
+static _ConstValue *_evaluateStorage(_ConstState &state,
+    const Expr &expr) noexcept {
+  if (isTokenExpr(expr, TokenType::TOK_ID))
+    return _findVariable(state, expr.toString());
+
+  if (isBiOpExpr(expr, TokenType::TOK_OP_ARR_BRACKET_OPEN)) {
+    const BiOpExpr &biopexpr = dynamic_cast<const BiOpExpr&>(expr);
+    _ConstValue *arr = _evaluateStorage(state, biopexpr.getLeft());
+    _ConstValue index;
+    if (!arr || arr->type != TokenType::TOK_OP_ARR_BRACKET_OPEN
+        || !_evaluate(state, biopexpr.getRight(), index)
+        || !isIntegerType(index.type)
+        || (_isSignedType(index.type) && static_cast<int64_t>(index.num) < 0)
+        || index.num >= arr->arr->size())
+      return nullptr;
+
+    return &(*arr->arr)[index.num];
+  }
+
+  return nullptr;
+}
+
+static bool _evaluateBiOp(_ConstState &state, const BiOpExpr &expr,
+    _ConstValue &result) noexcept {
+  const TokenType op = expr.getOperatorType();
+  switch (op) {
+  case TokenType::TOK_OP_BRACKET_OPEN:
+    return _evaluateCall(state, expr, result);
+  case TokenType::TOK_OP_ASG_DCL: {
+    if (!isTokenExpr(expr.getLeft(), TokenType::TOK_ID)
+        || !_evaluate(state, expr.getRight(), result))
+      return false;
+
+    state.scopes.back()[expr.getLeft().toString()] = result;
+    return true;
+  }
+  case TokenType::TOK_OP_LAND:
+  case TokenType::TOK_OP_LOR: {
+    if (!_evaluate(state, expr.getLeft(), result)
+        || result.type != TokenType::TOK_KW_TRUE)
+      return false;
+
+    // short-circuit
+    if (!!result.num == (op == TokenType::TOK_OP_LOR))
+      return true;
+
+    return _evaluate(state, expr.getRight(), result)
+      && result.type == TokenType::TOK_KW_TRUE;
+  }
+  case TokenType::TOK_OP_ARR_BRACKET_OPEN: {
+    _ConstValue arr, index;
+    if (!_evaluate(state, expr.getLeft(), arr)
+        || arr.type != TokenType::TOK_OP_ARR_BRACKET_OPEN
+        || !_evaluate(state, expr.getRight(), index)
+        || !isIntegerType(index.type)
+        || (_isSignedType(index.type) && static_cast<int64_t>(index.num) < 0)
+        || index.num >= arr.arr->size())
+      return false;
+
+    result = (*arr.arr)[index.num];
+    return true;
+  }
+  default:
+    break;
+  }
+
+  const TokenType asgop = _assignmentOperator(op);
+  if (asgop != TokenType::TOK_OP_ASG || op == TokenType::TOK_OP_ASG) {
+    _ConstValue value;
+    if (!_evaluate(state, expr.getRight(), value))
+      return false;
+
+    _ConstValue *storage = _evaluateStorage(state, expr.getLeft());
+    if (!storage)
+      return false;
+
+    if (op == TokenType::TOK_OP_ASG) {
+      // variables don't change their type, arrays mustn't contain themselves
+      if (storage->type != value.type
+          || (value.type == TokenType::TOK_OP_ARR_BRACKET_OPEN
+            && !isTokenExpr(expr.getLeft(), TokenType::TOK_ID)))
+        return false;
+
+      *storage = value;
+    } else if (!_computeBinary(asgop, *storage, value, *storage)) {
+      return false;
+    }
+
+    result = *storage;
+    return true;
+  }
+
+  _ConstValue lhs, rhs;
+  return _evaluate(state, expr.getLeft(), lhs)
+    && _evaluate(state, expr.getRight(), rhs)
+    && _computeBinary(op, lhs, rhs, result);
+}
+
+static bool _evaluateUnOp(_ConstState &state, const UnOpExpr &expr,
+    _ConstValue &result) noexcept {
+  if (expr.getOperatorType() == TokenType::TOK_OP_BRACKET_OPEN)
+    return _evaluateCall(state, expr, result);
+
+  if (!_evaluate(state, expr.getExpression(), result))
+    return false;
+
+  switch (expr.getOperatorType()) {
+  case TokenType::TOK_OP_ADD:
+  case TokenType::TOK_OP_POS:
+    return isNumberType(result.type);
+  case TokenType::TOK_OP_SUB:
+  case TokenType::TOK_OP_NEG:
+    if (isIntegerType(result.type))
+      result = _makeInteger(result.type, 0 - result.num);
+    else if (isNumberType(result.type))
+      result = _makeFloat(result.type, -result.flt);
+    else
+      return false;
+    return true;
+  case TokenType::TOK_OP_LN:
+    if (result.type != TokenType::TOK_KW_TRUE)
+      return false;
+
+    result = _makeBool(!result.num);
+    return true;
+  case TokenType::TOK_OP_BN:
+    if (!isIntegerType(result.type))
+      return false;
+
+    result = _makeInteger(result.type, ~result.num);
+    return true;
+  default:
+    return false;
+  }
+}
+
+static bool _evaluateToken(_ConstState &state, const TokenExpr &expr,
+    _ConstValue &result) noexcept {
+  const Token &tok = expr.getToken();
+  switch (tok.getType()) {
+  case TokenType::TOK_ID: {
+    const _ConstValue *var = _findVariable(state, expr.toString());
+    if (!var)
+      return false;
+
+    result = *var;
+    return true;
+  }
+  case TokenType::TOK_KW_TRUE:
+  case TokenType::TOK_KW_FALSE:
+    result = _makeBool(tok.getType() == TokenType::TOK_KW_TRUE);
+    return true;
+  default:
+    break;
+  }
+
+  if (!isNumberType(tok.getType()))
+    return false;
+
+  const NumberToken &numtok = dynamic_cast<const NumberToken&>(tok);
+  switch (tok.getType()) {
+  case TokenType::TOK_FLT32:
+    result = _makeFloat(tok.getType(), numtok.f32());
+    break;
+  case TokenType::TOK_FLT64:
+    result = _makeFloat(tok.getType(), numtok.f64());
+    break;
+  default:
+    result = _makeInteger(tok.getType(), numtok.u64());
+    break;
+  }
+
+  return true;
+}
+
+static bool _evaluate(_ConstState &state, const Expr &expr,
+    _ConstValue &result) noexcept {
+  if (++state.steps > state.cfg.maxSteps)
+    return false;
+
+  switch (expr.getType()) {
+  case ExprType::EXPR_TOK:
+    return _evaluateToken(state, dynamic_cast<const TokenExpr&>(expr), result);
+  case ExprType::EXPR_BIOP:
+    return _evaluateBiOp(state, dynamic_cast<const BiOpExpr&>(expr), result);
+  case ExprType::EXPR_UNOP:
+    return _evaluateUnOp(state, dynamic_cast<const UnOpExpr&>(expr), result);
+  case ExprType::EXPR_ARRLIT: {
+    const ArrayLitExpr &arrexpr = dynamic_cast<const ArrayLitExpr&>(expr);
+    auto arr = std::make_shared<_ConstArray>(arrexpr.getValues().size());
+    size_t i = 0;
+    for (const auto &value : arrexpr.getValues()) {
+      if (!_evaluate(state, *value, (*arr)[i++]))
+        return false;
+    }
+
+    result = _ConstValue{TokenType::TOK_OP_ARR_BRACKET_OPEN, 0, 0.0, arr};
+    return true;
+  }
+  case ExprType::EXPR_ARRCPY: {
+    const ArrayCpyExpr &arrexpr = dynamic_cast<const ArrayCpyExpr&>(expr);
+    _ConstValue value, length;
+    if (!_evaluate(state, arrexpr.getValue(), value)
+        || !_evaluate(state, arrexpr.getLength(), length)
+        || !isIntegerType(length.type)
+        || (_isSignedType(length.type) && static_cast<int64_t>(length.num) < 0)
+        || length.num > state.cfg.maxArrayLength
+        // elements would be shared
+        || value.type == TokenType::TOK_OP_ARR_BRACKET_OPEN)
+      return false;
+
+    result = _ConstValue{TokenType::TOK_OP_ARR_BRACKET_OPEN, 0, 0.0,
+      std::make_shared<_ConstArray>(length.num, value)};
+    return true;
+  }
+  default:
+    return false;
+  }
+}
+
+static _ConstFlow _executeExpr(_ConstState &state, const Expr &expr,
+    _ConstValue &result) noexcept;
+
+static _ConstFlow _executeIf(_ConstState &state, const IfExpr &expr,
+    _ConstValue &result) noexcept {
+  for (const auto &ifcase : expr.getCases()) {
+    _ConstValue cond;
+    if (!_evaluate(state, *std::get<0>(ifcase), cond)
+        || cond.type != TokenType::TOK_KW_TRUE)
+      return _ConstFlow::FAIL;
+
+    if (cond.num)
+      return _execute(state, *std::get<1>(ifcase), result);
+  }
+
+  if (expr.getElse())
+    return _execute(state, *expr.getElse(), result);
+
+  return _ConstFlow::NEXT;
+}
+
+static _ConstFlow _executeLoop(_ConstState &state, const LoopExpr &expr,
+    _ConstValue &result) noexcept {
+  // scope of initialization
+  state.scopes.emplace_back();
+
+  _ConstValue value;
+  _ConstFlow flow = _ConstFlow::NEXT;
+  if (expr.getInitialization()
+      && !_evaluate(state, *expr.getInitialization(), value))
+    flow = _ConstFlow::FAIL;
+
+  bool first = true;
+  while (flow == _ConstFlow::NEXT) {
+    if (!first || expr.getType() == ExprType::EXPR_LOOP_FOR) {
+      if (!_evaluate(state, expr.getCondition(), value)
+          || value.type != TokenType::TOK_KW_TRUE) {
+        flow = _ConstFlow::FAIL;
+        break;
+      }
+
+      if (!value.num)
+        break;
+    }
+
+    first = false;
+
+    flow = _execute(state, expr.getBody(), result);
+    if (flow == _ConstFlow::BREAK) {
+      flow = _ConstFlow::NEXT;
+      break;
+    }
+
+    if (flow == _ConstFlow::CONTINUE)
+      flow = _ConstFlow::NEXT;
+
+    if (flow == _ConstFlow::NEXT && expr.getIterator()
+        && !_evaluate(state, *expr.getIterator(), value))
+      flow = _ConstFlow::FAIL;
+  }
+
+  state.scopes.pop_back();
+
+  return flow;
+}
+
+static _ConstFlow _executeExpr(_ConstState &state, const Expr &expr,
+    _ConstValue &result) noexcept {
+  switch (expr.getType()) {
+  case ExprType::EXPR_IF:
+    return _executeIf(state, dynamic_cast<const IfExpr&>(expr), result);
+  case ExprType::EXPR_LOOP_FOR:
+  case ExprType::EXPR_LOOP_DO:
+    return _executeLoop(state, dynamic_cast<const LoopExpr&>(expr), result);
+  default: {
+    _ConstValue value;
+    return _evaluate(state, expr, value) ? _ConstFlow::NEXT : _ConstFlow::FAIL;
+  }
+  }
+}
+
+static _ConstFlow _execute(_ConstState &state, const BodyExpr &body,
+    _ConstValue &result) noexcept {
+  state.scopes.emplace_back();
+
+  _ConstFlow flow = _ConstFlow::NEXT;
+  for (auto it = body.getExpressions().begin();
+      flow == _ConstFlow::NEXT && it != body.getExpressions().end(); ++it)
+    flow = _executeExpr(state, **it, result);
+
+  if (flow == _ConstFlow::NEXT) {
+    switch (body.getReturnType()) {
+    case ReturnControlType::RETURN:
+      flow = !body.getReturn() || _evaluate(state, *body.getReturn(), result)
+        ? _ConstFlow::RETURN : _ConstFlow::FAIL;
+      break;
+    case ReturnControlType::BREAK:
+      flow = _ConstFlow::BREAK;
+      break;
+    case ReturnControlType::CONTINUE:
+      flow = _ConstFlow::CONTINUE;
+      break;
+    default:
+      break;
+    }
+  }
+
+  state.scopes.pop_back();
+
+  return flow;
+}
+
+static std::unique_ptr<Expr> _createExpr(const Lexer &lexer,
+    const Position &pos, const _ConstValue &value) noexcept {
+  switch (value.type) {
+  case TokenType::TOK_KW_TRUE:
+    return std::make_unique<FakeTokenExpr>(lexer, std::make_unique<Token>(
+          nullptr, value.num ? TokenType::TOK_KW_TRUE : TokenType::TOK_KW_FALSE,
+          pos));
+  case TokenType::TOK_FLT32:
+    return std::make_unique<FakeTokenExpr>(lexer, std::make_unique<NumberToken>(
+          nullptr, value.type, pos, static_cast<float>(value.flt)));
+  case TokenType::TOK_FLT64:
+    return std::make_unique<FakeTokenExpr>(lexer, std::make_unique<NumberToken>(
+          nullptr, value.type, pos, value.flt));
+  case TokenType::TOK_OP_ARR_BRACKET_OPEN:
+    break;
+  default:
+    return std::make_unique<FakeTokenExpr>(lexer, std::make_unique<NumberToken>(
+          nullptr, value.type, pos, value.num));
+  }
+
+  const _ConstArray &arr = *value.arr;
+  if (arr.empty())
+    return nullptr;
+
+  // [value; length], if all elements are equal
+  bool equal = arr.front().type != TokenType::TOK_OP_ARR_BRACKET_OPEN;
+  for (auto it = arr.begin(); equal && it != arr.end(); ++it)
+    equal = it->type == arr.front().type && it->num == arr.front().num
+      && it->flt == arr.front().flt;
+
+  if (equal)
+    return std::make_unique<ArrayCpyExpr>(lexer, pos,
+        _createExpr(lexer, pos, arr.front()),
+        _createExpr(lexer, pos, _makeInteger(TokenType::TOK_INT32, arr.size())));
+
+  if (arr.size() < 2)
+    return nullptr;
+
+  std::list<std::unique_ptr<Expr>> values;
+  for (const _ConstValue &element : arr) {
+    values.push_back(_createExpr(lexer, pos, element));
+    if (!values.back())
+      return nullptr;
+  }
+
+  return std::make_unique<ArrayLitExpr>(lexer, pos, std::move(values));
+}
+
+/*!\brief Replaces evaluable calls in expr
+ * \param expr
+ * \param cfg
+ * \param funcs
+ * \param scope Program or module around expr
+ * \param reducedexpressions
+ */
+static std::unique_ptr<Expr> _evaluateCalls(std::unique_ptr<Expr> &&expr,
+    const ConstantConfiguration &cfg, const FunctionTable &funcs,
+    const FunctionScope *scope, size_t &reducedexpressions) noexcept {
+  if (*expr == ExprType::EXPR_PROG || *expr == ExprType::EXPR_MOD) {
+    auto it = funcs.scopes.find(expr.get());
+    scope = it != funcs.scopes.end() ? &it->second : nullptr;
+  }
+
+  expr->rewriteChildren([&](std::unique_ptr<Expr> &&child) {
+      return _evaluateCalls(std::move(child), cfg, funcs, scope,
+          reducedexpressions);
+    });
+
+  if (!scope || (!isBiOpExpr(*expr, TokenType::TOK_OP_BRACKET_OPEN)
+        && !isUnOpExpr(*expr, TokenType::TOK_OP_BRACKET_OPEN)))
+    return std::move(expr);
+
+  _ConstState state{cfg, funcs, scope, {_ConstScope()}, 0, 0};
+  _ConstValue value;
+  if (!_evaluateCall(state, *expr, value))
+    return std::move(expr);
+
+  std::unique_ptr<Expr> result =
+    _createExpr(expr->getLexer(), expr->getPosition(), value);
+  if (!result)
+    return std::move(expr);
+
+  reducedexpressions++;
+
+  return result;
+}
+
+std::unique_ptr<Expr> pfederc::evaluateConstantFunctions(
+    std::unique_ptr<Expr> &&expr, const ConstantConfiguration &cfg,
+    size_t &reducedexpressions) noexcept {
+  const FunctionTable funcs = collectFunctions(*expr);
+  return _evaluateCalls(std::move(expr), cfg, funcs, nullptr,
+      reducedexpressions);
+}
@@ -0,0 +1,395 @@
+#include "pfederc/syntax_optimizer.hpp"
+using namespace pfederc;
+
+typedef std::map<std::string, std::unique_ptr<Expr>> _InlineArguments;
+
+struct _InlineState {
+  const FunctionTable &funcs;
+  const std::set<const FuncExpr*> &candidates;
+  const FunctionScope *scope; //!< Program or module, which is rewritten
+  const FuncExpr *current; //!< Function, which is currently rewritten
+  //! Names declared in current (and functions around it)
+  std::set<std::string> declared;
+  std::vector<InlineRecord> &inlined;
+  size_t &reducedexpressions;
+  bool changed;
+};
+
+inline static bool _isMemberAccess(const BiOpExpr &expr) noexcept {
+  return expr.getOperatorType() == TokenType::TOK_OP_MEM
+    || expr.getOperatorType() == TokenType::TOK_OP_DMEM;
+}
+
+//! Returns true, if expr consists of tokens, unary and binary operators only
+static bool _isInlineable(const Expr &expr) noexcept {
+  switch (expr.getType()) {
+  case ExprType::EXPR_TOK:
+    return true;
+  case ExprType::EXPR_BIOP:
+  case ExprType::EXPR_UNOP: {
+    bool result = true;
+    expr.forEachChild([&result](const Expr &child) {
+        result = result && _isInlineable(child);
+      });
+    return result;
+  }
+  default:
+    return false;
+  }
+}
+
+//! Counts references to identifier name (member identifiers excluded)
+static size_t _countIdentifier(const Expr &expr, const std::string &name) noexcept {
+  if (isTokenExpr(expr, TokenType::TOK_ID))
+    return expr.toString() == name ? 1 : 0;
+
+  if (expr.getType() == ExprType::EXPR_BIOP
+      && _isMemberAccess(dynamic_cast<const BiOpExpr&>(expr)))
+    return _countIdentifier(dynamic_cast<const BiOpExpr&>(expr).getLeft(), name);
+
+  size_t result = 0;
+  expr.forEachChild([&result, &name](const Expr &child) {
+      result += _countIdentifier(child, name);
+    });
+
+  return result;
+}
+
+//! Inserts identifiers referenced by expr (member identifiers excluded)
+static void _collectIdentifiers(const Expr &expr,
+    std::set<std::string> &names) noexcept {
+  if (isTokenExpr(expr, TokenType::TOK_ID)) {
+    names.insert(expr.toString());
+    return;
+  }
+
+  if (expr.getType() == ExprType::EXPR_BIOP
+      && _isMemberAccess(dynamic_cast<const BiOpExpr&>(expr))) {
+    _collectIdentifiers(dynamic_cast<const BiOpExpr&>(expr).getLeft(), names);
+    return;
+  }
+
+  expr.forEachChild([&names](const Expr &child) {
+      _collectIdentifiers(child, names);
+    });
+}
+
+//! Marks calls in the evaluation order of _collectEvaluation
+constexpr size_t _EVAL_CALL = std::numeric_limits<size_t>::max();
+
+/*!\brief Appends the positions of parameters referenced by expr in
+ * evaluation order (left to right). Calls (side effects) are appended as
+ * _EVAL_CALL after their operands.
+ * \param expr
+ * \param params Parameter names and their positions
+ * \param result
+ */
+static void _collectEvaluation(const Expr &expr,
+    const std::map<std::string, size_t> &params,
+    std::vector<size_t> &result) noexcept {
+  if (isTokenExpr(expr, TokenType::TOK_ID)) {
+    auto it = params.find(expr.toString());
+    if (it != params.end())
+      result.push_back(it->second);
+
+    return;
+  }
+
+  if (expr.getType() == ExprType::EXPR_BIOP
+      && _isMemberAccess(dynamic_cast<const BiOpExpr&>(expr))) {
+    _collectEvaluation(dynamic_cast<const BiOpExpr&>(expr).getLeft(),
+        params, result);
+    return;
+  }
+
+  expr.forEachChild([&params, &result](const Expr &child) {
+      _collectEvaluation(child, params, result);
+    });
+
+  if (isBiOpExpr(expr, TokenType::TOK_OP_BRACKET_OPEN)
+      || isUnOpExpr(expr, TokenType::TOK_OP_BRACKET_OPEN))
+    result.push_back(_EVAL_CALL);
+}
+
+/*!\return Returns true, if the arguments of params are evaluated the same
+ * way in the inlined expr as in a call: each exactly once, in declaration
+ * order and before any call in expr.
+ * \param expr
+ * \param params Names of parameters, whose arguments aren't tokens (in
+ * declaration order)
+ */
+static bool _isEvaluatedInOrder(const Expr &expr,
+    const std::vector<std::string> &params) noexcept {
+  std::map<std::string, size_t> positions;
+  for (size_t i = 0; i < params.size(); ++i)
+    positions.emplace(params[i], i);
+
+  std::vector<size_t> order;
+  _collectEvaluation(expr, positions, order);
+  if (order.size() < params.size())
+    return false;
+
+  for (size_t i = 0; i < order.size(); ++i) {
+    if (order[i] != (i < params.size() ? i : _EVAL_CALL))
+      return false;
+  }
+
+  return true;
+}
+
+static std::vector<std::unique_ptr<Expr>> _takeArguments(
+    std::unique_ptr<Expr> &&args) noexcept {
+  std::vector<std::unique_ptr<Expr>> result;
+  while (isBiOpExpr(*args, TokenType::TOK_OP_COMMA)) {
+    BiOpExpr &comma = dynamic_cast<BiOpExpr&>(*args);
+    result.insert(result.begin(), comma.getRightPtr());
+    args = comma.getLeftPtr();
+  }
+
+  result.insert(result.begin(), std::move(args));
+
+  return result;
+}
+
+static std::unique_ptr<Token> _cloneToken(const Lexer &lexer,
+    const Token &tok) noexcept {
+  if (isNumberType(tok.getType()))
+    return std::make_unique<NumberToken>(tok.getLast(), tok.getType(),
+        tok.getPosition(), dynamic_cast<const NumberToken&>(tok).u64());
+
+  if (const auto *idtok = dynamic_cast<const IdentifierToken*>(&tok))
+    return std::make_unique<IdentifierToken>(tok.getLast(), tok.getPosition(),
+        idtok->getIdentifier());
+
+  if (dynamic_cast<const StringToken*>(&tok))
+    return std::make_unique<StringToken>(tok.getLast(), tok.getType(),
+        tok.getPosition(), tok.toString(lexer));
+
+  return std::make_unique<Token>(tok.getLast(), tok.getType(), tok.getPosition());
+}
+
+/*!\return Returns copy of expr (see _isInlineable) with identifiers replaced
+ * by args.
+ * \param expr
+ * \param args Arguments which aren't tokens are moved (used exactly once)
+ * \param pos Position of generated operator expressions (call position)
+ */
+static std::unique_ptr<Expr> _cloneExpr(const Expr &expr,
+    _InlineArguments &args, const Position &pos) noexcept {
+  _InlineArguments noargs;
+  switch (expr.getType()) {
+  case ExprType::EXPR_TOK: {
+    const TokenExpr &tokexpr = dynamic_cast<const TokenExpr&>(expr);
+    if (tokexpr.getToken() == TokenType::TOK_ID) {
+      auto it = args.find(tokexpr.toString());
+      if (it != args.end()) {
+        if (*it->second == ExprType::EXPR_TOK)
+          return _cloneExpr(*it->second, noargs, pos);
+
+        return std::move(it->second);
+      }
+    }
+
+    if (dynamic_cast<const FakeTokenExpr*>(&tokexpr))
+      return std::make_unique<FakeTokenExpr>(expr.getLexer(),
+          _cloneToken(expr.getLexer(), tokexpr.getToken()));
+
+    // tokens owned by the lexer are never modified
+    return std::make_unique<TokenExpr>(expr.getLexer(),
+        const_cast<Token*>(tokexpr.getTokenPtr()));
+  }
+  case ExprType::EXPR_BIOP: {
+    const BiOpExpr &biopexpr = dynamic_cast<const BiOpExpr&>(expr);
+    std::unique_ptr<Expr> lhs = _cloneExpr(biopexpr.getLeft(), args, pos);
+    std::unique_ptr<Expr> rhs = _cloneExpr(biopexpr.getRight(),
+        _isMemberAccess(biopexpr) ? noargs : args, pos);
+
+    return std::make_unique<BiOpExpr>(expr.getLexer(), pos,
+        &biopexpr.getOperatorToken(), biopexpr.getOperatorType(),
+        std::move(lhs), std::move(rhs));
+  }
+  case ExprType::EXPR_UNOP: {
+    const UnOpExpr &unopexpr = dynamic_cast<const UnOpExpr&>(expr);
+    return std::make_unique<UnOpExpr>(expr.getLexer(), pos,
+        &unopexpr.getOperatorToken(),
+        _cloneExpr(unopexpr.getExpression(), args, pos));
+  }
+  default:
+    fatal(__FILE__, __LINE__, "Unexpected expression in inlined function");
+    return nullptr;
+  }
+}
+
+static bool _isInlineCandidate(const FuncExpr &func,
+    const InlineConfiguration &cfg) noexcept {
+  if (!func.getBody() || !func.getTemplates().empty())
+    return false;
+
+  const BodyExpr &body = *func.getBody();
+  if (!body.getExpressions().empty() || !body.getReturn()
+      || body.getReturnType() != ReturnControlType::RETURN)
+    return false;
+
+  for (const auto &param : func.getParameters()) {
+    // unnamed parameters and guards
+    if (!std::get<0>(*param) || std::get<3>(*param))
+      return false;
+  }
+
+  const Expr &retexpr = *body.getReturn();
+  if (!_isInlineable(retexpr)
+      || _countIdentifier(retexpr,
+        func.getIdentifier().toString(func.getLexer())) != 0)
+    return false;
+
+  if (func.hasCapabilities() && func.getCapabilities().isInline())
+    return true;
+
+  return countExprNodes(retexpr) <= cfg.maxInlineSize;
+}
+
+static std::set<const FuncExpr*> _collectInlineCandidates(
+    const FunctionTable &funcs, const InlineConfiguration &cfg) noexcept {
+  std::set<const FuncExpr*> result;
+  for (const auto &entry : funcs.definitions) {
+    if (_isInlineCandidate(*entry.first, cfg))
+      result.insert(entry.first);
+  }
+
+  return result;
+}
+
+//! Returns true, if scope is ancestor (or equal) of other
+static bool _isOuterScope(const FunctionScope *scope,
+    const FunctionScope *other) noexcept {
+  for (; other; other = other->parent) {
+    if (other == scope)
+      return true;
+  }
+
+  return false;
+}
+
+/*!\return Returns true, if name refers to the same definition in the
+ * callee's scope as in the caller's scope: no scope between them (up to
+ * their common enclosing scope) defines name.
+ * \param caller Scope of the call
+ * \param callee Scope of the called function
+ * \param name
+ */
+static bool _isSameBinding(const FunctionScope *caller,
+    const FunctionScope *callee, const std::string &name) noexcept {
+  for (const FunctionScope *scope = callee;
+      scope && !_isOuterScope(scope, caller); scope = scope->parent) {
+    if (scope->names.count(name))
+      return false;
+  }
+
+  for (const FunctionScope *scope = caller;
+      scope && !_isOuterScope(scope, callee); scope = scope->parent) {
+    if (scope->names.count(name))
+      return false;
+  }
+
+  return true;
+}
+
+static std::unique_ptr<Expr> _inlineCalls(std::unique_ptr<Expr> &&expr,
+    _InlineState &state) noexcept {
+  const FunctionScope *const outerScope = state.scope;
+  const FuncExpr *const outer = state.current;
+  std::set<std::string> outerDeclared;
+  if (*expr == ExprType::EXPR_PROG || *expr == ExprType::EXPR_MOD) {
+    auto it = state.funcs.scopes.find(expr.get());
+    state.scope = it != state.funcs.scopes.end() ? &it->second : nullptr;
+  } else if (*expr == ExprType::EXPR_FUNC) {
+    state.current = dynamic_cast<const FuncExpr*>(expr.get());
+    outerDeclared = state.declared;
+    collectDeclarations(*expr, state.declared);
+  }
+
+  expr->rewriteChildren([&state](std::unique_ptr<Expr> &&child) {
+      return _inlineCalls(std::move(child), state);
+    });
+
+  state.scope = outerScope;
+  if (state.current != outer) {
+    state.current = outer;
+    state.declared = std::move(outerDeclared);
+  }
+
+  if (!state.scope)
+    return std::move(expr);
+
+  std::vector<const Expr*> args;
+  const FuncExpr *const func = resolveCall(*state.scope, *expr, args);
+  if (!func || !state.candidates.count(func) || func == state.current)
+    return std::move(expr);
+
+  const FuncExpr &callee = *func;
+  const auto &params = callee.getParameters();
+  if (params.size() != args.size())
+    return std::move(expr);
+
+  const Expr &retexpr = *callee.getBody()->getReturn();
+  std::vector<std::string> names, evaluated;
+  for (size_t i = 0; i < params.size(); ++i) {
+    names.push_back(std::get<0>(*params[i])->toString(callee.getLexer()));
+    if (args[i]->getType() != ExprType::EXPR_TOK)
+      evaluated.push_back(names.back());
+  }
+
+  // evaluation of arguments must not be dropped, duplicated or reordered
+  if (!_isEvaluatedInOrder(retexpr, evaluated))
+    return std::move(expr);
+
+  // free names of the callee must not be captured by the caller's function
+  // or by scopes between caller and callee
+  const FunctionScope *const calleeScope = state.funcs.definitions.at(func);
+  std::set<std::string> identifiers;
+  _collectIdentifiers(retexpr, identifiers);
+  for (const std::string &name : identifiers) {
+    if (std::find(names.begin(), names.end(), name) == names.end()
+        && (state.declared.count(name)
+          || !_isSameBinding(state.scope, calleeScope, name)))
+      return std::move(expr);
+  }
+
+  const Position pos(expr->getPosition());
+  std::vector<std::unique_ptr<Expr>> ownedArgs;
+  if (*expr == ExprType::EXPR_BIOP)
+    ownedArgs = _takeArguments(dynamic_cast<BiOpExpr&>(*expr).getRightPtr());
+
+  _InlineArguments inlineArgs;
+  for (size_t i = 0; i < names.size(); ++i)
+    inlineArgs.emplace(names[i], std::move(ownedArgs[i]));
+
+  std::unique_ptr<Expr> result = _cloneExpr(retexpr, inlineArgs, pos);
+
+  state.inlined.push_back(InlineRecord(&callee, pos));
+  state.reducedexpressions++;
+  state.changed = true;
+
+  return result;
+}
+
+std::unique_ptr<Expr> pfederc::inlineFunctions(std::unique_ptr<Expr> &&expr,
+    const InlineConfiguration &cfg, std::vector<InlineRecord> &inlined,
+    size_t &reducedexpressions) noexcept {
+  for (size_t i = 0; i < cfg.maxIterations; ++i) {
+    // function bodies change with every iteration
+    const FunctionTable funcs = collectFunctions(*expr);
+    const std::set<const FuncExpr*> candidates =
+      _collectInlineCandidates(funcs, cfg);
+    if (candidates.empty())
+      break;
+
+    _InlineState state{funcs, candidates, nullptr, nullptr, {}, inlined,
+      reducedexpressions, false};
+    expr = _inlineCalls(std::move(expr), state);
+    if (!state.changed)
+      break;
+  }
+
+  return std::move(expr);
+}
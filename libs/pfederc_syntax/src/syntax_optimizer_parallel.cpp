@@ -0,0 +1,116 @@
+#include "pfederc/syntax_optimizer.hpp"
+using namespace pfederc;
+
+inline static bool _isDefinition(const Expr &expr) noexcept {
+  switch (expr.getType()) {
+  case ExprType::EXPR_FUNC:
+  case ExprType::EXPR_CLASS:
+  case ExprType::EXPR_TRAIT:
+  case ExprType::EXPR_TRAITIMPL:
+    return true;
+  default:
+    return false;
+  }
+}
+
+//! Returns name of definition expr (see _isDefinition) for trace spans
+static std::string _definitionName(const Expr &expr) noexcept {
+  const Lexer &lexer = expr.getLexer();
+  switch (expr.getType()) {
+  case ExprType::EXPR_FUNC:
+    return dynamic_cast<const FuncExpr&>(expr).getIdentifier()
+      .toString(lexer);
+  case ExprType::EXPR_CLASS:
+    return dynamic_cast<const ClassExpr&>(expr).getIdentifier()
+      .toString(lexer);
+  case ExprType::EXPR_TRAIT:
+    return dynamic_cast<const TraitExpr&>(expr).getIdentifier()
+      .toString(lexer);
+  case ExprType::EXPR_TRAITIMPL: {
+    const TraitImplExpr &impl = dynamic_cast<const TraitImplExpr&>(expr);
+    return impl.getIdentifier().toString(lexer) + ':'
+      + impl.getImplementedTrait().toString();
+  }
+  default:
+    return std::string();
+  }
+}
+
+inline static bool _isScope(const Expr &expr) noexcept {
+  return expr.getType() == ExprType::EXPR_PROG
+    || expr.getType() == ExprType::EXPR_MOD;
+}
+
+//! Collects definitions in program and module scope (in code order)
+static void _collectDefinitions(Expr &expr, std::vector<Expr*> &defs) noexcept {
+  expr.rewriteChildren([&defs](std::unique_ptr<Expr> &&child) {
+      if (_isDefinition(*child))
+        defs.push_back(child.get());
+      else if (_isScope(*child))
+        _collectDefinitions(*child, defs);
+
+      return std::move(child);
+    });
+}
+
+//! Runs pass on everything in program and module scope except definitions
+static void _runOutsideDefinitions(const OptimizerPassFunction &pass,
+    Expr &expr, OptimizerStats &stats) noexcept {
+  expr.rewriteChildren([&pass, &stats](std::unique_ptr<Expr> &&child) {
+      if (_isDefinition(*child))
+        return std::move(child);
+
+      if (_isScope(*child)) {
+        _runOutsideDefinitions(pass, *child, stats);
+        return std::move(child);
+      }
+
+      return pass(std::move(child), stats);
+    });
+}
+
+std::unique_ptr<Expr> pfederc::runLocalPassParallel(
+    const OptimizerPassFunction &pass, std::unique_ptr<Expr> &&expr,
+    OptimizerStats &stats, TaskScheduler &scheduler) noexcept {
+  if (scheduler.getThreads() <= 1 || !_isScope(*expr))
+    return pass(std::move(expr), stats);
+
+  std::vector<Expr*> defs;
+  _collectDefinitions(*expr, defs);
+  if (defs.size() < 2)
+    return pass(std::move(expr), stats);
+
+  std::vector<OptimizerStats> defstats(defs.size());
+  for (size_t i = 0; i < defs.size(); ++i) {
+    Expr *const def = defs[i];
+    OptimizerStats &taskstats = defstats[i];
+    scheduler.spawn([&pass, def, &taskstats](TaskScheduler &) {
+        ScopedSpan span("optimize",
+            instrumentation::isTracing() ? _definitionName(*def) : "",
+            def->getLexer().getFilePath());
+        def->rewriteChildren([&pass, &taskstats](std::unique_ptr<Expr> &&child) {
+            return pass(std::move(child), taskstats);
+          });
+
+        return TaskStatus::DONE;
+      });
+  }
+
+  // the calling thread is a worker too
+  scheduler.run();
+
+  for (const OptimizerStats &taskstats : defstats)
+    stats.merge(taskstats);
+
+  _runOutsideDefinitions(pass, *expr, stats);
+
+  return std::move(expr);
+}
+
+std::unique_ptr<Expr> pfederc::optimizeAll(std::unique_ptr<Expr> &&expr,
+    OptimizerStats &stats, TaskScheduler &scheduler) noexcept {
+  return runLocalPassParallel(
+      [](std::unique_ptr<Expr> &&expr, OptimizerStats &stats) {
+        return optimizeAll(std::move(expr), stats);
+      }, std::move(expr), stats, scheduler);
+}
@@ -0,0 +1,113 @@
+#include "pfederc/syntax_optimizer.hpp"
+using namespace pfederc;
+
+const char *pfederc::optimizerRuleToString(OptimizerRule rule) noexcept {
+  switch (rule) {
+  case OptimizerRule::STRING_MERGE:
+    return "string-merge";
+  case OptimizerRule::NUMBER_FOLD:
+    return "number-fold";
+  case OptimizerRule::NUMBER_COMPARE:
+    return "number-compare";
+  case OptimizerRule::INLINE:
+    return "inline";
+  case OptimizerRule::CONSTANT_CALL:
+    return "constant-call";
+  default:
+    fatal(__FILE__, __LINE__, "Unknown optimizer rule");
+    return "";
+  }
+}
+
+// OptimizerStats
+OptimizerStats::OptimizerStats() noexcept
+    : rules{}, iterations{0} {
+}
+
+OptimizerStats::~OptimizerStats() {
+}
+
+size_t OptimizerStats::getRewrites() const noexcept {
+  size_t result = 0;
+  for (size_t count : rules)
+    result += count;
+
+  return result;
+}
+
+void OptimizerStats::merge(const OptimizerStats &stats) noexcept {
+  for (size_t i = 0; i < OPTIMIZER_RULE_COUNT; ++i)
+    rules[i] += stats.rules[i];
+
+  iterations += stats.iterations;
+  passes.insert(passes.end(), stats.passes.begin(), stats.passes.end());
+}
+
+inline static double _toMilliseconds(std::chrono::nanoseconds duration) noexcept {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void OptimizerStats::printText(std::ostream &out) const noexcept {
+  for (const auto &pass : passes) {
+    out << "pass " << pass.name << ": "
+        << pass.nodesBefore << " -> " << pass.nodesAfter << " nodes, "
+        << pass.iterations << " iterations, "
+        << pass.rewrites << " rewrites, "
+        << _toMilliseconds(pass.duration) << " ms" << std::endl;
+  }
+
+  for (size_t i = 0; i < OPTIMIZER_RULE_COUNT; ++i) {
+    out << "rule " << optimizerRuleToString(static_cast<OptimizerRule>(i))
+        << ": " << rules[i] << std::endl;
+  }
+
+  out << "total: " << getRewrites() << " rewrites, "
+      << iterations << " iterations" << std::endl;
+}
+
+void OptimizerStats::printJson(std::ostream &out) const noexcept {
+  // names of passes and rules are identifiers, no escaping required
+  out << "{\"passes\":[";
+  for (auto it = passes.begin(); it != passes.end(); ++it) {
+    if (it != passes.begin())
+      out << ',';
+
+    out << "{\"name\":\"" << it->name << '"'
+        << ",\"nodesBefore\":" << it->nodesBefore
+        << ",\"nodesAfter\":" << it->nodesAfter
+        << ",\"iterations\":" << it->iterations
+        << ",\"rewrites\":" << it->rewrites
+        << ",\"ms\":" << _toMilliseconds(it->duration) << '}';
+  }
+
+  out << "],\"rules\":{";
+  for (size_t i = 0; i < OPTIMIZER_RULE_COUNT; ++i) {
+    if (i != 0)
+      out << ',';
+
+    out << '"' << optimizerRuleToString(static_cast<OptimizerRule>(i))
+        << "\":" << rules[i];
+  }
+
+  out << "},\"rewrites\":" << getRewrites()
+      << ",\"iterations\":" << iterations << '}' << std::endl;
+}
+
+std::unique_ptr<Expr> pfederc::runOptimizerPass(const std::string &name,
+    const OptimizerPassFunction &pass, std::unique_ptr<Expr> &&expr,
+    OptimizerStats &stats) noexcept {
+  const size_t nodesBefore = countExprNodes(*expr);
+  const size_t rewrites = stats.getRewrites();
+  const size_t iterations = stats.getIterations();
+  ScopedSpan span("optimize", name, expr->getLexer().getFilePath());
+
+  const auto start = std::chrono::steady_clock::now();
+  expr = pass(std::move(expr), stats);
+  const auto end = std::chrono::steady_clock::now();
+
+  stats.addPass(OptimizerPassStats{name, nodesBefore, countExprNodes(*expr),
+      stats.getIterations() - iterations, stats.getRewrites() - rewrites,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)});
+
+  return std::move(expr);
+}
@@ -0,0 +1,181 @@
+#include "pfederc/syntax_pass.hpp"
+using namespace pfederc;
+
+// OptimizerPass
+OptimizerPass::OptimizerPass() noexcept {
+}
+
+OptimizerPass::~OptimizerPass() {
+}
+
+// FoldPass
+FoldPass::FoldPass() noexcept {
+}
+
+FoldPass::~FoldPass() {
+}
+
+const char *FoldPass::getName() const noexcept {
+  return "fold";
+}
+
+bool FoldPass::isLocal() const noexcept {
+  return true;
+}
+
+std::unique_ptr<Expr> FoldPass::run(std::unique_ptr<Expr> &&expr,
+    OptimizerStats &stats) const noexcept {
+  return optimizeAll(std::move(expr), stats);
+}
+
+// InlinePass
+InlinePass::InlinePass(const InlineConfiguration &cfg) noexcept
+    : cfg(cfg) {
+}
+
+InlinePass::~InlinePass() {
+}
+
+const char *InlinePass::getName() const noexcept {
+  return "inline";
+}
+
+bool InlinePass::isLocal() const noexcept {
+  // requires function definitions of the module
+  return false;
+}
+
+std::unique_ptr<Expr> InlinePass::run(std::unique_ptr<Expr> &&expr,
+    OptimizerStats &stats) const noexcept {
+  std::vector<InlineRecord> inlined;
+  size_t reducedexpressions{0};
+  expr = inlineFunctions(std::move(expr), cfg, inlined, reducedexpressions);
+  stats.addRewrite(OptimizerRule::INLINE, inlined.size());
+
+  return std::move(expr);
+}
+
+// ConstantPass
+ConstantPass::ConstantPass(const ConstantConfiguration &cfg) noexcept
+    : cfg(cfg) {
+}
+
+ConstantPass::~ConstantPass() {
+}
+
+const char *ConstantPass::getName() const noexcept {
+  return "constant";
+}
+
+bool ConstantPass::isLocal() const noexcept {
+  // requires function definitions of the module
+  return false;
+}
+
+std::unique_ptr<Expr> ConstantPass::run(std::unique_ptr<Expr> &&expr,
+    OptimizerStats &stats) const noexcept {
+  size_t reducedexpressions{0};
+  expr = evaluateConstantFunctions(std::move(expr), cfg, reducedexpressions);
+  stats.addRewrite(OptimizerRule::CONSTANT_CALL, reducedexpressions);
+
+  return std::move(expr);
+}
+
+// OptimizerPipeline
+OptimizerPipeline::OptimizerPipeline(size_t threads) noexcept
+    : threads{std::max<size_t>(threads, 1)},
+      scheduler(threads > 1 ? std::make_unique<TaskScheduler>(threads)
+          : nullptr) {
+}
+
+OptimizerPipeline::~OptimizerPipeline() {
+}
+
+std::unique_ptr<Expr> OptimizerPipeline::run(std::unique_ptr<Expr> &&expr,
+    OptimizerStats &stats) const noexcept {
+  ScopedPhase phase(Phase::OPTIMIZE);
+  if (isExprDeeperThan(*expr, OPTIMIZER_MAX_DEPTH))
+    return std::move(expr);
+
+  for (const auto &pass : passes) {
+    const OptimizerPassFunction run =
+      [&pass](std::unique_ptr<Expr> &&expr, OptimizerStats &stats) {
+        return pass->run(std::move(expr), stats);
+      };
+
+    if (!pass->isLocal() || !scheduler) {
+      expr = runOptimizerPass(pass->getName(), run, std::move(expr), stats);
+      continue;
+    }
+
+    expr = runOptimizerPass(pass->getName(),
+        [this, &run](std::unique_ptr<Expr> &&expr, OptimizerStats &stats) {
+          return runLocalPassParallel(run, std::move(expr), stats,
+              *scheduler);
+        }, std::move(expr), stats);
+  }
+
+  return std::move(expr);
+}
+
+// PassManager
+PassManager::PassManager() noexcept {
+  registerPass("fold", []() {
+      return std::make_unique<FoldPass>();
+    });
+  registerPass("inline", []() {
+      return std::make_unique<InlinePass>(createDefaultInlineConfiguration());
+    });
+  registerPass("constant", []() {
+      return std::make_unique<ConstantPass>(
+          createDefaultConstantConfiguration());
+    });
+
+  registerPipeline("O0", {});
+  registerPipeline("O1", {"fold"});
+  registerPipeline("O2", {"constant", "inline", "fold"});
+}
+
+PassManager::~PassManager() {
+}
+
+void PassManager::registerPass(const std::string &name,
+    OptimizerPassFactory &&factory) noexcept {
+  passes[name] = std::move(factory);
+}
+
+void PassManager::registerPipeline(const std::string &name,
+    std::vector<std::string> &&passes) noexcept {
+  pipelines[name] = std::move(passes);
+}
+
+bool PassManager::createPipeline(OptimizerPipeline &pipeline,
+    const std::string &spec, std::string &unknown) const noexcept {
+  std::vector<std::string> names;
+  auto itpipeline = pipelines.find(spec);
+  if (itpipeline != pipelines.end()) {
+    names = itpipeline->second;
+  } else {
+    size_t start = 0;
+    while (start <= spec.length()) {
+      size_t end = spec.find(',', start);
+      if (end == std::string::npos)
+        end = spec.length();
+
+      names.push_back(spec.substr(start, end - start));
+      start = end + 1;
+    }
+  }
+
+  for (const std::string &name : names) {
+    auto itpass = passes.find(name);
+    if (itpass == passes.end()) {
+      unknown = name;
+      return false;
+    }
+
+    pipeline.addPass(itpass->second());
+  }
+
+  return true;
+}
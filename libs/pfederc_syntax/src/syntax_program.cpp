@@ -2,6 +2,9 @@
 using namespace pfederc;
 
 std::unique_ptr<ProgramExpr> Parser::parseProgram() noexcept {
+  ScopedPhase phase(Phase::PARSE);
+  // tokens are lexed while parsing
+  ScopedSpan span("parse", "parse", lexer.getFilePath());
   Position pos(lexer.getCurrentToken()->getPosition());
   ModBody body = parseModBody(true);
   return std::make_unique<ProgramExpr>(lexer, pos,
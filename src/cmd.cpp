@@ -0,0 +1,132 @@
+#include "pfederc/cmd.hpp"
+using namespace pfederc;
+
+inline static bool _startsWith(const std::string &str,
+    const std::string &prefix) noexcept {
+  return str.compare(0, prefix.length(), prefix) == 0;
+}
+
+static bool _parseNumber(size_t &num, const std::string &value) noexcept {
+  if (value.empty() || value.length() > 9
+      || value.find_first_not_of("0123456789") != std::string::npos)
+    return false;
+
+  num = std::stoul(value);
+
+  return true;
+}
+
+static bool _parseJobs(size_t &jobs, const std::string &value) noexcept {
+  return _parseNumber(jobs, value) && jobs != 0;
+}
+
+static bool _parseStatsFormat(StatsFormat &format,
+    const std::string &value) noexcept {
+  if (value.empty() || value == "text")
+    format = StatsFormat::TEXT;
+  else if (value == "json")
+    format = StatsFormat::JSON;
+  else
+    return false;
+
+  return true;
+}
+
+static bool _parseDiagnosticFormat(DiagnosticFormat &format,
+    const std::string &value) noexcept {
+  if (value == "text")
+    format = DiagnosticFormat::TEXT;
+  else if (value == "jsonl")
+    format = DiagnosticFormat::JSON_LINES;
+  else if (value == "sarif")
+    format = DiagnosticFormat::SARIF;
+  else
+    return false;
+
+  return true;
+}
+
+bool pfederc::parseCommandLine(CommandLine &cmd, int argsc, char * argsv[],
+    std::ostream &err) noexcept {
+  for (int i = 1; i < argsc; ++i) {
+    const std::string arg(argsv[i]);
+    if (arg == "--print-ast") {
+      cmd.printAst = true;
+    } else if (arg == "--unbuffered-diagnostics") {
+      cmd.unbufferedDiagnostics = true;
+    } else if (_startsWith(arg, "-ferror-limit=")) {
+      if (!_parseNumber(cmd.errorLimit,
+            arg.substr(std::strlen("-ferror-limit=")))) {
+        err << "Invalid error limit: " << arg << std::endl;
+        return false;
+      }
+    } else if (arg == "-ftime-report" || _startsWith(arg, "-ftime-report=")) {
+      const size_t pos = arg.find('=');
+      if (!_parseStatsFormat(cmd.timeReport,
+            pos == std::string::npos ? "" : arg.substr(pos + 1))) {
+        err << "Unknown time report format: " << arg << std::endl;
+        return false;
+      }
+    } else if (_startsWith(arg, "-ftime-trace=")) {
+      cmd.timeTrace = arg.substr(std::strlen("-ftime-trace="));
+      if (cmd.timeTrace.empty()) {
+        err << "Missing trace file: " << arg << std::endl;
+        return false;
+      }
+    } else if (_startsWith(arg, "--diagnostics-format=")) {
+      if (!_parseDiagnosticFormat(cmd.diagnosticsFormat,
+            arg.substr(std::strlen("--diagnostics-format=")))) {
+        err << "Unknown diagnostics format: " << arg << std::endl;
+        return false;
+      }
+    } else if (_startsWith(arg, "--diagnostics-output=")) {
+      cmd.diagnosticsOutput = arg.substr(std::strlen("--diagnostics-output="));
+      if (cmd.diagnosticsOutput.empty()) {
+        err << "Missing diagnostics file: " << arg << std::endl;
+        return false;
+      }
+    } else if (arg == "--list-passes") {
+      cmd.listPasses = true;
+    } else if (arg == "-O0" || arg == "-O1" || arg == "-O2") {
+      cmd.pipeline = arg.substr(1);
+    } else if (_startsWith(arg, "-j") || _startsWith(arg, "--jobs=")) {
+      if (!_parseJobs(cmd.jobs, arg.substr(arg[1] == 'j' ? 2 : 7))) {
+        err << "Invalid number of jobs: " << arg << std::endl;
+        return false;
+      }
+    } else if (_startsWith(arg, "--passes=")) {
+      cmd.pipeline = arg.substr(std::strlen("--passes="));
+    } else if (arg == "--optimizer-stats"
+        || _startsWith(arg, "--optimizer-stats=")) {
+      const size_t pos = arg.find('=');
+      if (!_parseStatsFormat(cmd.optimizerStats,
+            pos == std::string::npos ? "" : arg.substr(pos + 1))) {
+        err << "Unknown statistics format: " << arg << std::endl;
+        return false;
+      }
+    } else if (_startsWith(arg, "-")) {
+      err << "Unknown option: " << arg << std::endl;
+      return false;
+    } else {
+      cmd.files.push_back(arg);
+    }
+  }
+
+  if (cmd.files.empty() && !cmd.listPasses) {
+    err << "No input files" << std::endl;
+    return false;
+  }
+
+  // JSON Lines and SARIF must be the only output on their stream
+  if (cmd.diagnosticsFormat != DiagnosticFormat::TEXT
+      && cmd.diagnosticsOutput.empty()
+      && (cmd.printAst || cmd.optimizerStats != StatsFormat::NONE
+        || cmd.timeReport != StatsFormat::NONE)) {
+    err << "--print-ast, --optimizer-stats and -ftime-report require "
+      "--diagnostics-output=FILE with machine-readable diagnostics"
+      << std::endl;
+    return false;
+  }
+
+  return true;
+}
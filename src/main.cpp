@@ -1,3 +1,164 @@
+#include "pfederc/cmd.hpp"
+#include "pfederc/errors.hpp"
+#include "pfederc/instrumentation.hpp"
+#include "pfederc/lexer.hpp"
+#include "pfederc/semantics.hpp"
+#include "pfederc/syntax.hpp"
+#include "pfederc/syntax_optimizer.hpp"
+#include "pfederc/syntax_pass.hpp"
+#include <fstream>
+using namespace pfederc;
+
+static void _listPasses(const PassManager &passes) noexcept {
+  for (const auto &pass : passes.getPassFactories())
+    std::cout << "pass " << pass.first << std::endl;
+
+  for (const auto &pipeline : passes.getPipelines()) {
+    std::cout << "pipeline " << pipeline.first << ':';
+    for (const std::string &pass : pipeline.second)
+      std::cout << ' ' << pass;
+
+    std::cout << std::endl;
+  }
+}
+
+//! Analyzes prog as main unit, returns false on (logged) errors
+static bool _analyze(Logger &log, size_t jobs, ErrorLimit &errorLimit,
+    const std::string &file, const ProgramExpr &prog) noexcept {
+  TypeAnalyzer analyzer(jobs);
+  analyzer.setErrorLimit(&errorLimit);
+  analyzer.buildSemantics(std::list<BuildSemanticParam>{
+      BuildSemanticParam{file, true, &prog}});
+
+  // errors are rendered while flushing, before analyzer is destroyed
+  const bool errors = logSemanticErrors(log, analyzer);
+  log.flush();
+
+  return !errors;
+}
+
 int main(int argsc, char * argsv[]) {
-  return 0;
+  CommandLine cmd = createDefaultCommandLine();
+  if (!parseCommandLine(cmd, argsc, argsv, std::cerr))
+    return 1;
+
+  if ((cmd.timeReport != StatsFormat::NONE || !cmd.timeTrace.empty())
+      && !instrumentation::AVAILABLE) {
+    std::cerr << "-ftime-report and -ftime-trace require a build with "
+      "PFEDERC_INSTRUMENTATION" << std::endl;
+    return 1;
+  }
+
+  instrumentation::setEnabled(cmd.timeReport != StatsFormat::NONE);
+  instrumentation::setTracing(!cmd.timeTrace.empty());
+
+  PassManager passes;
+  if (cmd.listPasses) {
+    _listPasses(passes);
+    return 0;
+  }
+
+  OptimizerPipeline pipeline(cmd.jobs);
+  std::string unknown;
+  if (!passes.createPipeline(pipeline, cmd.pipeline, unknown)) {
+    std::cerr << "Unknown optimizer pass: " << unknown << std::endl;
+    return 1;
+  }
+
+  std::ofstream diagnostics;
+  if (!cmd.diagnosticsOutput.empty()) {
+    diagnostics.open(cmd.diagnosticsOutput);
+    if (!diagnostics) {
+      std::cerr << "Couldn't open diagnostics file: " << cmd.diagnosticsOutput
+        << std::endl;
+      return 1;
+    }
+  }
+
+  Logger log(LVL_ALL, cmd.diagnosticsOutput.empty() ? BaseLogger()
+      : BaseLogger(diagnostics, diagnostics), !cmd.unbufferedDiagnostics,
+      cmd.diagnosticsFormat);
+  OptimizerStats stats;
+  ErrorLimit errorLimit(cmd.errorLimit);
+  int result = 0;
+  for (const std::string &file : cmd.files) {
+    ScopedSpan span("file", file);
+    std::ifstream input(file);
+    if (!input) {
+      std::cerr << "Couldn't open file: " << file << std::endl;
+      result = 1;
+      continue;
+    }
+
+    Lexer lex(createDefaultLanguageConfiguration(), input, file);
+    lex.setErrorLimit(&errorLimit);
+    lex.next();
+    Parser parser(lex);
+    std::unique_ptr<Expr> prog(parser.parseProgram());
+
+    const bool lexerErrors = logLexerErrors(log, lex);
+    const bool parserErrors = logParserErrors(log, parser);
+    log.flush();
+    if (logErrorLimit(log, errorLimit)) {
+      log.flush();
+      result = 1;
+      break;
+    }
+
+    if (parserErrors || lexerErrors || !prog) {
+      result = 1;
+      continue;
+    }
+
+    const bool semanticErrors = !_analyze(log, cmd.jobs, errorLimit, file,
+        dynamic_cast<const ProgramExpr&>(*prog));
+    if (logErrorLimit(log, errorLimit)) {
+      log.flush();
+      result = 1;
+      break;
+    }
+
+    if (semanticErrors) {
+      result = 1;
+      continue;
+    }
+
+    prog = pipeline.run(std::move(prog), stats);
+
+    if (cmd.printAst)
+      std::cout << prog->toString() << std::endl;
+  }
+
+  switch (cmd.optimizerStats) {
+  case StatsFormat::TEXT:
+    stats.printText(std::cout);
+    break;
+  case StatsFormat::JSON:
+    stats.printJson(std::cout);
+    break;
+  default:
+    break;
+  }
+
+  if (!cmd.timeTrace.empty()) {
+    std::ofstream trace(cmd.timeTrace);
+    instrumentation::writeTrace(trace);
+    if (!trace) {
+      std::cerr << "Couldn't write trace: " << cmd.timeTrace << std::endl;
+      result = 1;
+    }
+  }
+
+  switch (cmd.timeReport) {
+  case StatsFormat::TEXT:
+    instrumentation::collect().printText(std::cout);
+    break;
+  case StatsFormat::JSON:
+    instrumentation::collect().printJson(std::cout);
+    break;
+  default:
+    break;
+  }
+
+  return result;
 }
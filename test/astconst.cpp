@@ -18,17 +18,23 @@ int main(int argc, char * argsv[]) {
   
   lex.next();
   Parser parser(lex);
-  auto expr = parser.parseExpression();
+  std::unique_ptr<Expr> expr = parser.parseProgram();
 
-  logLexerErrors(log, lex);
+  if (logLexerErrors(log, lex))
+    return 1;
 
   if (!expr) {
+    std::cout << "ERR" << std::endl;
     logParserErrors(log, parser);
-    return 0;
+    return 1;
   }
 
+  if (logParserErrors(log, parser))
+    return 1;
+
   size_t reducedexpressions{0};
-  expr = optimizeAll(std::move(expr), reducedexpressions);
+  expr = evaluateConstantFunctions(std::move(expr),
+      createDefaultConstantConfiguration(), reducedexpressions);
 
   std::cout << expr->toString() << std::endl;
   std::cout << reducedexpressions << std::endl;
@@ -2,6 +2,7 @@
 #include "pfederc/errors.hpp"
 #include "pfederc/lexer.hpp"
 #include "pfederc/syntax.hpp"
+#include "pfederc/syntax_optimizer.hpp"
 #include <sstream>
 using namespace pfederc;
 
@@ -17,16 +18,27 @@ int main(int argc, char * argsv[]) {
   
   lex.next();
   Parser parser(lex);
-  auto expr = parser.parseExpression();
+  std::unique_ptr<Expr> expr = parser.parseProgram();
 
-  logLexerErrors(log, lex);
+  if (logLexerErrors(log, lex))
+    return 1;
 
   if (!expr) {
+    std::cout << "ERR" << std::endl;
     logParserErrors(log, parser);
-    return 0;
+    return 1;
   }
 
+  if (logParserErrors(log, parser))
+    return 1;
+
+  std::vector<InlineRecord> inlined;
+  size_t reducedexpressions{0};
+  expr = inlineFunctions(std::move(expr), createDefaultInlineConfiguration(),
+      inlined, reducedexpressions);
+
   std::cout << expr->toString() << std::endl;
+  std::cout << inlined.size() << std::endl;
 
   return 0;
 }
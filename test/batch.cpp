@@ -0,0 +1,331 @@
+#include "pfederc/core.hpp"
+#include "pfederc/errors.hpp"
+#include "pfederc/lexer.hpp"
+#include "pfederc/syntax.hpp"
+#include "pfederc/syntax_optimizer.hpp"
+#include <fstream>
+#include <sstream>
+using namespace pfederc;
+
+/* Runs the cases of case files in one process. A case is a line
+ *
+ *   <mode> <name> "<input>" "<output>" [<diagnostic code>...]
+ *
+ * input and output are quoted with C escapes (\n, \t, \r, \", \\, \xHH).
+ * output is the printed result without the final newline, the codes are
+ * the expected lexer and parser diagnostics in report order. Lines starting
+ * with # are comments.
+ */
+
+struct _Case final {
+  std::string file;
+  size_t line;
+  std::string mode;
+  std::string name;
+  std::string input;
+  std::string output;
+  std::vector<std::string> codes;
+};
+
+struct _Result final {
+  std::string output;
+  std::vector<std::string> codes;
+};
+
+typedef std::function<void(const std::string &, _Result &)> _Mode;
+
+static const LanguageConfiguration _cfg = createDefaultLanguageConfiguration();
+
+static bool _lexerCodes(const Lexer &lex, _Result &result) noexcept {
+  bool error = false;
+  for (const auto &err : lex.getErrors()) {
+    error |= err->getLogLevel() == LVL_ERROR;
+    result.codes.push_back(describeLexerError(lex, *err).code);
+  }
+
+  return error;
+}
+
+static bool _parserCodes(const Parser &parser, _Result &result) noexcept {
+  bool error = false;
+  for (const auto &err : parser.getErrors()) {
+    error |= err->getLogLevel() == LVL_ERROR;
+    result.codes.push_back(describeParserError(parser, *err).code);
+  }
+
+  return error;
+}
+
+//! First token (type name or text)
+static void _token(const std::string &text, _Result &result,
+    bool typeName) noexcept {
+  std::istringstream input(text);
+  Lexer lex(_cfg, input, "<case>");
+  const Token &tok = lex.next();
+  result.output = typeName ? TOKEN_TYPE_STRINGS.at(tok.getType())
+    : tok.toString(lex);
+  _lexerCodes(lex, result);
+}
+
+//! Expression, the output is empty on errors and ERR without expression
+static void _ast(const std::string &text, _Result &result,
+    bool optimize) noexcept {
+  std::istringstream input(text);
+  Lexer lex(_cfg, input, "<case>");
+  lex.next();
+  Parser parser(lex);
+  std::unique_ptr<Expr> expr = parser.parseExpression();
+  const bool lexerError = _lexerCodes(lex, result);
+  const bool parserError = _parserCodes(parser, result);
+  if (lexerError)
+    return;
+
+  if (!expr) {
+    result.output = "ERR";
+    return;
+  }
+
+  if (parserError)
+    return;
+
+  if (!optimize) {
+    result.output = expr->toString();
+    return;
+  }
+
+  size_t reducedexpressions{0};
+  expr = optimizeAll(std::move(expr), reducedexpressions);
+  result.output = expr->toString() + '\n'
+    + std::to_string(reducedexpressions);
+}
+
+static const std::map<std::string, _Mode> _modes{
+  {"token", [](const std::string &text, _Result &result) {
+      _token(text, result, true); }},
+  {"tokenstr", [](const std::string &text, _Result &result) {
+      _token(text, result, false); }},
+  {"ast", [](const std::string &text, _Result &result) {
+      _ast(text, result, false); }},
+  {"astopt", [](const std::string &text, _Result &result) {
+      _ast(text, result, true); }},
+};
+
+inline static int _hex(char c) noexcept {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+
+  return -1;
+}
+
+//! Reads quoted string at pos of line
+static bool _readQuoted(const std::string &line, size_t &pos,
+    std::string &result) noexcept {
+  if (pos >= line.size() || line[pos] != '"')
+    return false;
+
+  for (++pos; pos < line.size() && line[pos] != '"'; ++pos) {
+    if (line[pos] != '\\') {
+      result += line[pos];
+      continue;
+    }
+
+    if (++pos >= line.size())
+      return false;
+
+    switch (line[pos]) {
+    case 'n': result += '\n'; break;
+    case 't': result += '\t'; break;
+    case 'r': result += '\r'; break;
+    case '"': result += '"'; break;
+    case '\\': result += '\\'; break;
+    case 'x': {
+      if (pos + 2 >= line.size() || _hex(line[pos + 1]) < 0
+          || _hex(line[pos + 2]) < 0)
+        return false;
+
+      result += static_cast<char>(_hex(line[pos + 1]) * 16
+          + _hex(line[pos + 2]));
+      pos += 2;
+      break;
+    }
+    default:
+      return false;
+    }
+  }
+
+  return pos++ < line.size();
+}
+
+static std::string _quote(const std::string &str) noexcept {
+  const char *const digits = "0123456789abcdef";
+  std::string result("\"");
+  for (char c : str) {
+    switch (c) {
+    case '\n': result += "\\n"; break;
+    case '\t': result += "\\t"; break;
+    case '\r': result += "\\r"; break;
+    case '"': result += "\\\""; break;
+    case '\\': result += "\\\\"; break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20 || c == 0x7f) {
+        result += "\\x";
+        result += digits[(c >> 4) & 0xf];
+        result += digits[c & 0xf];
+      } else {
+        result += c;
+      }
+      break;
+    }
+  }
+
+  return result + '"';
+}
+
+static void _skipSpaces(const std::string &line, size_t &pos) noexcept {
+  while (pos < line.size()
+      && std::isspace(static_cast<unsigned char>(line[pos])))
+    ++pos;
+}
+
+static std::string _readWord(const std::string &line, size_t &pos) noexcept {
+  const size_t start = pos;
+  while (pos < line.size()
+      && !std::isspace(static_cast<unsigned char>(line[pos])))
+    ++pos;
+
+  return line.substr(start, pos - start);
+}
+
+static bool _readCases(const std::string &path,
+    std::vector<_Case> &cases) noexcept {
+  std::ifstream file(path);
+  if (!file) {
+    std::cerr << "Cannot open file: " << path << std::endl;
+    return false;
+  }
+
+  std::string line;
+  for (size_t lineno = 1; std::getline(file, line); ++lineno) {
+    size_t pos = 0;
+    _skipSpaces(line, pos);
+    if (pos == line.size() || line[pos] == '#')
+      continue;
+
+    _Case c{path, lineno, "", "", "", "", {}};
+    c.mode = _readWord(line, pos);
+    _skipSpaces(line, pos);
+    c.name = _readWord(line, pos);
+    _skipSpaces(line, pos);
+    bool valid = _modes.count(c.mode) && !c.name.empty()
+      && _readQuoted(line, pos, c.input);
+    _skipSpaces(line, pos);
+    valid = valid && _readQuoted(line, pos, c.output);
+    for (_skipSpaces(line, pos); valid && pos < line.size();
+        _skipSpaces(line, pos))
+      c.codes.push_back(_readWord(line, pos));
+
+    if (!valid) {
+      std::cerr << path << ':' << lineno << ": Invalid case" << std::endl;
+      return false;
+    }
+
+    cases.push_back(std::move(c));
+  }
+
+  return true;
+}
+
+static std::string _formatCase(const _Case &c, const std::string &output,
+    const std::vector<std::string> &codes) noexcept {
+  std::string result = c.mode + ' ' + c.name + ' ' + _quote(c.input) + ' '
+    + _quote(output);
+  for (const std::string &code : codes)
+    result += ' ' + code;
+
+  return result;
+}
+
+inline static bool _startsWith(const std::string &str,
+    const std::string &prefix) noexcept {
+  return str.compare(0, prefix.length(), prefix) == 0;
+}
+
+int main(int argsc, char *argsv[]) {
+  size_t threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  bool print = false;
+  std::vector<_Case> cases;
+  for (int i = 1; i < argsc; ++i) {
+    const std::string arg(argsv[i]);
+    if (arg == "--print") {
+      // prints the cases with their actual results
+      print = true;
+    } else if (_startsWith(arg, "--threads=")) {
+      threads = std::strtoul(arg.c_str() + std::strlen("--threads="),
+          nullptr, 10);
+      if (threads == 0) {
+        std::cerr << "Invalid number of threads: " << arg << std::endl;
+        return 1;
+      }
+    } else if (!_readCases(arg, cases)) {
+      return 1;
+    }
+  }
+
+  if (cases.empty()) {
+    std::cerr << "Expected case files" << std::endl;
+    return 1;
+  }
+
+  std::set<std::string> names;
+  for (const _Case &c : cases) {
+    if (!names.insert(c.name).second) {
+      std::cerr << c.file << ':' << c.line << ": Duplicate case "
+        << c.name << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<_Result> results(cases.size());
+  std::atomic<size_t> next{0};
+  const auto worker = [&]() {
+      for (size_t i; (i = next++) < cases.size();)
+        _modes.at(cases[i].mode)(cases[i].input, results[i]);
+    };
+
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < std::min(threads, cases.size()); ++i)
+    workers.emplace_back(worker);
+
+  worker();
+  for (std::thread &thread : workers)
+    thread.join();
+
+  size_t failed = 0;
+  for (size_t i = 0; i < cases.size(); ++i) {
+    const _Case &c = cases[i];
+    const _Result &result = results[i];
+    if (print) {
+      std::cout << _formatCase(c, result.output, result.codes) << std::endl;
+      continue;
+    }
+
+    if (result.output == c.output && result.codes == c.codes)
+      continue;
+
+    ++failed;
+    std::cout << c.file << ':' << c.line << ": FAIL " << c.name << '\n'
+      << "  input:    " << _quote(c.input) << '\n'
+      << "  expected: " << _formatCase(c, c.output, c.codes) << '\n'
+      << "  actual:   " << _formatCase(c, result.output, result.codes)
+      << std::endl;
+  }
+
+  if (!print)
+    std::cout << cases.size() << " cases, " << failed << " failed" << std::endl;
+
+  return failed > 0;
+}
@@ -0,0 +1,82 @@
+#include "pfederc/core.hpp"
+#include "pfederc/semantics.hpp"
+using namespace pfederc;
+
+constexpr size_t DEPTH = 100;
+constexpr size_t SCOPES = 100000;
+
+int main() {
+  Context root, other;
+  std::vector<Context*> chain{&root};
+  for (size_t i = 0; i < DEPTH; ++i)
+    chain.push_back(chain.back()->createContext());
+
+  Context *branch = chain[40]->createContext()->createContext();
+
+  for (size_t i = 0; i <= DEPTH; ++i) {
+    if (chain[i]->getDepth() != i || chain[i]->isParent(*chain[i]))
+      return 1;
+
+    if (i > 0 && (!chain[i]->isParent(*chain[i - 1])
+          || !chain[i]->isParent(root) || chain[i - 1]->isParent(*chain[i])))
+      return 1;
+
+    for (size_t j = 0; j <= DEPTH; ++j) {
+      if (chain[i]->getCommonParent(*chain[j]) != chain[std::min(i, j)]
+          || chain[i]->isParent(*chain[j]) != (j < i))
+        return 1;
+    }
+  }
+
+  if (branch->isParent(*chain[41]) || !branch->isParent(*chain[40])
+      || branch->isParent(other))
+    return 1;
+
+  if (branch->getCommonParent(*chain[DEPTH]) != chain[40]
+      || chain[DEPTH]->getCommonParent(*branch) != chain[40]
+      || chain[DEPTH]->getCommonParent(*chain[7]) != chain[7]
+      || chain[7]->getCommonParent(*chain[7]) != chain[7]
+      || branch->getCommonParent(other))
+    return 1;
+
+  if (root.getChildContextIdWithChild(*chain[DEPTH]) != chain[1]
+      || chain[40]->getChildContextIdWithChild(*branch)
+        != branch->getParent()
+      || chain[40]->getChildContextIdWithChild(*chain[41]) != chain[41]
+      || chain[41]->getChildContextIdWithChild(*branch)
+      || chain[41]->getChildContextIdWithChild(*chain[41]))
+    return 1;
+
+  // program order: enclosing contexts first, then creation order
+  const CtxId *before = chain[40]->createCtxId();
+  const CtxId *after = chain[40]->createCtxId();
+  if (!(*chain[40] < *before) || !(*before < *after)
+      || !(*chain[41] < *before) || !(*chain[DEPTH] < *before)
+      || *before < *chain[DEPTH] || !(*branch < *after)
+      || !(*chain[DEPTH] < *branch) || *branch < *chain[DEPTH]
+      || !(root < *chain[DEPTH]) || *chain[7] < *chain[7]
+      || *before < *before || *chain[DEPTH] < other)
+    return 1;
+
+  // block scopes don't allocate symbol storage
+  root.setConcurrent(false);
+  std::vector<Context*> scopes;
+  for (size_t i = 0; i < SCOPES; ++i)
+    scopes.push_back(scopes.empty() || i % 8 == 0 ?
+        branch->createContext() : scopes.back()->createContext());
+  root.setConcurrent(true);
+
+  NullSymbol type;
+  scopes[SCOPES / 2]->addSymbol(
+      std::make_unique<VariableSymbol>(0, intern("v"), &type));
+  for (size_t i = 0; i < SCOPES; ++i) {
+    if (scopes[i]->hasSymbols() != (i == SCOPES / 2)
+        || !scopes[i]->isParent(*branch))
+      return 1;
+  }
+
+  if (scopes[SCOPES / 2 + 1]->resolve(intern("v")).ctx != scopes[SCOPES / 2])
+    return 1;
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+#include "pfederc/core.hpp"
+#include "pfederc/lexer.hpp"
+#include "pfederc/syntax.hpp"
+#include "pfederc/semantics.hpp"
+#include <sstream>
+using namespace pfederc;
+
+constexpr size_t CHAIN = 5000;
+
+static std::unique_ptr<ProgramExpr> _parse(Lexer &lex) noexcept {
+  lex.next();
+  Parser parser(lex);
+  auto result = parser.parseProgram();
+  if (!result || !parser.getErrors().empty())
+    return nullptr;
+
+  return result;
+}
+
+static std::vector<const Expr*> _definitions(const ProgramExpr &program) noexcept {
+  std::vector<const Expr*> result;
+  for (const auto &def : program.getDefinitions())
+    result.push_back(def.get());
+
+  return result;
+}
+
+int main() {
+  // 0: even, 1: odd (mutually recursive), 2: C, 3: f (self-recursive),
+  // 4: T, 5: trait implementation of C, 6: x
+  std::istringstream input(
+      "func even(n: i32): i32\nreturn odd(n)\n;\n"
+      "func odd(n: i32): i32\nreturn even(n)\n;\n"
+      "class C(v: i32)\n;\n"
+      "func f(c: C): i32\nreturn f(c)\n;\n"
+      "trait T\n;\n"
+      "class trait C : T\n;\n"
+      "x := 2\n");
+  LanguageConfiguration cfg = createDefaultLanguageConfiguration();
+  Lexer lex(cfg, input, "<input>");
+  auto program = _parse(lex);
+  if (!program || !lex.getErrors().empty())
+    return 1;
+
+  const DeclarationGraph graph(_definitions(*program));
+  if (graph.size() != 7 || graph.getName(0) != intern("even")
+      || graph.getName(5) != INTERNED_NONE || graph.getName(6) != intern("x"))
+    return 1;
+
+  const size_t even = graph.getComponent(0), f = graph.getComponent(3);
+  if (graph.getComponent(1) != even || !graph.isRecursive(even)
+      || graph.getMembers(even) != std::vector<size_t>{0, 1}
+      || !graph.isRecursive(f) || graph.isRecursive(graph.getComponent(2)))
+    return 1;
+
+  if (graph.getDependencies(3) != std::vector<size_t>{2, 3}
+      || graph.getDependencies(5) != std::vector<size_t>{2, 4})
+    return 1;
+
+  // dependencies are on lower levels
+  for (size_t def = 0; def < graph.size(); ++def) {
+    for (size_t dep : graph.getDependencies(def)) {
+      const size_t component = graph.getComponent(dep);
+      if (component != graph.getComponent(def)
+          && graph.getLevel(component) >= graph.getLevel(graph.getComponent(def)))
+        return 1;
+    }
+  }
+
+  if (graph.getLevels().size() != 2 || graph.getLevel(f) != 1
+      || graph.getLevel(even) != 0)
+    return 1;
+
+  std::vector<bool> marked(graph.size(), false);
+  marked[2] = true; // C changed
+  graph.markDependents(marked);
+  if (marked != std::vector<bool>{false, false, true, true, false, true, false})
+    return 1;
+
+  // long chains don't recurse
+  std::string chain = "func f0\n;\n";
+  for (size_t i = 1; i < CHAIN; ++i)
+    chain += "func f" + std::to_string(i) + "\nreturn f"
+      + std::to_string(i - 1) + "\n;\n";
+
+  std::istringstream chainInput(chain);
+  Lexer chainLex(cfg, chainInput, "<chain>");
+  auto chainProgram = _parse(chainLex);
+  if (!chainProgram)
+    return 1;
+
+  const DeclarationGraph chainGraph(_definitions(*chainProgram));
+  if (chainGraph.countComponents() != CHAIN
+      || chainGraph.getLevels().size() != CHAIN
+      || chainGraph.getLevel(chainGraph.getComponent(CHAIN - 1)) != CHAIN - 1)
+    return 1;
+
+  return 0;
+}
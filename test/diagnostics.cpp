@@ -0,0 +1,146 @@
+#include "pfederc/core.hpp"
+#include "pfederc/errors.hpp"
+#include "pfederc/json.hpp"
+#include <sstream>
+using namespace pfederc;
+
+constexpr size_t THREADS = 4;
+constexpr size_t REPORTS = 1000;
+
+int main() {
+  std::ostringstream out, err;
+  {
+    Logger log(LVL_ALL, BaseLogger(out, err), true);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREADS; ++t) {
+      threads.emplace_back([&log, t]() {
+          // reported in descending order
+          for (size_t i = REPORTS; i-- > 0;) {
+            if (i % THREADS == t)
+              log.report(i % 2 ? "b" : "a", i,
+                  LogMessage(LVL_ERROR, std::to_string(i),
+                    {LogMessage(LVL_NOTE, "note")}));
+          }
+        });
+    }
+
+    for (std::thread &thread : threads)
+      thread.join();
+
+    if (!out.str().empty() || !err.str().empty())
+      return 1;
+
+    log.flush();
+  }
+
+  // file "a" first, ordered by position, notes follow their errors
+  std::string expected, expectedNotes;
+  for (size_t file = 0; file < 2; ++file) {
+    for (size_t i = file; i < REPORTS; i += 2)
+      expected += std::to_string(i) + '\n';
+  }
+
+  for (size_t i = 0; i < REPORTS; ++i)
+    expectedNotes += "note\n";
+
+  if (err.str() != expected || out.str() != expectedNotes)
+    return 1;
+
+  // written immediately, filtered levels aren't written
+  std::ostringstream unbufferedOut, unbufferedErr;
+  Logger unbuffered(static_cast<Level>(LVL_ERROR | LVL_WARNING),
+      BaseLogger(unbufferedOut, unbufferedErr));
+  unbuffered.report("a", 7, LogMessage(LVL_WARNING, "warning",
+        {LogMessage(LVL_NOTE, "filtered")}));
+  unbuffered.report("a", 3, LogMessage(LVL_ERROR, "error"));
+  if (unbufferedOut.str() != "warning\n" || unbufferedErr.str() != "error\n")
+    return 1;
+
+  // rendered when written, filtered diagnostics aren't rendered
+  size_t renders = 0;
+  std::ostringstream lazyOut, lazyErr;
+  {
+    Logger lazy(LVL_ERROR, BaseLogger(lazyOut, lazyErr), true);
+    auto render = [&renders]() {
+        ++renders;
+        return LogMessage(LVL_ERROR, "error");
+      };
+    lazy.report("a", 0, LVL_WARNING, render);
+    lazy.report("a", 1, LVL_ERROR, render);
+    if (renders != 0)
+      return 1;
+  }
+
+  if (renders != 1 || lazyErr.str() != "error\n")
+    return 1;
+
+  // machine-readable formats
+  std::string json;
+  JsonWriter writer(json);
+  writer.beginObject().member("a\"\n\x01", uint64_t(1))
+    .key("b").beginArray().value(true).value("\\").beginObject().endObject()
+    .endArray().endObject();
+  if (json != "{\"a\\\"\\n\\u0001\":1,\"b\":[true,\"\\\\\",{}]}")
+    return 1;
+
+  std::ostringstream jsonOut, jsonErr;
+  {
+    Logger jsonLog(LVL_ALL, BaseLogger(jsonOut, jsonErr), true,
+        DiagnosticFormat::JSON_LINES);
+    jsonLog.report("b", 4, LogMessage(LVL_WARNING, "rendered"));
+    jsonLog.report("a", 4, LVL_ERROR,
+        []() { return LogMessage(LVL_ERROR, "text"); },
+        []() {
+          return DiagnosticRecord{LVL_ERROR, "LEX0001", "a", 1, 5, 4, 6,
+            "message", {LogMessage(LVL_NOTE, "fix")}};
+        });
+  }
+
+  if (!jsonErr.str().empty() || jsonOut.str() != "{\"file\":\"a\","
+      "\"line\":1,\"column\":5,\"startIndex\":4,\"endIndex\":6,"
+      "\"level\":\"error\",\"code\":\"LEX0001\",\"message\":\"message\","
+      "\"notes\":[{\"level\":\"note\",\"message\":\"fix\"}]}\n"
+      "{\"file\":\"b\",\"line\":0,\"column\":0,\"startIndex\":0,"
+      "\"endIndex\":0,\"level\":\"warning\",\"code\":\"\","
+      "\"message\":\"rendered\",\"notes\":[]}\n")
+    return 1;
+
+  std::ostringstream sarifOut, sarifErr;
+  {
+    Logger sarifLog(LVL_ALL, BaseLogger(sarifOut, sarifErr), false,
+        DiagnosticFormat::SARIF);
+  }
+
+  if (sarifOut.str().find("\"results\":[\n]}]}\n") == std::string::npos)
+    return 1;
+
+  // flush limit
+  std::ostringstream limitOut, limitErr;
+  Logger limited(LVL_ALL, BaseLogger(limitOut, limitErr), true);
+  limited.setFlushLimit(2);
+  limited.report("a", 2, LogMessage(LVL_ERROR, "1"));
+  if (!limitErr.str().empty())
+    return 1;
+
+  limited.report("a", 1, LogMessage(LVL_ERROR, "0"));
+  if (limitErr.str() != "0\n1\n")
+    return 1;
+
+  // error limit
+  ErrorLimit errorLimit(2);
+  if (!errorLimit.add() || errorLimit.isReached() || !errorLimit.add()
+      || !errorLimit.isReached() || errorLimit.add())
+    return 1;
+
+  // text detection, partial input may end within a character
+  const std::string utf8 = "x := \"\xc3\xa4\xe2\x82\xac\xf0\x9f\x98\x80\"\n";
+  if (!charset::isText(utf8.data(), utf8.size(), false)
+      || charset::isText("a\0b", 3, false)
+      || charset::isText("\xc0\xaf", 2, false)
+      || charset::isText("\xed\xa0\x80", 3, false)
+      || charset::isText("\xe2\x82", 2, false)
+      || !charset::isText("\xe2\x82", 2, true))
+    return 1;
+
+  return 0;
+}
@@ -0,0 +1,109 @@
+#include "pfederc/core.hpp"
+#include "pfederc/lexer.hpp"
+#include "pfederc/syntax.hpp"
+#include "pfederc/syntax_pass.hpp"
+#include "generator.hpp"
+#include <sstream>
+using namespace pfederc;
+using namespace pfederc::bench;
+
+constexpr size_t SIZE = 16 * 1024;
+constexpr uint64_t SEEDS = 8;
+
+static LanguageConfiguration _cfg = createDefaultLanguageConfiguration();
+
+static bool _parses(const std::string &text, bool program) noexcept {
+  std::istringstream input(text);
+  Lexer lex(_cfg, input, "<generated>");
+  lex.next();
+  Parser parser(lex);
+  const bool parsed = program ? !!parser.parseProgram()
+    : !!parser.parseExpression();
+  // expressions end with end-of-line
+  if (!program && lex.getCurrentToken()->getType() == TokenType::TOK_EOL)
+    lex.next();
+
+  return parsed && parser.getErrors().empty() && lex.getErrors().empty()
+    && lex.getCurrentToken()->getType() == TokenType::TOK_EOF;
+}
+
+//! Runs the O2 pipeline on program (constants like 1 / 0 aren't folded)
+static bool _optimizes(const std::string &text) noexcept {
+  std::istringstream input(text);
+  Lexer lex(_cfg, input, "<generated>");
+  lex.next();
+  Parser parser(lex);
+  std::unique_ptr<Expr> prog(parser.parseProgram());
+  if (!prog)
+    return false;
+
+  PassManager passes;
+  OptimizerPipeline pipeline;
+  std::string unknown;
+  OptimizerStats stats;
+  return passes.createPipeline(pipeline, "O2", unknown)
+    && pipeline.run(std::move(prog), stats);
+}
+
+int main() {
+  for (const std::string &name : getGeneratorShapeNames()) {
+    GeneratorShape shape;
+    if (!getGeneratorShape(shape, name))
+      return 1;
+
+    for (uint64_t seed = 0; seed < SEEDS; ++seed) {
+      const std::string program = ProgramGenerator(shape, seed).generate(SIZE);
+      if (program.size() < SIZE || !_parses(program, true)
+          || !_optimizes(program)) {
+        std::cerr << name << ", seed " << seed << std::endl;
+        return 1;
+      }
+
+      // deterministic, streams generate the same program
+      std::ostringstream out;
+      if (ProgramGenerator(shape, seed).generate(out, SIZE) != program.size()
+          || out.str() != program)
+        return 1;
+    }
+  }
+
+  GeneratorShape shape;
+  if (getGeneratorShape(shape, "unknown") || !getGeneratorShape(shape, "mixed"))
+    return 1;
+
+  // divides by zero
+  if (!_optimizes(ProgramGenerator(shape, 5).generate(64 * 1024)))
+    return 1;
+
+  if (ProgramGenerator(shape, 0).generate(SIZE)
+      == ProgramGenerator(shape, 1).generate(SIZE))
+    return 1;
+
+  // limits of the shape are kept
+  shape.nestingDepth = 0;
+  shape.templateParameters = 0;
+  const std::string flat = ProgramGenerator(shape, 0).generate(SIZE);
+  if (!_parses(flat, true) || flat.find('{') != std::string::npos)
+    return 1;
+
+  for (const char *block : {" if ", " for ", " do\n", " match "}) {
+    if (flat.find(block) != std::string::npos)
+      return 1;
+  }
+
+  const std::string expr = ProgramGenerator(shape, 0).generateExpression(SIZE);
+  if (expr.size() < SIZE || !_parses(expr, false))
+    return 1;
+
+  // blocks aren't nested deeper than the parser accepts
+  if (!getGeneratorShape(shape, "nested"))
+    return 1;
+
+  shape.nestingDepth = 2 * PARSER_MAX_DEPTH;
+  const std::string deep = ProgramGenerator(shape, 0).generate(4 << 20);
+  if (deep.find(std::string(2 * GENERATOR_MAX_NESTING_DEPTH, ' '))
+      == std::string::npos || !_parses(deep, true))
+    return 1;
+
+  return 0;
+}
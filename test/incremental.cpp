@@ -0,0 +1,134 @@
+#include "pfederc/core.hpp"
+#include "pfederc/lexer.hpp"
+#include "pfederc/syntax.hpp"
+#include "pfederc/semantics.hpp"
+#include <sstream>
+using namespace pfederc;
+
+constexpr size_t THREADS = 4;
+
+static const char *const CLASS_C = "class C(v: i32)\n;\n";
+static const char *const FUNC_F = "func f(c: C): i32\nreturn 1\n;\n";
+static const char *const FUNC_G = "func g(n: i32): i32\nreturn n\n;\n";
+static const char *const MODULE_M =
+  "module m\nclass D\n;\nfunc h(d: D): i32\nreturn 2\n;\n;\n";
+
+struct _Unit final {
+  std::istringstream input;
+  std::unique_ptr<Lexer> lex;
+  std::unique_ptr<ProgramExpr> program;
+};
+
+static LanguageConfiguration _cfg = createDefaultLanguageConfiguration();
+// errors of previous builds reference their lexers
+static std::deque<_Unit> _units;
+
+static const ProgramExpr *_parse(const std::string &text) noexcept {
+  _units.emplace_back();
+  _Unit &unit = _units.back();
+  unit.input.str(text);
+  unit.lex = std::make_unique<Lexer>(_cfg, unit.input, "<input>");
+  unit.lex->next();
+  Parser parser(*unit.lex);
+  unit.program = parser.parseProgram();
+  if (!unit.program || !parser.getErrors().empty()
+      || !unit.lex->getErrors().empty())
+    return nullptr;
+
+  return unit.program.get();
+}
+
+static bool _build(TypeAnalyzer &analyzer, const std::string &text,
+    bool success, size_t analyzed, size_t reused) noexcept {
+  const ProgramExpr *program = _parse(text);
+  if (!program)
+    return false;
+
+  return analyzer.buildSemantics(std::list<BuildSemanticParam>{
+      BuildSemanticParam{"<input>", true, program}}) == success
+    && analyzer.getErrors().empty() == success
+    && analyzer.countAnalyzedDeclarations() == analyzed
+    && analyzer.countReusedDeclarations() == reused;
+}
+
+static std::vector<std::string> _mangles(TypeAnalyzer &analyzer) noexcept {
+  std::vector<std::string> result;
+  analyzer.forEachSemantic([&result](const std::string &mangle, Semantic*) {
+      result.push_back(mangle);
+    });
+
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+int main() {
+  TypeAnalyzer analyzer(THREADS);
+  const std::string text = std::string(CLASS_C) + FUNC_F + FUNC_G + MODULE_M;
+  if (!_build(analyzer, text, true, 5, 0))
+    return 1;
+
+  const std::vector<std::string> mangles = _mangles(analyzer);
+  if (mangles != std::vector<std::string>{"C", "C.v", "f(C)", "g(i32)", "m",
+      "m.D", "m.h(D)"})
+    return 1;
+
+  // unchanged text, semantics reference the new expressions
+  _units.front().program.reset();
+  if (!_build(analyzer, text, true, 0, 5) || _mangles(analyzer) != mangles)
+    return 1;
+
+  const ProgramExpr &program = *_units.back().program;
+  Semantic *semanticC = nullptr, *semanticH = nullptr;
+  analyzer.forEachSemantic([&](const std::string &mangle, Semantic *semantic) {
+      if (mangle == "C")
+        semanticC = semantic;
+      else if (mangle == "m.h(D)")
+        semanticH = semantic;
+    });
+
+  if (!semanticC || !semanticH
+      || semanticC->getExpression() != program.getDefinitions()[0].get()
+      || !semanticC->getSymbol() || semanticC->getSymbol()->isRetired())
+    return 1;
+
+  // retired symbols stay allocated, semantics don't
+  const Symbol *symbolC = semanticC->getSymbol();
+
+  // f depends on C, g and m don't
+  const std::string textC = "class C(v: i32, w: i32)\n;\n";
+  if (!_build(analyzer, textC + FUNC_F + FUNC_G + MODULE_M, true, 2, 3))
+    return 1;
+
+  if (_mangles(analyzer) != std::vector<std::string>{"C", "C.v", "C.w",
+      "f(C)", "g(i32)", "m", "m.D", "m.h(D)"})
+    return 1;
+
+  // the old symbol of C isn't found anymore
+  const Resolution resolution = analyzer.getContext().resolve(intern("C"));
+  if (std::distance(resolution.symbols.begin(), resolution.symbols.end()) != 1
+      || !symbolC->isRetired() || *resolution.symbols.begin() == symbolC)
+    return 1;
+
+  // errors are reported again, until the definition is fixed
+  const std::string textG = "func g(n: X): i32\nreturn n\n;\n";
+  if (!_build(analyzer, textC + FUNC_F + textG + MODULE_M, false, 1, 4)
+      || analyzer.getErrors().size() != 1
+      || !_build(analyzer, textC + FUNC_F + textG + MODULE_M, false, 1, 4)
+      || analyzer.getErrors().size() != 1)
+    return 1;
+
+  // removed module
+  if (!_build(analyzer, textC + FUNC_F + FUNC_G, true, 1, 2))
+    return 1;
+
+  if (_mangles(analyzer) != std::vector<std::string>{"C", "C.v", "C.w",
+      "f(C)", "g(i32)"}
+      || !analyzer.getContext().resolve(intern("m")).symbols.empty())
+    return 1;
+
+  // redefinition of a reused name
+  if (!_build(analyzer, textC + FUNC_F + FUNC_G + CLASS_C, false, 3, 1))
+    return 1;
+
+  return 0;
+}
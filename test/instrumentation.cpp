@@ -0,0 +1,144 @@
+#include "pfederc/core.hpp"
+#include "pfederc/instrumentation.hpp"
+#include "pfederc/lexer.hpp"
+#include "pfederc/syntax.hpp"
+#include "pfederc/syntax_optimizer.hpp"
+#include "pfederc/semantics.hpp"
+#include <sstream>
+using namespace pfederc;
+
+constexpr size_t THREADS = 4;
+constexpr size_t BYTES = 1 << 20;
+
+static const char *const PROGRAM =
+  "class C(v: i32)\n;\nfunc f(c: C): i32\nreturn 1 + 2\n;\n"
+  "func g(n: i32): i32\nreturn n * 3 + 4\n;\n";
+
+static std::unique_ptr<Expr> _parse(Lexer &lex) noexcept {
+  lex.next();
+  Parser parser(lex);
+  std::unique_ptr<Expr> program(parser.parseProgram());
+  if (!program || !parser.getErrors().empty() || !lex.getErrors().empty())
+    return nullptr;
+
+  return program;
+}
+
+int main() {
+  const LanguageConfiguration cfg = createDefaultLanguageConfiguration();
+
+  // nothing is measured while disabled
+  {
+    std::istringstream input(PROGRAM);
+    Lexer lex(cfg, input, "<input>");
+    if (!_parse(lex))
+      return 1;
+  }
+
+  InstrumentationReport report = instrumentation::collect();
+  if (report.getCounter(Counter::TOKENS) != 0
+      || report.getPhase(Phase::LEX).entries != 0)
+    return 1;
+
+  instrumentation::setEnabled(true);
+  std::istringstream input(PROGRAM);
+  Lexer lex(cfg, input, "<input>");
+  std::unique_ptr<Expr> program = _parse(lex);
+  if (!program)
+    return 1;
+
+  report = instrumentation::collect();
+  const uint64_t tokens = report.getCounter(Counter::TOKENS);
+  if (tokens == 0 || report.getPhase(Phase::LEX).entries != tokens
+      || report.getPhase(Phase::PARSE).entries != 1
+      || report.getCounter(Counter::EXPRESSIONS) == 0
+      || report.getCounter(Counter::REWRITES) != 0)
+    return 1;
+
+  // rewrites of worker threads are counted
+  OptimizerStats stats;
+  TaskScheduler scheduler(THREADS);
+  program = optimizeAll(std::move(program), stats, scheduler);
+  report = instrumentation::collect();
+  if (stats.getRewrites() == 0
+      || report.getCounter(Counter::REWRITES) != stats.getRewrites())
+    return 1;
+
+  instrumentation::setTracing(true);
+  TypeAnalyzer analyzer(THREADS);
+  const ProgramExpr *prog = dynamic_cast<const ProgramExpr*>(program.get());
+  if (!prog || !analyzer.buildSemantics(std::list<BuildSemanticParam>{
+        BuildSemanticParam{"<input>", true, prog}}))
+    return 1;
+
+  instrumentation::setTracing(false);
+  report = instrumentation::collect();
+  if (report.getCounter(Counter::SYMBOLS) == 0
+      || report.getPhase(Phase::SEMANTIC).entries < 1)
+    return 1;
+
+  // spans of declarations, recorded by any worker
+  std::ostringstream trace;
+  instrumentation::writeTrace(trace);
+  for (const char *expected : {"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[",
+        "\"name\":\"thread_name\",\"ph\":\"M\"",
+        "\"name\":\"buildSemantics\",\"cat\":\"semantic\",\"ph\":\"X\"",
+        "\"name\":\"C\",\"cat\":\"semantic\"",
+        "\"name\":\"f\",\"cat\":\"semantic\"",
+        "\"name\":\"g\",\"cat\":\"semantic\"",
+        "\"args\":{\"file\":\"<input>\"}"}) {
+    if (trace.str().find(expected) == std::string::npos)
+      return 1;
+  }
+
+  // spans aren't recorded, while not tracing
+  {
+    ScopedSpan span("test", "untraced");
+  }
+
+  trace.str("");
+  instrumentation::writeTrace(trace);
+  if (trace.str().find("untraced") != std::string::npos)
+    return 1;
+
+  // nested phases are excluded from the duration of their parent
+  instrumentation::reset();
+  {
+    ScopedPhase optimize(Phase::OPTIMIZE);
+    if (instrumentation::getCurrentPhase() != Phase::OPTIMIZE)
+      return 1;
+
+    {
+      ScopedPhase semantic(Phase::SEMANTIC);
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      std::unique_ptr<char[]> memory(new char[BYTES]);
+      memory[0] = 1;
+    }
+
+    if (instrumentation::getCurrentPhase() != Phase::OPTIMIZE)
+      return 1;
+  }
+
+  report = instrumentation::collect();
+  if (report.getPhase(Phase::SEMANTIC).duration
+        < std::chrono::milliseconds(20)
+      || report.getPhase(Phase::OPTIMIZE).duration
+        >= std::chrono::milliseconds(20)
+      || report.getPhase(Phase::LEX).entries != 0)
+    return 1;
+
+#ifdef __GLIBC__
+  // peaks include nested phases
+  if (report.getPhase(Phase::SEMANTIC).peakBytes < BYTES
+      || report.getPhase(Phase::OPTIMIZE).peakBytes < BYTES
+      || report.getPhase(Phase::SEMANTIC).allocations == 0)
+    return 1;
+#endif
+
+  std::ostringstream json;
+  report.printJson(json);
+  if (json.str().find("\"counters\":{\"tokens\":0,") == std::string::npos)
+    return 1;
+
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include "pfederc/core.hpp"
+#include "pfederc/interner.hpp"
+#include "pfederc/lexer.hpp"
+#include <sstream>
+using namespace pfederc;
+
+constexpr size_t THREADS = 8;
+constexpr size_t STRINGS = 5000; // more than the first chunk
+
+int main() {
+  StringInterner interner;
+  if (!interner.get(INTERNED_NONE).empty()
+      || interner.find("a") != INTERNED_NONE)
+    return 1;
+
+  // every thread interns all strings, ids must match
+  std::vector<std::vector<InternedId>> ids(THREADS);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < THREADS; ++t) {
+    threads.emplace_back([&interner, &ids, t]() {
+        for (size_t i = 0; i < STRINGS; ++i) {
+          const size_t k = (i + t * 131) % STRINGS;
+          if (ids[t].empty())
+            ids[t].resize(STRINGS);
+          ids[t][k] = interner.intern("id" + std::to_string(k));
+        }
+      });
+  }
+
+  for (std::thread &thread : threads)
+    thread.join();
+
+  if (interner.size() != STRINGS)
+    return 1;
+
+  for (size_t i = 0; i < STRINGS; ++i) {
+    const InternedId id = ids[0][i];
+    if (id == INTERNED_NONE
+        || interner.get(id) != "id" + std::to_string(i)
+        || interner.find("id" + std::to_string(i)) != id)
+      return 1;
+
+    for (size_t t = 1; t < THREADS; ++t) {
+      if (ids[t][i] != id)
+        return 1;
+    }
+  }
+
+  // identifiers are interned while lexing
+  std::istringstream input("abc abc\ndef");
+  LanguageConfiguration cfg = createDefaultLanguageConfiguration();
+  Lexer lex(cfg, input, "<input>");
+  std::vector<InternedId> tokids;
+  for (const Token *tok = &lex.next(); *tok != TokenType::TOK_EOF;
+      tok = &lex.next()) {
+    if (*tok != TokenType::TOK_ID)
+      continue;
+
+    const auto *idtok = dynamic_cast<const IdentifierToken*>(tok);
+    if (!idtok || idtok->getIdentifier() != tok->toInternedId(lex))
+      return 1;
+
+    tokids.push_back(idtok->getIdentifier());
+  }
+
+  if (tokids.size() != 3 || tokids[0] != tokids[1] || tokids[0] == tokids[2]
+      || tokids[0] != intern("abc") || internedString(tokids[2]) != "def")
+    return 1;
+
+  return 0;
+}
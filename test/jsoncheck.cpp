@@ -0,0 +1,221 @@
+#include "pfederc/core.hpp"
+#include <fstream>
+#include <sstream>
+
+/* Validates JSON (RFC 8259) files, used to check machine-readable output.
+ *
+ *   jsoncheck [--lines] <file>...
+ *
+ * With --lines every non-empty line has to be a JSON value (JSON Lines).
+ */
+
+struct _Reader final {
+  const std::string &text;
+  size_t pos;
+  size_t depth;
+};
+
+constexpr size_t _MAX_DEPTH = 256;
+
+static void _skipSpaces(_Reader &r) noexcept {
+  while (r.pos < r.text.size() && (r.text[r.pos] == ' '
+        || r.text[r.pos] == '\t' || r.text[r.pos] == '\n'
+        || r.text[r.pos] == '\r'))
+    ++r.pos;
+}
+
+static bool _accept(_Reader &r, char c) noexcept {
+  _skipSpaces(r);
+  if (r.pos >= r.text.size() || r.text[r.pos] != c)
+    return false;
+
+  ++r.pos;
+  return true;
+}
+
+static bool _acceptWord(_Reader &r, const char *word) noexcept {
+  const size_t len = std::strlen(word);
+  if (r.text.compare(r.pos, len, word) != 0)
+    return false;
+
+  r.pos += len;
+  return true;
+}
+
+static bool _digits(_Reader &r) noexcept {
+  const size_t start = r.pos;
+  while (r.pos < r.text.size() && std::isdigit(
+        static_cast<unsigned char>(r.text[r.pos])))
+    ++r.pos;
+
+  return r.pos > start;
+}
+
+static bool _number(_Reader &r) noexcept {
+  if (r.text[r.pos] == '-')
+    ++r.pos;
+
+  if (r.pos < r.text.size() && r.text[r.pos] == '0')
+    ++r.pos;
+  else if (!_digits(r))
+    return false;
+
+  if (r.pos < r.text.size() && r.text[r.pos] == '.') {
+    ++r.pos;
+    if (!_digits(r))
+      return false;
+  }
+
+  if (r.pos < r.text.size() && (r.text[r.pos] == 'e'
+        || r.text[r.pos] == 'E')) {
+    ++r.pos;
+    if (r.pos < r.text.size() && (r.text[r.pos] == '+'
+          || r.text[r.pos] == '-'))
+      ++r.pos;
+    if (!_digits(r))
+      return false;
+  }
+
+  return true;
+}
+
+static bool _string(_Reader &r) noexcept {
+  if (!_accept(r, '"'))
+    return false;
+
+  for (; r.pos < r.text.size(); ++r.pos) {
+    const unsigned char c = r.text[r.pos];
+    if (c == '"') {
+      ++r.pos;
+      return true;
+    }
+
+    if (c < 0x20)
+      return false;
+
+    if (c != '\\')
+      continue;
+
+    if (++r.pos >= r.text.size())
+      return false;
+
+    switch (r.text[r.pos]) {
+    case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r':
+    case 't':
+      break;
+    case 'u':
+      for (size_t i = 0; i < 4; ++i) {
+        if (++r.pos >= r.text.size() || !std::isxdigit(
+              static_cast<unsigned char>(r.text[r.pos])))
+          return false;
+      }
+      break;
+    default:
+      return false;
+    }
+  }
+
+  return false;
+}
+
+static bool _value(_Reader &r) noexcept;
+
+static bool _members(_Reader &r, char end, bool object) noexcept {
+  if (++r.depth > _MAX_DEPTH)
+    return false;
+
+  if (!_accept(r, end)) {
+    do {
+      if (object && (!_string(r) || !_accept(r, ':')))
+        return false;
+      if (!_value(r))
+        return false;
+    } while (_accept(r, ','));
+
+    if (!_accept(r, end))
+      return false;
+  }
+
+  --r.depth;
+  return true;
+}
+
+static bool _value(_Reader &r) noexcept {
+  _skipSpaces(r);
+  if (r.pos >= r.text.size())
+    return false;
+
+  switch (r.text[r.pos]) {
+  case '{':
+    ++r.pos;
+    return _members(r, '}', true);
+  case '[':
+    ++r.pos;
+    return _members(r, ']', false);
+  case '"':
+    return _string(r);
+  case 't':
+    return _acceptWord(r, "true");
+  case 'f':
+    return _acceptWord(r, "false");
+  case 'n':
+    return _acceptWord(r, "null");
+  default:
+    return _number(r);
+  }
+}
+
+//! Text has to be exactly one JSON value
+static bool _isJson(const std::string &text) noexcept {
+  _Reader r{text, 0, 0};
+  if (!_value(r))
+    return false;
+
+  _skipSpaces(r);
+  return r.pos == text.size();
+}
+
+int main(int argsc, char *argsv[]) {
+  bool lines = false;
+  size_t files = 0;
+  for (int i = 1; i < argsc; ++i) {
+    const std::string arg(argsv[i]);
+    if (arg == "--lines") {
+      lines = true;
+      continue;
+    }
+
+    std::ifstream file(arg);
+    if (!file) {
+      std::cerr << "Cannot open file: " << arg << std::endl;
+      return 1;
+    }
+
+    ++files;
+    if (!lines) {
+      std::ostringstream text;
+      text << file.rdbuf();
+      if (!_isJson(text.str())) {
+        std::cerr << arg << ": Invalid JSON" << std::endl;
+        return 1;
+      }
+
+      continue;
+    }
+
+    std::string line;
+    for (size_t lineno = 1; std::getline(file, line); ++lineno) {
+      if (!line.empty() && !_isJson(line)) {
+        std::cerr << arg << ':' << lineno << ": Invalid JSON" << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  if (files == 0) {
+    std::cerr << "Expected files" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -33,33 +33,23 @@ int main(int argsc, char *argsv[]) {
   if (logParserErrors(log, parser))
     return 1;
 
-  TypeAnalyzer semanticAna(1);
-  semanticAna.buildSemantics(std::list<BuildSemanticParam>{
-      BuildSemanticParam{"<args[1]>", true, program.get()}});
+  const size_t threads = argsc > 2 ? std::stoul(argsv[2]) : 1;
+  TypeAnalyzer semanticAna(threads);
+  if (!semanticAna.buildSemantics(std::list<BuildSemanticParam>{
+      BuildSemanticParam{"<args[1]>", true, program.get()}})) {
+    std::cout << "ERR" << std::endl;
+    logSemanticErrors(log, semanticAna);
+    return 1;
+  }
 
   std::vector<const std::string*> mangles;
-  semanticAna.forEachSemantic([&mangles](const std::string &mangle, Semantic *semantic) {
+  semanticAna.forEachSemantic([&mangles](const std::string &mangle, Semantic *) {
       mangles.push_back(&mangle);
   });
 
   std::sort(mangles.begin(), mangles.end(),
       [](const std::string *pstr0, const std::string *pstr1) {
-        const std::string &str0 = *pstr0;
-        const std::string &str1 = *pstr1;
-        size_t i = 0;
-        for (; i < str0.length() && i < str1.length(); ++i) {
-          if (str0[i] < str1[i])
-            return -1;
-          else if (str0[i] != str1[i])
-            return 1;
-        }
-
-        if (i == str0.length() && i == str1.length())
-          return 0;
-        if (i == str0.length())
-          return 1;
-
-        return -1;
+        return *pstr0 < *pstr1;
       });
 
   for (auto &str : mangles)
@@ -0,0 +1,75 @@
+#include "pfederc/core.hpp"
+#include "pfederc/semantics.hpp"
+using namespace pfederc;
+
+constexpr size_t THREADS = 4;
+constexpr size_t NAMES = 256;
+
+static bool _resolvesTo(Context &ctx, InternedId name, Context *expected) {
+  const Resolution resolution = ctx.resolve(name);
+  return resolution.ctx == expected
+    && resolution.symbols.empty() == !expected;
+}
+
+int main() {
+  Context root;
+  Context *outer = root.createContext();
+  Context *inner = outer->createContext();
+  NullSymbol type;
+
+  const InternedId x = intern("x"), y = intern("y");
+  root.addSymbol(std::make_unique<VariableSymbol>(0, x, &type));
+
+  if (!_resolvesTo(*inner, x, &root) || !_resolvesTo(*inner, y, nullptr))
+    return 1;
+
+  // cached results are invalidated by addSymbol
+  outer->addSymbol(std::make_unique<VariableSymbol>(0, x, &type));
+  inner->addSymbol(std::make_unique<VariableSymbol>(0, y, &type));
+  if (!_resolvesTo(*inner, x, outer) || !_resolvesTo(*inner, y, inner)
+      || !_resolvesTo(*outer, y, nullptr))
+    return 1;
+
+  std::vector<Resolution> resolutions;
+  inner->resolveAll({x, y, intern("z"), x}, resolutions);
+  if (resolutions.size() != 4 || resolutions[0].ctx != outer
+      || resolutions[1].ctx != inner || resolutions[2].ctx
+      || resolutions[3].ctx != outer)
+    return 1;
+
+  // names declared while other threads resolve are found afterwards
+  std::vector<InternedId> names;
+  for (size_t i = 0; i < NAMES; ++i)
+    names.push_back(intern("n" + std::to_string(i)));
+
+  std::atomic<bool> failed{false};
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < THREADS; ++t) {
+    threads.emplace_back([&]() {
+        std::vector<Resolution> result;
+        for (size_t k = 0; k < 16; ++k) {
+          inner->resolveAll(names, result);
+          for (const Resolution &resolution : result) {
+            if (resolution.ctx && resolution.ctx != outer)
+              failed = true;
+          }
+        }
+      });
+  }
+
+  for (InternedId name : names)
+    outer->addSymbol(std::make_unique<VariableSymbol>(0, name, &type));
+
+  for (std::thread &thread : threads)
+    thread.join();
+
+  if (failed)
+    return 1;
+
+  for (InternedId name : names) {
+    if (!_resolvesTo(*inner, name, outer))
+      return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,45 @@
+#include "pfederc/core.hpp"
+#include "pfederc/semantics.hpp"
+using namespace pfederc;
+
+int main() {
+  Context root;
+  Context *ctx0 = root.createContext();
+  CtxId *id00 = ctx0->createCtxId();
+  CtxId *id1 = root.createCtxId();
+  // created last, but positioned before id1
+  CtxId *id01 = ctx0->createCtxId();
+  Context *ctx010 = ctx0->createContext();
+
+  if (!(*id01 < *id1) || !(*ctx0 < *id00) || !(*id00 < *id01)
+      || !(*id01 < *ctx010) || !(*ctx010 < *id1) || *id1 < *id01)
+    return 1;
+
+  NullSymbol type;
+  VariableSymbol var(0, intern("x"), &type);
+  if (var.is(*id01, ST_MUTABLE))
+    return 1;
+
+  // inserted out of program order
+  var.changeType(*id1, true, ST_MUTABLE | ST_VARIABLE);
+  var.changeType(*id00, false, ST_MUTABLE | ST_CONSTANT);
+
+  if (var.is(*ctx0, ST_MUTABLE) || !var.is(*ctx0, ST_VARIABLE))
+    return 1;
+
+  if (!var.is(*id00, ST_MUTABLE | ST_VARIABLE | ST_CONSTANT)
+      || !var.is(*id01, ST_MUTABLE) || !var.is(*ctx010, ST_MUTABLE))
+    return 1;
+
+  if (var.is(*id1, ST_MUTABLE) || var.is(*id1, ST_VARIABLE)
+      || !var.is(*id1, ST_CONSTANT | ST_NAMED))
+    return 1;
+
+  // change between existing changes
+  var.changeType(*id01, true, ST_CONSTANT);
+  if (!var.is(*id00, ST_CONSTANT) || var.is(*id01, ST_CONSTANT)
+      || !var.is(*id01, ST_MUTABLE) || var.is(*id1, ST_CONSTANT))
+    return 1;
+
+  return 0;
+}
@@ -0,0 +1,85 @@
+#include "pfederc/core.hpp"
+#include "pfederc/semantics.hpp"
+using namespace pfederc;
+
+constexpr size_t THREADS = 8;
+constexpr size_t NAMES = 512;
+constexpr size_t OVERLOADS = 4;
+
+int main() {
+  Context ctx;
+
+  // overloads differ in their parameter type
+  std::vector<std::unique_ptr<NullSymbol>> types;
+  for (size_t i = 0; i < OVERLOADS; ++i)
+    types.push_back(std::make_unique<NullSymbol>());
+
+  std::atomic<size_t> inserted{0};
+  std::atomic<bool> failed{false};
+  std::atomic<bool> writing{true};
+
+  // every writer tries to insert every symbol, only one succeeds
+  const auto writer = [&](size_t offset) {
+    for (size_t k = 0; k < NAMES * OVERLOADS; ++k) {
+      const size_t i = (k + offset * 97) % (NAMES * OVERLOADS);
+      std::list<std::unique_ptr<FunctionParamSymbol>> params;
+      params.push_back(std::make_unique<FunctionParamSymbol>(0, INTERNED_NONE,
+            types[i % OVERLOADS].get()));
+      auto fn = std::make_unique<FunctionSymbol>(0,
+          intern("f" + std::to_string(i / OVERLOADS)), std::move(params),
+          types[0].get());
+      if (!ctx.addSymbol(std::move(fn)))
+        ++inserted;
+    }
+  };
+
+  const auto reader = [&]() {
+    size_t iterations = 0;
+    while (writing || iterations == 0) {
+      for (size_t i = 0; i < NAMES; ++i) {
+        const std::string name = "f" + std::to_string(i);
+        size_t count = 0;
+        for (Symbol *sym : ctx.getSymbols(name, true)) {
+          if (!sym->getName() || *sym->getName() != name)
+            failed = true;
+          ++count;
+        }
+
+        if (count > OVERLOADS)
+          failed = true;
+      }
+
+      ++iterations;
+    }
+  };
+
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < THREADS / 2; ++i)
+    readers.emplace_back(reader);
+
+  std::vector<std::thread> writers;
+  for (size_t i = 0; i < THREADS; ++i)
+    writers.emplace_back(writer, i);
+
+  for (std::thread &thread : writers)
+    thread.join();
+
+  writing = false;
+  for (std::thread &thread : readers)
+    thread.join();
+
+  if (failed || inserted != NAMES * OVERLOADS)
+    return 1;
+
+  for (size_t i = 0; i < NAMES; ++i) {
+    const auto range = ctx.getSymbols("f" + std::to_string(i), true);
+    if (static_cast<size_t>(std::distance(range.begin(), range.end()))
+        != OVERLOADS)
+      return 1;
+  }
+
+  if (!ctx.getSymbols("g", true).empty())
+    return 1;
+
+  return 0;
+}
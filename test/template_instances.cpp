@@ -0,0 +1,128 @@
+#include "pfederc/core.hpp"
+#include "pfederc/semantics.hpp"
+using namespace pfederc;
+
+constexpr size_t THREADS = 8;
+
+//! Instantiation depends on another instance of itself
+class _Recursive final : public TemplateSymbol {
+  bool growing;
+  std::vector<std::unique_ptr<Symbol>> args;
+protected:
+  virtual std::unique_ptr<TemplateSymbol> instantiate(
+      const TemplateArguments &args) noexcept override {
+    if (!growing)
+      resolveTemplate(args);
+    else {
+      this->args.push_back(std::make_unique<NullSymbol>());
+      resolveTemplate(TemplateArguments{this->args.back().get()});
+    }
+
+    return std::make_unique<_Recursive>(std::list<AliasSymbol*>(), growing);
+  }
+public:
+  _Recursive(std::list<AliasSymbol*> &&templSyms, bool growing) noexcept
+    : TemplateSymbol(ST_CLASS, std::move(templSyms)), growing{growing} {}
+  virtual ~_Recursive() {}
+};
+
+//! Declares alias without type (template symbol) in ctx
+static AliasSymbol *_declareTemplate(Context &ctx, const char *name) noexcept {
+  auto alias = std::make_unique<AliasSymbol>(intern(name), nullptr);
+  AliasSymbol *result = alias.get();
+  ctx.addSymbol(std::move(alias));
+  return result;
+}
+
+int main() {
+  Context root;
+  ClassSymbol i32(0, root.createContext(), intern("i32"));
+  ClassSymbol u8(0, root.createContext(), intern("u8"));
+  AliasSymbol int32(intern("int32"), &i32),
+    integer(intern("int"), &int32);
+
+  // class List{T}
+  Context *listctx = root.createContext();
+  AliasSymbol *t = _declareTemplate(*listctx, "T");
+  ClassSymbol list(0, listctx, intern("List"), {t});
+
+  Symbol *listi32 = list.resolveTemplate(TemplateArguments{&i32});
+  if (!listi32 || listi32 == &list || listi32->getBaseSymbolType() & ST_TEMPLATE
+      || *listi32->getName() != "List")
+    return 1;
+
+  // alias chains are canonicalized
+  if (list.resolveTemplate(std::list<AliasSymbol*>{&integer}) != listi32
+      || list.resolveTemplate(TemplateArguments{&i32}) != listi32
+      || list.resolveTemplate(TemplateArguments{&u8}) == listi32
+      || list.countInstances() != 2)
+    return 1;
+
+  const TemplateSymbol *instance = dynamic_cast<TemplateSymbol*>(listi32);
+  if (instance->getOrigin() != &list
+      || instance->getTemplateArguments() != TemplateArguments{&i32})
+    return 1;
+
+  // T is bound in the instance context
+  const Resolution resolution =
+    listi32->getContext()->resolve(intern("T"));
+  if (resolution.ctx != listi32->getContext() || resolution.symbols.empty()
+      || (*resolution.symbols.begin())->getType() != &i32
+      || !listi32->getContext()->isParent(*listctx))
+    return 1;
+
+  if (list.resolveTemplate(TemplateArguments{}) || list.resolveTemplate(std::list<AliasSymbol*>{t})
+        != &list || i32.resolveTemplate(TemplateArguments{}) != &i32)
+    return 1;
+
+  // func id{T}(x : T) : T
+  Context *fnctx = root.createContext();
+  AliasSymbol *u = _declareTemplate(*fnctx, "T");
+  std::list<std::unique_ptr<FunctionParamSymbol>> params;
+  params.push_back(std::make_unique<FunctionParamSymbol>(ST_MUTABLE,
+        intern("x"), u));
+  FunctionSymbol id(0, intern("id"), std::move(params), u, {u});
+
+  auto *idu8 = dynamic_cast<FunctionSymbol*>(
+      id.resolveTemplate(TemplateArguments{&u8}));
+  if (!idu8 || &idu8->getResult() != &u8
+      || idu8->getParameters().front()->getType() != &u8
+      || !(idu8->getParameters().front()->getBaseSymbolType() & ST_MUTABLE))
+    return 1;
+
+  // concurrent lookups share one instance
+  std::deque<ClassSymbol> types;
+  for (size_t i = 0; i < 64; ++i)
+    types.emplace_back(0, root.createContext(), intern("C" + std::to_string(i)));
+
+  std::vector<std::vector<Symbol*>> instances(THREADS);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < THREADS; ++i) {
+    threads.emplace_back([&, i]() {
+        for (ClassSymbol &type : types)
+          instances[i].push_back(list.resolveTemplate(
+                TemplateArguments{&type}));
+      });
+  }
+
+  for (std::thread &thread : threads)
+    thread.join();
+
+  for (size_t i = 1; i < THREADS; ++i) {
+    if (instances[i] != instances[0])
+      return 1;
+  }
+
+  if (list.countInstances() != 2 + types.size())
+    return 1;
+
+  // recursive instantiations are detected
+  _Recursive same({_declareTemplate(*root.createContext(), "T")}, false);
+  _Recursive growing({_declareTemplate(*root.createContext(), "T")}, true);
+  if (!same.resolveTemplate(TemplateArguments{&i32})
+      || !growing.resolveTemplate(TemplateArguments{&i32})
+      || growing.countInstances() != TEMPLATE_INSTANTIATION_DEPTH)
+    return 1;
+
+  return 0;
+}